@@ -348,6 +348,66 @@ workspace "kmeter"
         filter { "configurations:Release" }
             objdir ("../bin/.intermediate_" .. os.target() .. "/standalone_surround_release")
 
+--------------------------------------------------------------------------------
+
+    project ("kmeter_analyse")
+        kind "ConsoleApp"
+        targetdir "../bin/console/"
+
+        defines {
+            "JucePlugin_Build_Standalone=0",
+            "JucePlugin_Build_VST=0",
+            "JucePlugin_Build_VST3=0",
+            "JUCE_ALSA=0",
+            "JUCE_JACK=0",
+            "JUCE_WASAPI=0",
+            "JUCE_DIRECTSOUND=0"
+        }
+
+        files {
+            "../Source/analyser/*.h",
+            "../Source/analyser/*.cpp"
+        }
+
+        -- the workspace compiles all sources of the plug-in
+        removefiles {
+            "../Source/audio_file_player.*",
+            "../Source/kmeter.*",
+            "../Source/meter_bar.*",
+            "../Source/overflow_meter.*",
+            "../Source/peak_label.*",
+            "../Source/plugin_editor.*",
+            "../Source/plugin_events.*",
+            "../Source/plugin_processor.*",
+            "../Source/skin.*",
+            "../Source/window_validation_content.*"
+        }
+
+    filter { "system:linux", "platforms:x32" }
+        linkoptions {
+            -- force static linking to FFTW
+            "../../../libraries/fftw/bin/linux/i386/libfftw3f.a"
+        }
+
+    filter { "system:linux", "platforms:x64" }
+        linkoptions {
+            -- force static linking to FFTW
+            "../../../libraries/fftw/bin/linux/amd64/libfftw3f.a"
+        }
+
+        filter { "system:linux" }
+            targetname "kmeter_analyse"
+
+        filter { "system:windows" }
+            targetname "K-Meter (Analyse"
+            targetextension (".exe")
+
+        filter { "configurations:Debug" }
+            objdir ("../bin/.intermediate_" .. os.target() .. "/console_analyse_debug")
+
+        filter { "configurations:Release" }
+            objdir ("../bin/.intermediate_" .. os.target() .. "/console_analyse_release")
+
 --------------------------------------------------------------------------------
 
     project ("kmeter_vst2_stereo")
@@ -0,0 +1,803 @@
+/* ----------------------------------------------------------------------------
+
+   K-Meter
+   =======
+   Implementation of a K-System meter according to Bob Katz' specifications
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+#include "batch_analyser.h"
+#include "segmented_analyser.h"
+
+#include <cstdio>
+
+
+/// Writes to standard output.
+///
+class StandardOutputStream :
+    public OutputStream
+{
+public:
+    StandardOutputStream() :
+        position_(0)
+    {
+    }
+
+    void flush() override
+    {
+        fflush(stdout);
+    }
+
+    bool setPosition(int64 newPosition) override
+    {
+        ignoreUnused(newPosition);
+        return false;
+    }
+
+    int64 getPosition() override
+    {
+        return position_;
+    }
+
+    bool write(const void *dataToWrite, size_t numberOfBytes) override
+    {
+        size_t bytesWritten = fwrite(dataToWrite, 1, numberOfBytes, stdout);
+        position_ += (int64) bytesWritten;
+
+        return (bytesWritten == numberOfBytes);
+    }
+
+private:
+    int64 position_;
+};
+
+
+static int summariseFiles(const Array<File> &audioFiles,
+                          OutputStream &output,
+                          const int crestFactor,
+                          const int averageAlgorithm,
+                          const int numberOfSegments,
+                          const bool isVerifying,
+                          const bool useFftTruePeakMeter)
+{
+    SegmentedAnalyser analyser(averageAlgorithm, numberOfSegments);
+    SegmentedAnalyser referenceAnalyser(averageAlgorithm, 1);
+
+    analyser.setFftTruePeakMeter(useFftTruePeakMeter);
+    referenceAnalyser.setFftTruePeakMeter(useFftTruePeakMeter);
+
+    bool hasFailed = false;
+
+    output << "[";
+
+    for (int index = 0; index < audioFiles.size(); ++index)
+    {
+        const File &audioFile = audioFiles.getReference(index);
+
+        // separate JSON objects of previous files
+        output << ((index == 0) ? "\n" : ",\n");
+
+        SegmentedAnalyser::Summary summary;
+        String errorMessage;
+        double startTime = Time::getMillisecondCounterHiRes();
+
+        if (!analyser.analyseFile(audioFile, summary, errorMessage))
+        {
+            std::fprintf(stderr, "Error: %s\n", errorMessage.toRawUTF8());
+            hasFailed = true;
+
+            output << "{\n"
+                   "  \"file\": " +
+                   JSON::toString(audioFile.getFullPathName()) + ",\n"
+                   "  \"error\": " + JSON::toString(errorMessage) + "\n"
+                   "}";
+            continue;
+        }
+
+        double elapsedSeconds =
+            (Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+
+        output << SegmentedAnalyser::formatSummary(
+                   audioFile, summary, crestFactor);
+
+        std::fprintf(stderr, "%s: %.1f s of audio in %.2f s (%.0fx real-time)\n",
+                     audioFile.getFileName().toRawUTF8(),
+                     summary.analysedSeconds,
+                     elapsedSeconds,
+                     summary.analysedSeconds / jmax(elapsedSeconds, 0.001));
+
+        if (isVerifying)
+        {
+            SegmentedAnalyser::Summary referenceSummary;
+
+            if (!referenceAnalyser.analyseFile(
+                        audioFile, referenceSummary, errorMessage) ||
+                    !SegmentedAnalyser::compareSummaries(
+                        summary, referenceSummary, errorMessage))
+            {
+                std::fprintf(stderr, "Verification failed: %s (\"%s\")\n",
+                             errorMessage.toRawUTF8(),
+                             audioFile.getFullPathName().toRawUTF8());
+                hasFailed = true;
+            }
+        }
+    }
+
+    output << "\n]\n";
+    output.flush();
+
+    return hasFailed ? 1 : 0;
+}
+
+
+// run all self-tests (see self_tests.cpp)
+static int runSelfTests()
+{
+    UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+    runner.runTestsInCategory("K-Meter");
+
+    int numberOfFailures = 0;
+
+    for (int index = 0; index < runner.getNumResults(); ++index)
+    {
+        numberOfFailures += runner.getResult(index)->failures;
+    }
+
+    if (numberOfFailures > 0)
+    {
+        std::fprintf(stderr, "\n%d self-test(s) failed\n", numberOfFailures);
+        return 1;
+    }
+
+    std::fprintf(stderr, "\nAll self-tests passed\n");
+    return 0;
+}
+
+
+// time a function and return the seconds per call; the fastest of
+// five runs is kept (the first one also warms up caches)
+template <typename Function>
+static double timeFunction(const int numberOfRepetitions,
+                           Function function)
+{
+    double fastestRun = 1e9;
+
+    for (int run = 0; run < 5; ++run)
+    {
+        int64 startTicks = Time::getHighResolutionTicks();
+
+        for (int repetition = 0; repetition < numberOfRepetitions;
+                ++repetition)
+        {
+            function();
+        }
+
+        double seconds = Time::highResolutionTicksToSeconds(
+                             Time::getHighResolutionTicks() -
+                             startTicks) / numberOfRepetitions;
+
+        fastestRun = jmin(fastestRun, seconds);
+    }
+
+    return fastestRun;
+}
+
+
+// fill a buffer with white noise at -6 dBFS (fixed seed, so runs can
+// be compared)
+static void fillWithNoise(AudioBuffer<float> &buffer)
+{
+    Random random(42);
+
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    {
+        float *samples = buffer.getWritePointer(channel);
+
+        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+        {
+            samples[sample] = random.nextFloat() - 0.5f;
+        }
+    }
+}
+
+
+// time complex multiplication (the inner loop of FFT convolution)
+// for every code path this CPU supports; sizes match the partitioned
+// (256-point FFT) and unpartitioned (2048-point FFT) convolution
+static void benchmarkComplexMultiplication()
+{
+    const int numberOfRepetitions = 50000;
+    const int numbersOfValues[] = {129, 1025};
+
+    typedef frut::dsp::ComplexVectorOperations ComplexVectorOperations;
+
+    std::printf("Complex multiplication (ns per call)\n\n");
+
+    for (auto numberOfValues : numbersOfValues)
+    {
+        // unit-magnitude factors keep repeated products away from
+        // denormals (which would dominate the timings)
+        HeapBlock<float> destination(2 * numberOfValues);
+        HeapBlock<float> source1(2 * numberOfValues);
+        HeapBlock<float> source2(2 * numberOfValues);
+
+        for (int index = 0; index < numberOfValues; ++index)
+        {
+            double phase = 0.1 * index;
+
+            source1[2 * index] = (float) std::cos(phase);
+            source1[2 * index + 1] = (float) std::sin(phase);
+            source2[2 * index] = (float) std::cos(-phase);
+            source2[2 * index + 1] = (float) std::sin(-phase);
+            destination[2 * index] = source1[2 * index];
+            destination[2 * index + 1] = source1[2 * index + 1];
+        }
+
+        for (auto implementation :
+                ComplexVectorOperations::getAvailableImplementations())
+        {
+            double multiplyTime = timeFunction(numberOfRepetitions, [&]()
+            {
+                implementation.multiply(
+                    destination, source1, numberOfValues);
+            });
+
+            double multiplyAddTime = timeFunction(numberOfRepetitions, [&]()
+            {
+                implementation.multiplyAdd(
+                    destination, source1, source2, numberOfValues);
+            });
+
+            std::printf("  %4d values  %-6s  multiply %8.1f  "
+                        "multiplyAdd %8.1f\n",
+                        numberOfValues,
+                        implementation.name,
+                        multiplyTime * 1e9,
+                        multiplyAddTime * 1e9);
+        }
+    }
+}
+
+
+/// FIR filter box that can be fed with chunks from outside.
+///
+class BenchmarkFilterBox :
+    public frut::dsp::FIRFilterBox
+{
+public:
+    BenchmarkFilterBox(const int numberOfChannels,
+                       const int fftBufferSize,
+                       const int partitionSize,
+                       const int kernelLength) :
+        FIRFilterBox(numberOfChannels, fftBufferSize,
+                     partitionSize, kernelLength)
+    {
+        // cutoff of the average level meter at 44.1 kHz
+        calculateKernelWindowedSincLPF(21000.0 / 44100.0);
+    }
+
+    void loadChunk(const AudioBuffer<float> &chunk)
+    {
+        for (int channel = 0; channel < numberOfChannels_; ++channel)
+        {
+            fftSampleBuffer_.copyFrom(channel, 0, chunk, channel, 0,
+                                      fftBufferSize_);
+        }
+    }
+};
+
+
+// time the low-pass filter of the average level meter on one chunk
+// of stereo audio for every code path of complex multiplication
+// (the scalar code path matches the convolution before it was
+// vectorised); channels are convolved one by one and in a single
+// batch, and both with and without partitions
+static void benchmarkConvolution()
+{
+    const int numberOfRepetitions = 1000;
+    const int numberOfChannels = 2;
+    const int chunkSize = OfflineAnalyser::kmeterBufferSize;
+
+    typedef frut::dsp::ComplexVectorOperations ComplexVectorOperations;
+
+    AudioBuffer<float> chunk(numberOfChannels, chunkSize);
+    fillWithNoise(chunk);
+
+    std::printf("\nConvolution of %d stereo samples (us per chunk, "
+                "including copying the chunk)\n\n", chunkSize);
+
+    for (int isPartitioned = 1; isPartitioned >= 0; --isPartitioned)
+    {
+        int partitionSize = 0;
+        int kernelLength = 0;
+
+        // partitions as used by the average level meter
+        if (isPartitioned)
+        {
+            partitionSize = AverageLevelFiltered::KMETER_FILTER_PARTITION_SIZE;
+            kernelLength = AverageLevelFiltered::KMETER_FILTER_KERNEL_LENGTH;
+        }
+
+        BenchmarkFilterBox filterBox(numberOfChannels, chunkSize,
+                                     partitionSize, kernelLength);
+
+        for (auto implementation :
+                ComplexVectorOperations::getAvailableImplementations())
+        {
+            ComplexVectorOperations::setImplementation(implementation.name);
+
+            double perChannelTime = timeFunction(numberOfRepetitions, [&]()
+            {
+                filterBox.loadChunk(chunk);
+
+                for (int channel = 0; channel < numberOfChannels; ++channel)
+                {
+                    filterBox.convolveWithKernel(channel);
+                }
+            });
+
+            double batchedTime = timeFunction(numberOfRepetitions, [&]()
+            {
+                filterBox.loadChunk(chunk);
+                filterBox.convolveAllChannelsWithKernel();
+            });
+
+            std::printf("  %-13s  %-6s  per channel %8.2f  "
+                        "batched %8.2f\n",
+                        isPartitioned ? "partitioned" : "unpartitioned",
+                        implementation.name,
+                        perChannelTime * 1e6,
+                        batchedTime * 1e6);
+        }
+    }
+
+    // restore code path selected for this CPU
+    ComplexVectorOperations::setImplementation(
+        ComplexVectorOperations::getAvailableImplementations()
+        .getFirst().name);
+}
+
+
+// time the meter engine on stereo audio at 44.1 kHz for every
+// analysis block size, averaging algorithm and low-pass filter the
+// plug-in offers
+static void benchmarkMeterEngine()
+{
+    const int numberOfRepetitions = 4;
+    const int numberOfChannels = 2;
+    const double sampleRate = 44100.0;
+    const int blockSizes[] = {256, 512, 1024, 2048, 4096};
+
+    const int averageAlgorithms[] =
+    {
+        KmeterPluginParameters::selAlgorithmItuBs1770,
+        KmeterPluginParameters::selAlgorithmRms
+    };
+
+    const int lowPassFilters[] =
+    {
+        KmeterPluginParameters::selLowPassFir,
+        KmeterPluginParameters::selLowPassIir,
+        KmeterPluginParameters::selLowPassNone
+    };
+
+    std::printf("\nMeter engine, stereo audio at 44.1 kHz (ms of CPU "
+                "time per second of audio)\n\n"
+                "  block size  algorithm      FIR      IIR     none\n");
+
+    for (auto blockSize : blockSizes)
+    {
+        // one second of audio (rounded up to whole chunks)
+        int numberOfChunks = ((int) sampleRate + blockSize - 1) / blockSize;
+
+        AudioBuffer<float> noise(numberOfChannels,
+                                 numberOfChunks * blockSize);
+        AudioBuffer<float> chunk(numberOfChannels, blockSize);
+
+        fillWithNoise(noise);
+
+        for (auto averageAlgorithm : averageAlgorithms)
+        {
+            bool isItuBs1770 = (averageAlgorithm ==
+                                KmeterPluginParameters::selAlgorithmItuBs1770);
+
+            std::printf("  %10d  %-9s",
+                        blockSize,
+                        isItuBs1770 ? "ITU-R" : "RMS");
+
+            for (auto lowPassFilter : lowPassFilters)
+            {
+                auto meterBallistics = std::make_shared<MeterBallistics>(
+                                           numberOfChannels,
+                                           averageAlgorithm,
+                                           false,
+                                           false);
+
+                MeterEngine meterEngine(numberOfChannels,
+                                        sampleRate,
+                                        blockSize,
+                                        meterBallistics,
+                                        averageAlgorithm,
+                                        lowPassFilter);
+
+                double seconds = timeFunction(numberOfRepetitions, [&]()
+                {
+                    for (int index = 0; index < numberOfChunks; ++index)
+                    {
+                        for (int channel = 0; channel < numberOfChannels;
+                                ++channel)
+                        {
+                            chunk.copyFrom(channel, 0, noise, channel,
+                                           index * blockSize, blockSize);
+                        }
+
+                        meterEngine.processChunk(chunk, false);
+                    }
+                });
+
+                double audioSeconds = numberOfChunks * blockSize / sampleRate;
+
+                std::printf("  %7.2f", 1000.0 * seconds / audioSeconds);
+            }
+
+            std::printf("\n");
+        }
+    }
+}
+
+
+static int runBenchmarks()
+{
+    benchmarkComplexMultiplication();
+    benchmarkConvolution();
+    benchmarkMeterEngine();
+
+    std::printf("\nselected: %s\n",
+                frut::dsp::ComplexVectorOperations::getImplementationName()
+                .toRawUTF8());
+
+    return 0;
+}
+
+
+static void printUsage()
+{
+    std::fprintf(
+        stderr,
+        "Usage: kmeter_analyse [options] FILE|DIRECTORY...\n"
+        "       kmeter_analyse --test\n"
+        "       kmeter_analyse --benchmark\n"
+        "\n"
+        "Meters audio files as fast as possible and writes the readings\n"
+        "of every chunk (%d samples) as CSV or JSON.  Directories are\n"
+        "searched recursively for audio files.  Several files are\n"
+        "analysed in parallel; readings are always written in the\n"
+        "order of the input files.  CSV output repeats the header\n"
+        "whenever the columns change; files that cannot be analysed\n"
+        "get a record with the columns \"file\" and \"error\".\n"
+        "\n"
+        "  --format csv|json        output format (default: csv)\n"
+        "  --crest-factor 0|12|14|20\n"
+        "                           K-System meter (default: 20)\n"
+        "  --algorithm itu|rms      averaging algorithm (default: itu)\n"
+        "  --true-peak polyphase|fft\n"
+        "                           oversampler of the true peak meter\n"
+        "                           (default: polyphase; fft is the\n"
+        "                           original one, for comparison)\n"
+        "  --channel N              report channel N only (default: all)\n"
+        "  --report LIST            comma-separated list of values to\n"
+        "                           report: avg, pk, tru, max, mxt,\n"
+        "                           stereo, corr (default: all)\n"
+        "  --output FILE            write to FILE (default: stdout)\n"
+        "  --jobs N                 analyse N files (or N segments of a\n"
+        "                           file) in parallel (default: number\n"
+        "                           of CPU cores)\n"
+        "  --summary                write one JSON summary per file\n"
+        "                           (maximum levels, overflows and a\n"
+        "                           histogram of average levels); long\n"
+        "                           files are split into segments\n"
+        "  --verify                 with --summary, also analyse every\n"
+        "                           file in one piece and fail if the\n"
+        "                           results differ\n"
+        "  --test                   run self-tests and exit (fails if\n"
+        "                           any of them fails)\n"
+        "  --benchmark              time the code paths of FFT\n"
+        "                           convolution (complex multiplication\n"
+        "                           and whole chunks) and the meter\n"
+        "                           engine for every block size,\n"
+        "                           averaging algorithm and low-pass\n"
+        "                           filter, then exit\n",
+        OfflineAnalyser::kmeterBufferSize);
+}
+
+
+int main(int argc, char *argv[])
+{
+    StringArray arguments;
+
+    for (int index = 1; index < argc; ++index)
+    {
+        arguments.add(CharPointer_UTF8(argv[index]));
+    }
+
+    OfflineAnalyser::Format format = OfflineAnalyser::formatCsv;
+    int crestFactor = 20;
+    int averageAlgorithm = KmeterPluginParameters::selAlgorithmItuBs1770;
+    int reportChannel = -1;
+    StringArray reports = StringArray::fromTokens(
+                              "avg,pk,tru,max,mxt,stereo,corr", ",", "");
+    int numberOfJobs = SystemStats::getNumCpus();
+    bool isSummary = false;
+    bool isVerifying = false;
+    bool useFftTruePeakMeter = false;
+    bool isTesting = false;
+    bool isBenchmarking = false;
+    File outputFile;
+    Array<File> audioFiles;
+
+    AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    for (int index = 0; index < arguments.size(); ++index)
+    {
+        String argument = arguments[index];
+
+        if (!argument.startsWith("--"))
+        {
+            File audioFile = File::getCurrentWorkingDirectory()
+                             .getChildFile(argument);
+
+            if (audioFile.isDirectory())
+            {
+                // sort to make output independent of file system
+                Array<File> directoryFiles;
+                audioFile.findChildFiles(
+                    directoryFiles,
+                    File::findFiles,
+                    true,
+                    formatManager.getWildcardForAllFormats());
+
+                directoryFiles.sort();
+                audioFiles.addArray(directoryFiles);
+            }
+            else
+            {
+                audioFiles.add(audioFile);
+            }
+
+            continue;
+        }
+
+        if (argument == "--summary")
+        {
+            isSummary = true;
+            continue;
+        }
+        else if (argument == "--verify")
+        {
+            isVerifying = true;
+            continue;
+        }
+        else if (argument == "--test")
+        {
+            isTesting = true;
+            continue;
+        }
+        else if (argument == "--benchmark")
+        {
+            isBenchmarking = true;
+            continue;
+        }
+
+        if (index + 1 >= arguments.size())
+        {
+            printUsage();
+            return 2;
+        }
+
+        String value = arguments[++index];
+
+        if (argument == "--format")
+        {
+            if (value == "csv")
+            {
+                format = OfflineAnalyser::formatCsv;
+            }
+            else if (value == "json")
+            {
+                format = OfflineAnalyser::formatJson;
+            }
+            else
+            {
+                printUsage();
+                return 2;
+            }
+        }
+        else if (argument == "--crest-factor")
+        {
+            crestFactor = value.getIntValue();
+
+            if ((crestFactor != 0) && (crestFactor != 12) &&
+                    (crestFactor != 14) && (crestFactor != 20))
+            {
+                printUsage();
+                return 2;
+            }
+        }
+        else if (argument == "--algorithm")
+        {
+            if (value == "itu")
+            {
+                averageAlgorithm = KmeterPluginParameters::selAlgorithmItuBs1770;
+            }
+            else if (value == "rms")
+            {
+                averageAlgorithm = KmeterPluginParameters::selAlgorithmRms;
+            }
+            else
+            {
+                printUsage();
+                return 2;
+            }
+        }
+        else if (argument == "--true-peak")
+        {
+            if (value == "polyphase")
+            {
+                useFftTruePeakMeter = false;
+            }
+            else if (value == "fft")
+            {
+                useFftTruePeakMeter = true;
+            }
+            else
+            {
+                printUsage();
+                return 2;
+            }
+        }
+        else if (argument == "--channel")
+        {
+            reportChannel = value.getIntValue() - 1;
+
+            if (reportChannel < 0)
+            {
+                printUsage();
+                return 2;
+            }
+        }
+        else if (argument == "--report")
+        {
+            reports = StringArray::fromTokens(value, ",", "");
+        }
+        else if (argument == "--jobs")
+        {
+            numberOfJobs = value.getIntValue();
+
+            if (numberOfJobs < 1)
+            {
+                printUsage();
+                return 2;
+            }
+        }
+        else if (argument == "--output")
+        {
+            outputFile = File::getCurrentWorkingDirectory()
+                         .getChildFile(value);
+        }
+        else
+        {
+            printUsage();
+            return 2;
+        }
+    }
+
+    if (isTesting)
+    {
+        return runSelfTests();
+    }
+
+    if (isBenchmarking)
+    {
+        return runBenchmarks();
+    }
+
+    if (audioFiles.isEmpty())
+    {
+        printUsage();
+        return 2;
+    }
+
+    BatchAnalyser analyser(crestFactor, averageAlgorithm, format,
+                           numberOfJobs);
+
+    analyser.setReporters(reportChannel,
+                          reports.contains("avg"),
+                          reports.contains("pk"),
+                          reports.contains("max"),
+                          reports.contains("tru"),
+                          reports.contains("mxt"),
+                          reports.contains("stereo"),
+                          reports.contains("corr"));
+
+    analyser.setFftTruePeakMeter(useFftTruePeakMeter);
+
+    std::unique_ptr<OutputStream> output;
+
+    if (outputFile == File())
+    {
+        output = std::make_unique<StandardOutputStream>();
+    }
+    else
+    {
+        // FileOutputStream appends to existing files
+        outputFile.deleteFile();
+
+        auto fileOutput = std::make_unique<FileOutputStream>(outputFile);
+
+        if (fileOutput->failedToOpen())
+        {
+            std::fprintf(stderr, "Error: could not open \"%s\"\n",
+                         outputFile.getFullPathName().toRawUTF8());
+            return 1;
+        }
+
+        output = std::move(fileOutput);
+    }
+
+    if (isSummary)
+    {
+        return summariseFiles(audioFiles, *output, crestFactor,
+                              averageAlgorithm, numberOfJobs, isVerifying,
+                              useFftTruePeakMeter);
+    }
+
+    bool hasSucceeded = analyser.analyseFiles(audioFiles, *output);
+
+    for (auto &record : analyser.getRecords())
+    {
+        if (record.hasSucceeded)
+        {
+            std::fprintf(stderr, "%s: %.1f s of audio in %.2f s (%.0fx real-time)\n",
+                         record.audioFile.getFileName().toRawUTF8(),
+                         record.analysedSeconds,
+                         record.processingSeconds,
+                         record.analysedSeconds /
+                         jmax(record.processingSeconds, 0.001));
+        }
+        else
+        {
+            std::fprintf(stderr, "Error: %s\n",
+                         record.errorMessage.toRawUTF8());
+        }
+    }
+
+    std::fprintf(stderr, "\n%d file(s), %.1f s of audio in %.2f s on %d core(s): "
+                 "%.0fx real-time (%.0fx real-time per core)\n",
+                 analyser.getRecords().size(),
+                 analyser.getAnalysedSeconds(),
+                 analyser.getElapsedSeconds(),
+                 analyser.getNumberOfWorkers(),
+                 analyser.getRealtimeFactor(),
+                 analyser.getRealtimeFactorPerCore());
+
+    return hasSucceeded ? 0 : 1;
+}
@@ -0,0 +1,504 @@
+/* ----------------------------------------------------------------------------
+
+   K-Meter
+   =======
+   Implementation of a K-System meter according to Bob Katz' specifications
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+#include "batch_analyser.h"
+
+
+/// Create a new batch analyser.  By default, all values are reported
+/// for all channels.
+///
+/// @param crestFactor crest factor of K-System meter (0, 12, 14 or
+///        20)
+///
+/// @param averageAlgorithm algorithm for averaging (see
+///        KmeterPluginParameters)
+///
+/// @param format output format
+///
+/// @param numberOfWorkers number of files to analyse in parallel
+///
+BatchAnalyser::BatchAnalyser(
+    const int crestFactor,
+    const int averageAlgorithm,
+    const OfflineAnalyser::Format format,
+    const int numberOfWorkers) :
+    crestFactor_(crestFactor),
+    averageAlgorithm_(averageAlgorithm),
+    format_(format),
+    numberOfWorkers_(jmax(1, numberOfWorkers)),
+    useFftTruePeakMeter_(false),
+    isFirstFileWritten_(false),
+    elapsedSeconds_(0.0)
+{
+    setReporters(-1, true, true, true, true, true, true, true);
+}
+
+
+BatchAnalyser::~BatchAnalyser()
+{
+    for (auto worker : workers_)
+    {
+        worker->stopThread(-1);
+    }
+}
+
+
+/// Select values to report.
+///
+/// @see OfflineAnalyser::setReporters()
+///
+void BatchAnalyser::setReporters(
+    const int reportChannel,
+    const bool reportAverageMeterLevel,
+    const bool reportPeakMeterLevel,
+    const bool reportMaximumPeakLevel,
+    const bool reportTruePeakMeterLevel,
+    const bool reportMaximumTruePeakLevel,
+    const bool reportStereoMeterValue,
+    const bool reportPhaseCorrelation)
+{
+    reportChannel_ = reportChannel;
+
+    reportAverageMeterLevel_ = reportAverageMeterLevel;
+    reportPeakMeterLevel_ = reportPeakMeterLevel;
+    reportMaximumPeakLevel_ = reportMaximumPeakLevel;
+    reportTruePeakMeterLevel_ = reportTruePeakMeterLevel;
+    reportMaximumTruePeakLevel_ = reportMaximumTruePeakLevel;
+    reportStereoMeterValue_ = reportStereoMeterValue;
+    reportPhaseCorrelation_ = reportPhaseCorrelation;
+}
+
+
+/// Select the oversampler of the true peak meter.
+///
+/// @see OfflineAnalyser::setFftTruePeakMeter()
+///
+void BatchAnalyser::setFftTruePeakMeter(
+    const bool useFftTruePeakMeter)
+{
+    useFftTruePeakMeter_ = useFftTruePeakMeter;
+}
+
+
+/// Meter audio files and write all readings to a stream.  This call
+/// blocks until all files have been analysed.  Readings are written
+/// as soon as all preceding files have been written.
+///
+/// @param audioFiles audio files to analyse
+///
+/// @param output stream that receives the readings
+///
+/// @return **true** if all files were analysed successfully
+///
+bool BatchAnalyser::analyseFiles(
+    const Array<File> &audioFiles,
+    OutputStream &output)
+{
+    int numberOfFiles = audioFiles.size();
+    int numberOfWorkers = jlimit(1, jmax(1, numberOfFiles),
+                                 numberOfWorkers_);
+
+    workers_.clear();
+    records_.clearQuick();
+    isFinished_.clearQuick();
+    readings_.clear();
+    csvHeaders_.clear();
+
+    lastCsvHeader_.clear();
+    isFirstFileWritten_ = false;
+
+    for (int fileIndex = 0; fileIndex < numberOfFiles; ++fileIndex)
+    {
+        Record record;
+
+        record.audioFile = audioFiles[fileIndex];
+        record.hasSucceeded = false;
+        record.analysedSeconds = 0.0;
+        record.processingSeconds = 0.0;
+
+        records_.add(record);
+        isFinished_.add(false);
+        readings_.add(nullptr);
+        csvHeaders_.add(String());
+    }
+
+    for (int workerIndex = 0; workerIndex < numberOfWorkers; ++workerIndex)
+    {
+        workers_.add(new Worker(*this, workerIndex));
+    }
+
+    // deal out files like cards, so that all workers progress through
+    // the list at roughly the same pace; this keeps the number of
+    // finished files waiting for output low
+    for (int fileIndex = 0; fileIndex < numberOfFiles; ++fileIndex)
+    {
+        workers_[fileIndex % numberOfWorkers]->queue_.push_back(fileIndex);
+    }
+
+    double startTime = Time::getMillisecondCounterHiRes();
+
+    if (format_ == OfflineAnalyser::formatJson)
+    {
+        output << "[";
+    }
+
+    for (auto worker : workers_)
+    {
+        worker->startThread();
+    }
+
+    int nextFileIndex = 0;
+
+    while (nextFileIndex < numberOfFiles)
+    {
+        jobFinished_.wait();
+        nextFileIndex = writeRecords(output, nextFileIndex);
+    }
+
+    for (auto worker : workers_)
+    {
+        worker->stopThread(-1);
+    }
+
+    if (format_ == OfflineAnalyser::formatJson)
+    {
+        output << "\n]\n";
+    }
+
+    output.flush();
+
+    elapsedSeconds_ = (Time::getMillisecondCounterHiRes() - startTime) /
+                      1000.0;
+
+    for (auto &record : records_)
+    {
+        if (!record.hasSucceeded)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/// Get number of workers used for the most recent batch.
+///
+/// @return number of workers
+///
+int BatchAnalyser::getNumberOfWorkers() const
+{
+    return (workers_.size() > 0) ? workers_.size() : numberOfWorkers_;
+}
+
+
+/// Get outcome of the most recent batch, in the order of the input
+/// files.
+///
+/// @return one record per file
+///
+const Array<BatchAnalyser::Record> &BatchAnalyser::getRecords() const
+{
+    return records_;
+}
+
+
+/// Get total length of all analysed audio files.
+///
+/// @return length (in seconds)
+///
+double BatchAnalyser::getAnalysedSeconds() const
+{
+    double analysedSeconds = 0.0;
+
+    for (auto &record : records_)
+    {
+        analysedSeconds += record.analysedSeconds;
+    }
+
+    return analysedSeconds;
+}
+
+
+/// Get wall-clock time of the most recent batch.
+///
+/// @return elapsed time (in seconds)
+///
+double BatchAnalyser::getElapsedSeconds() const
+{
+    return elapsedSeconds_;
+}
+
+
+/// Get throughput of the most recent batch.
+///
+/// @return seconds of audio analysed per second
+///
+double BatchAnalyser::getRealtimeFactor() const
+{
+    return getAnalysedSeconds() / jmax(elapsedSeconds_, 0.001);
+}
+
+
+/// Get throughput of the most recent batch divided by the number of
+/// workers.  This is useful for comparing machines with different
+/// numbers of cores.
+///
+/// @return seconds of audio analysed per second and worker
+///
+double BatchAnalyser::getRealtimeFactorPerCore() const
+{
+    return getRealtimeFactor() / getNumberOfWorkers();
+}
+
+
+/// Get next file for a worker.  Files are taken from the front of the
+/// worker's own queue.  When this queue is empty, files are stolen
+/// from the back of the other queues.
+///
+/// @param workerIndex index of worker asking for a file
+///
+/// @param fileIndex receives index of file to analyse
+///
+/// @return **false** if no files are left
+///
+bool BatchAnalyser::fetchJob(
+    const int workerIndex,
+    int &fileIndex)
+{
+    {
+        Worker *worker = workers_[workerIndex];
+        const ScopedLock lock(worker->queueLock_);
+
+        if (!worker->queue_.empty())
+        {
+            fileIndex = worker->queue_.front();
+            worker->queue_.pop_front();
+
+            return true;
+        }
+    }
+
+    int numberOfWorkers = workers_.size();
+
+    for (int offset = 1; offset < numberOfWorkers; ++offset)
+    {
+        Worker *victim = workers_[(workerIndex + offset) % numberOfWorkers];
+        const ScopedLock lock(victim->queueLock_);
+
+        if (!victim->queue_.empty())
+        {
+            fileIndex = victim->queue_.back();
+            victim->queue_.pop_back();
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/// Store the outcome of a file.  Called by workers.
+///
+/// @param fileIndex index of analysed file
+///
+/// @param record outcome
+///
+/// @param readings formatted readings
+///
+/// @param csvHeader CSV header matching the readings
+///
+void BatchAnalyser::finishJob(
+    const int fileIndex,
+    const Record &record,
+    std::unique_ptr<MemoryOutputStream> readings,
+    const String &csvHeader)
+{
+    {
+        const ScopedLock lock(resultsLock_);
+
+        records_.set(fileIndex, record);
+        readings_.set(fileIndex, readings.release());
+        csvHeaders_.set(fileIndex, csvHeader);
+        isFinished_.set(fileIndex, true);
+    }
+
+    jobFinished_.signal();
+}
+
+
+/// Write readings of finished files, stopping at the first file that
+/// is still being analysed.  Written readings are released.
+///
+/// @param output stream that receives the readings
+///
+/// @param fileIndex index of first file to write
+///
+/// @return index of first file that has not been written
+///
+int BatchAnalyser::writeRecords(
+    OutputStream &output,
+    int fileIndex)
+{
+    bool isJson = (format_ == OfflineAnalyser::formatJson);
+
+    while (true)
+    {
+        std::unique_ptr<MemoryOutputStream> readings;
+        String csvHeader;
+
+        {
+            const ScopedLock lock(resultsLock_);
+
+            if ((fileIndex >= isFinished_.size()) ||
+                    !isFinished_[fileIndex])
+            {
+                return fileIndex;
+            }
+
+            readings.reset(readings_[fileIndex]);
+            readings_.set(fileIndex, nullptr, false);
+
+            csvHeader = csvHeaders_[fileIndex];
+        }
+
+        if (isJson)
+        {
+            // separate JSON objects of previous files
+            output << (isFirstFileWritten_ ? ",\n" : "\n");
+            isFirstFileWritten_ = true;
+        }
+        else if (csvHeader != lastCsvHeader_)
+        {
+            // files with the same columns share a CSV header; write
+            // a new one whenever the columns change (for example, for
+            // a different number of channels or an error record)
+            output << csvHeader;
+            lastCsvHeader_ = csvHeader;
+        }
+
+        if (readings != nullptr)
+        {
+            output << *readings;
+        }
+
+        ++fileIndex;
+    }
+}
+
+
+/// Create a new worker.
+///
+/// @param batchAnalyser owner of worker
+///
+/// @param workerIndex index of worker
+///
+BatchAnalyser::Worker::Worker(
+    BatchAnalyser &batchAnalyser,
+    const int workerIndex) :
+    Thread("K-Meter batch worker " + String(workerIndex + 1)),
+    batchAnalyser_(batchAnalyser),
+    workerIndex_(workerIndex),
+    offlineAnalyser_(batchAnalyser.crestFactor_,
+                     batchAnalyser.averageAlgorithm_,
+                     batchAnalyser.format_),
+    readAheadThread_("K-Meter read-ahead " + String(workerIndex + 1))
+{
+    offlineAnalyser_.setReporters(
+        batchAnalyser.reportChannel_,
+        batchAnalyser.reportAverageMeterLevel_,
+        batchAnalyser.reportPeakMeterLevel_,
+        batchAnalyser.reportMaximumPeakLevel_,
+        batchAnalyser.reportTruePeakMeterLevel_,
+        batchAnalyser.reportMaximumTruePeakLevel_,
+        batchAnalyser.reportStereoMeterValue_,
+        batchAnalyser.reportPhaseCorrelation_);
+
+    offlineAnalyser_.setReadAhead(&readAheadThread_, readAheadSamples);
+    offlineAnalyser_.setFftTruePeakMeter(batchAnalyser.useFftTruePeakMeter_);
+
+    // the batch analyser writes the CSV header
+    offlineAnalyser_.setCsvHeaderWritten(true);
+}
+
+
+/// Analyse files until none are left.
+///
+void BatchAnalyser::Worker::run()
+{
+    readAheadThread_.startThread();
+
+    int fileIndex;
+
+    while (!threadShouldExit() &&
+            batchAnalyser_.fetchJob(workerIndex_, fileIndex))
+    {
+        Record record;
+
+        {
+            const ScopedLock lock(batchAnalyser_.resultsLock_);
+            record.audioFile =
+                batchAnalyser_.records_.getReference(fileIndex).audioFile;
+        }
+
+        record.analysedSeconds = 0.0;
+
+        auto readings = std::make_unique<MemoryOutputStream>();
+        double startTime = Time::getMillisecondCounterHiRes();
+
+        record.hasSucceeded = offlineAnalyser_.analyseFile(
+                                  record.audioFile,
+                                  *readings,
+                                  record.errorMessage);
+
+        record.processingSeconds =
+            (Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+
+        String csvHeader;
+
+        if (record.hasSucceeded)
+        {
+            record.analysedSeconds = offlineAnalyser_.getAnalysedSeconds();
+            csvHeader = offlineAnalyser_.getCsvHeader();
+        }
+        else
+        {
+            // replace partial readings with an error record
+            readings = std::make_unique<MemoryOutputStream>();
+            *readings << offlineAnalyser_.formatError(record.audioFile,
+                                                      record.errorMessage);
+
+            csvHeader = offlineAnalyser_.getCsvErrorHeader();
+        }
+
+        batchAnalyser_.finishJob(fileIndex,
+                                 record,
+                                 std::move(readings),
+                                 csvHeader);
+    }
+
+    readAheadThread_.stopThread(1000);
+}
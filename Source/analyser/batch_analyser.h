@@ -0,0 +1,164 @@
+/* ----------------------------------------------------------------------------
+
+   K-Meter
+   =======
+   Implementation of a K-System meter according to Bob Katz' specifications
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+#ifndef KMETER_BATCH_ANALYSER_H
+#define KMETER_BATCH_ANALYSER_H
+
+#include "FrutHeader.h"
+#include "offline_analyser.h"
+
+#include <deque>
+
+
+/// Meters many audio files in parallel.  Files are scheduled onto a
+/// pool of workers; a worker that runs out of files steals from the
+/// others.  Every worker owns an offline analyser (and thus its own
+/// filter states; FFTW plans are shared by all workers, and
+/// FftwPlanner serialises their creation) and decodes its current
+/// file on a separate thread with bounded read-ahead, so that disk
+/// access and decoding overlap with metering.
+///
+/// Readings are written in the order of the input files, regardless
+/// of which worker finishes first.
+///
+class BatchAnalyser
+{
+public:
+    /// Outcome of analysing a single audio file.
+    struct Record
+    {
+        File audioFile;
+        bool hasSucceeded;
+        String errorMessage;
+
+        /// length of audio file (in seconds)
+        double analysedSeconds;
+
+        /// time spent analysing the file (in seconds)
+        double processingSeconds;
+    };
+
+    BatchAnalyser(const int crestFactor,
+                  const int averageAlgorithm,
+                  const OfflineAnalyser::Format format,
+                  const int numberOfWorkers);
+
+    ~BatchAnalyser();
+
+    void setReporters(const int reportChannel,
+                      const bool reportAverageMeterLevel,
+                      const bool reportPeakMeterLevel,
+                      const bool reportMaximumPeakLevel,
+                      const bool reportTruePeakMeterLevel,
+                      const bool reportMaximumTruePeakLevel,
+                      const bool reportStereoMeterValue,
+                      const bool reportPhaseCorrelation);
+
+    void setFftTruePeakMeter(const bool useFftTruePeakMeter);
+
+    bool analyseFiles(const Array<File> &audioFiles,
+                      OutputStream &output);
+
+    int getNumberOfWorkers() const;
+    const Array<Record> &getRecords() const;
+
+    double getAnalysedSeconds() const;
+    double getElapsedSeconds() const;
+
+    double getRealtimeFactor() const;
+    double getRealtimeFactorPerCore() const;
+
+    /// maximum number of samples a worker decodes ahead
+    static const int readAheadSamples = 65536;
+
+private:
+    JUCE_LEAK_DETECTOR(BatchAnalyser);
+
+    class Worker :
+        public Thread
+    {
+    public:
+        Worker(BatchAnalyser &batchAnalyser,
+               const int workerIndex);
+
+        void run() override;
+
+    private:
+        friend class BatchAnalyser;
+
+        BatchAnalyser &batchAnalyser_;
+        const int workerIndex_;
+
+        OfflineAnalyser offlineAnalyser_;
+        TimeSliceThread readAheadThread_;
+
+        CriticalSection queueLock_;
+        std::deque<int> queue_;
+    };
+
+    bool fetchJob(const int workerIndex,
+                  int &fileIndex);
+
+    void finishJob(const int fileIndex,
+                   const Record &record,
+                   std::unique_ptr<MemoryOutputStream> readings,
+                   const String &csvHeader);
+
+    int writeRecords(OutputStream &output,
+                     int fileIndex);
+
+    int crestFactor_;
+    int averageAlgorithm_;
+    OfflineAnalyser::Format format_;
+    int numberOfWorkers_;
+
+    int reportChannel_;
+    bool reportAverageMeterLevel_;
+    bool reportPeakMeterLevel_;
+    bool reportMaximumPeakLevel_;
+    bool reportTruePeakMeterLevel_;
+    bool reportMaximumTruePeakLevel_;
+    bool reportStereoMeterValue_;
+    bool reportPhaseCorrelation_;
+
+    bool useFftTruePeakMeter_;
+
+    OwnedArray<Worker> workers_;
+
+    CriticalSection resultsLock_;
+    WaitableEvent jobFinished_;
+
+    Array<Record> records_;
+    Array<bool> isFinished_;
+    OwnedArray<MemoryOutputStream> readings_;
+    StringArray csvHeaders_;
+
+    String lastCsvHeader_;
+    bool isFirstFileWritten_;
+
+    double elapsedSeconds_;
+};
+
+#endif  // KMETER_BATCH_ANALYSER_H
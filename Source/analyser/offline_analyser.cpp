@@ -0,0 +1,691 @@
+/* ----------------------------------------------------------------------------
+
+   K-Meter
+   =======
+   Implementation of a K-System meter according to Bob Katz' specifications
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+#include "offline_analyser.h"
+
+
+/// Create a new offline analyser.  By default, all values are
+/// reported for all channels.
+///
+/// @param crestFactor crest factor of K-System meter (0, 12, 14 or
+///        20)
+///
+/// @param averageAlgorithm algorithm for averaging (see
+///        KmeterPluginParameters)
+///
+/// @param format output format
+///
+OfflineAnalyser::OfflineAnalyser(
+    const int crestFactor,
+    const int averageAlgorithm,
+    const Format format) :
+    crestFactor_(crestFactor),
+    averageAlgorithm_(averageAlgorithm),
+    format_(format),
+    readAheadThread_(nullptr),
+    readAheadSamples_(0),
+    useFftTruePeakMeter_(false),
+    analysedSeconds_(0.0),
+    isHeaderWritten_(false),
+    isFirstReading_(true)
+{
+    setReporters(-1, true, true, true, true, true, true, true);
+}
+
+
+/// Select values to report.
+///
+/// @param reportChannel channel to report (-1 reports all channels)
+///
+/// @param reportAverageMeterLevel report average level
+///
+/// @param reportPeakMeterLevel report peak level
+///
+/// @param reportMaximumPeakLevel report maximum peak level
+///
+/// @param reportTruePeakMeterLevel report true peak level
+///
+/// @param reportMaximumTruePeakLevel report maximum true peak level
+///
+/// @param reportStereoMeterValue report stereo meter value (stereo
+///        files only)
+///
+/// @param reportPhaseCorrelation report phase correlation (stereo
+///        files only)
+///
+void OfflineAnalyser::setReporters(
+    const int reportChannel,
+    const bool reportAverageMeterLevel,
+    const bool reportPeakMeterLevel,
+    const bool reportMaximumPeakLevel,
+    const bool reportTruePeakMeterLevel,
+    const bool reportMaximumTruePeakLevel,
+    const bool reportStereoMeterValue,
+    const bool reportPhaseCorrelation)
+{
+    reportChannel_ = reportChannel;
+
+    reportAverageMeterLevel_ = reportAverageMeterLevel;
+    reportPeakMeterLevel_ = reportPeakMeterLevel;
+    reportMaximumPeakLevel_ = reportMaximumPeakLevel;
+    reportTruePeakMeterLevel_ = reportTruePeakMeterLevel;
+    reportMaximumTruePeakLevel_ = reportMaximumTruePeakLevel;
+    reportStereoMeterValue_ = reportStereoMeterValue;
+    reportPhaseCorrelation_ = reportPhaseCorrelation;
+}
+
+
+/// Decode audio files on a background thread while metering.  The
+/// thread must be running and outlive all calls to analyseFile().
+///
+/// @param readAheadThread thread that reads ahead (**nullptr**
+///        reads synchronously)
+///
+/// @param samplesToBuffer maximum number of samples to read ahead
+///
+void OfflineAnalyser::setReadAhead(
+    TimeSliceThread *readAheadThread,
+    const int samplesToBuffer)
+{
+    readAheadThread_ = readAheadThread;
+    readAheadSamples_ = samplesToBuffer;
+}
+
+
+/// Select the oversampler of the true peak meter.
+///
+/// @param useFftTruePeakMeter if **true**, use the original FFT-based
+///        oversampler instead of the polyphase interpolator (for
+///        comparing their readings)
+///
+void OfflineAnalyser::setFftTruePeakMeter(
+    const bool useFftTruePeakMeter)
+{
+    useFftTruePeakMeter_ = useFftTruePeakMeter;
+
+    // create a new meter engine for the next file
+    meterEngine_ = nullptr;
+}
+
+
+/// Prevent or allow writing of the CSV header.  It is written before
+/// the first reading and whenever the columns change (for example,
+/// when files have different numbers of channels).
+///
+/// @param isHeaderWritten if **true**, the CSV header is never written
+///
+void OfflineAnalyser::setCsvHeaderWritten(
+    const bool isHeaderWritten)
+{
+    isHeaderWritten_ = isHeaderWritten;
+}
+
+
+/// Get CSV header for the columns of the most recently analysed
+/// audio file.
+///
+/// @return formatted string
+///
+String OfflineAnalyser::getCsvHeader() const
+{
+    String header = "\"file\",\"timecode\"";
+
+    for (auto &columnName : columnNames_)
+    {
+        header += ",\"" + columnName + "\"";
+    }
+
+    return header + "\n";
+}
+
+
+/// Get CSV header for error records.
+///
+/// @return formatted string
+///
+/// @see formatError
+///
+String OfflineAnalyser::getCsvErrorHeader() const
+{
+    return "\"file\",\"error\"\n";
+}
+
+
+/// Format a record for an audio file that could not be analysed.
+/// CSV records match getCsvErrorHeader().
+///
+/// @param audioFile audio file
+///
+/// @param errorMessage description of what went wrong
+///
+/// @return formatted string
+///
+String OfflineAnalyser::formatError(
+    const File &audioFile,
+    const String &errorMessage) const
+{
+    if (format_ == formatJson)
+    {
+        return "{\n"
+               "  \"file\": " +
+               JSON::toString(audioFile.getFullPathName()) + ",\n"
+               "  \"error\": " + JSON::toString(errorMessage) + "\n"
+               "}";
+    }
+
+    // quote file name and message for CSV
+    String fileName = audioFile.getFullPathName().replace("\"", "\"\"");
+    String message = errorMessage.replace("\"", "\"\"");
+
+    return "\"" + fileName + "\",\"" + message + "\"\n";
+}
+
+
+/// Meter an audio file and write all readings to a stream.
+///
+/// @param audioFile audio file to analyse
+///
+/// @param output stream that receives the readings
+///
+/// @param errorMessage receives a description of what went wrong
+///
+/// @return **true** on success
+///
+bool OfflineAnalyser::analyseFile(
+    const File &audioFile,
+    OutputStream &output,
+    String &errorMessage)
+{
+    AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<AudioFormatReader> reader(
+        formatManager.createReaderFor(audioFile));
+
+    if (reader == nullptr)
+    {
+        errorMessage = "could not open \"" +
+                       audioFile.getFullPathName() + "\"";
+        return false;
+    }
+
+    if ((reader->sampleRate < 44100) || (reader->sampleRate > 192000))
+    {
+        errorMessage = "sample rate of " + String(reader->sampleRate) +
+                       " Hz not supported (\"" +
+                       audioFile.getFullPathName() + "\")";
+        return false;
+    }
+
+    if (reportChannel_ >= (int) reader->numChannels)
+    {
+        errorMessage = "channel " + String(reportChannel_ + 1) +
+                       " not found (\"" +
+                       audioFile.getFullPathName() + "\")";
+        return false;
+    }
+
+    if (readAheadThread_ != nullptr)
+    {
+        auto bufferingReader = new BufferingAudioReader(
+            reader.release(), *readAheadThread_, readAheadSamples_);
+
+        // block until data is available instead of returning silence
+        bufferingReader->setReadTimeout(-1);
+        reader.reset(bufferingReader);
+    }
+
+    analysedSeconds_ = 0.0;
+    analyseReader(audioFile, *reader, output);
+
+    return true;
+}
+
+
+/// Get length of the most recently analysed audio file.
+///
+/// @return length (in seconds)
+///
+double OfflineAnalyser::getAnalysedSeconds() const
+{
+    return analysedSeconds_;
+}
+
+
+/// Meter all samples provided by a reader.  The last chunk is padded
+/// with silence.  The meter engine (and its FFTW plans) is re-used
+/// for subsequent files with the same format.
+///
+/// @param audioFile audio file (used for output only)
+///
+/// @param reader audio source
+///
+/// @param output stream that receives the readings
+///
+void OfflineAnalyser::analyseReader(
+    const File &audioFile,
+    AudioFormatReader &reader,
+    OutputStream &output)
+{
+    int numberOfChannels = (int) reader.numChannels;
+    int64 numberOfSamples = reader.lengthInSamples;
+
+    if ((meterEngine_ != nullptr) &&
+            (meterEngine_->getNumberOfChannels() == numberOfChannels) &&
+            (meterEngine_->getSampleRate() == reader.sampleRate))
+    {
+        meterEngine_->reset();
+
+        // also resets the timers of peak marks
+        meterBallistics_->setPeakMeterInfiniteHold(false);
+        meterBallistics_->setAverageMeterInfiniteHold(false);
+        meterBallistics_->reset();
+    }
+    else
+    {
+        // release old FFTW plans first
+        meterEngine_ = nullptr;
+
+        meterBallistics_ = std::make_shared<MeterBallistics>(
+                               numberOfChannels,
+                               averageAlgorithm_,
+                               false,
+                               false);
+
+        meterEngine_ = std::make_unique<MeterEngine>(
+                           numberOfChannels,
+                           reader.sampleRate,
+                           kmeterBufferSize,
+                           meterBallistics_,
+                           averageAlgorithm_,
+                           KmeterPluginParameters::selLowPassFir,
+                           false,
+                           useFftTruePeakMeter_);
+    }
+
+    AudioBuffer<float> chunk(numberOfChannels, kmeterBufferSize);
+    bool isMono = false;
+
+    output << formatHeader(audioFile, reader);
+
+    for (int64 position = 0; position < numberOfSamples;
+            position += kmeterBufferSize)
+    {
+        int samplesToRead = (int) jmin((int64) kmeterBufferSize,
+                                       numberOfSamples - position);
+
+        // pad last chunk with silence
+        if (samplesToRead < kmeterBufferSize)
+        {
+            chunk.clear();
+        }
+
+        reader.read(&chunk, 0, samplesToRead, position, true, true);
+        meterEngine_->processChunk(chunk, isMono);
+
+        output << formatReading(audioFile,
+                                position + samplesToRead,
+                                reader.sampleRate,
+                                *meterBallistics_);
+    }
+
+    output << formatFooter();
+
+    analysedSeconds_ = (double) numberOfSamples / reader.sampleRate;
+}
+
+
+/// Format start of output for an audio file.  This also determines
+/// the column names.
+///
+/// @param audioFile audio file
+///
+/// @param reader audio source
+///
+/// @return formatted string
+///
+String OfflineAnalyser::formatHeader(
+    const File &audioFile,
+    const AudioFormatReader &reader)
+{
+    int numberOfChannels = (int) reader.numChannels;
+    bool isStereo = (numberOfChannels == 2);
+
+    columnNames_.clear();
+
+    if (reportAverageMeterLevel_)
+    {
+        addColumns(columnNames_, "avg_", numberOfChannels);
+    }
+
+    if (reportPeakMeterLevel_)
+    {
+        addColumns(columnNames_, "pk_", numberOfChannels);
+    }
+
+    if (reportTruePeakMeterLevel_)
+    {
+        addColumns(columnNames_, "tru_", numberOfChannels);
+    }
+
+    if (reportMaximumPeakLevel_)
+    {
+        addColumns(columnNames_, "max_", numberOfChannels);
+    }
+
+    if (reportMaximumTruePeakLevel_)
+    {
+        addColumns(columnNames_, "mxt_", numberOfChannels);
+    }
+
+    if (reportStereoMeterValue_ && isStereo)
+    {
+        columnNames_.add("stereo");
+    }
+
+    if (reportPhaseCorrelation_ && isStereo)
+    {
+        columnNames_.add("corr");
+    }
+
+    isFirstReading_ = true;
+
+    if (format_ == formatJson)
+    {
+        String crestFactorName;
+
+        if (crestFactor_ == 20)
+        {
+            crestFactorName = "K-20";
+        }
+        else if (crestFactor_ == 14)
+        {
+            crestFactorName = "K-14";
+        }
+        else if (crestFactor_ == 12)
+        {
+            crestFactorName = "K-12";
+        }
+        else
+        {
+            crestFactorName = "NORM";
+        }
+
+        String algorithmName =
+            (averageAlgorithm_ == KmeterPluginParameters::selAlgorithmRms) ?
+            "RMS" : "ITU-R BS.1770-1";
+
+        return "{\n"
+               "  \"file\": " +
+               JSON::toString(audioFile.getFullPathName()) + ",\n"
+               "  \"channels\": " + String(numberOfChannels) + ",\n"
+               "  \"sample_rate\": " + String(roundToInt(reader.sampleRate)) +
+               ",\n"
+               "  \"crest_factor\": \"" + crestFactorName + "\",\n"
+               "  \"algorithm\": \"" + algorithmName + "\",\n"
+               "  \"readings\": [";
+    }
+
+    // files with the same columns share a CSV header
+    String header = getCsvHeader();
+
+    if (isHeaderWritten_ || (header == lastCsvHeader_))
+    {
+        return String();
+    }
+
+    lastCsvHeader_ = header;
+
+    return header;
+}
+
+
+/// Format meter readings.
+///
+/// @param audioFile audio file
+///
+/// @param position sample position of readings
+///
+/// @param sampleRate sample rate of audio file
+///
+/// @param meterBallistics meter ballistics to read from
+///
+/// @return formatted string
+///
+String OfflineAnalyser::formatReading(
+    const File &audioFile,
+    const int64 position,
+    const double sampleRate,
+    MeterBallistics &meterBallistics)
+{
+    StringArray values;
+
+    int numberOfChannels = meterBallistics.getNumberOfChannels();
+    bool isStereo = (numberOfChannels == 2);
+    float crestFactor = (float) crestFactor_;
+
+    if (reportAverageMeterLevel_)
+    {
+        addValues(values, numberOfChannels, [&](int channel)
+        {
+            return crestFactor + meterBallistics.getAverageMeterLevel(channel);
+        });
+    }
+
+    if (reportPeakMeterLevel_)
+    {
+        addValues(values, numberOfChannels, [&](int channel)
+        {
+            return crestFactor + meterBallistics.getPeakMeterLevel(channel);
+        });
+    }
+
+    if (reportTruePeakMeterLevel_)
+    {
+        addValues(values, numberOfChannels, [&](int channel)
+        {
+            return crestFactor + meterBallistics.getTruePeakMeterLevel(channel);
+        });
+    }
+
+    if (reportMaximumPeakLevel_)
+    {
+        addValues(values, numberOfChannels, [&](int channel)
+        {
+            return crestFactor + meterBallistics.getMaximumPeakLevel(channel);
+        });
+    }
+
+    if (reportMaximumTruePeakLevel_)
+    {
+        addValues(values, numberOfChannels, [&](int channel)
+        {
+            return crestFactor + meterBallistics.getMaximumTruePeakLevel(channel);
+        });
+    }
+
+    if (reportStereoMeterValue_ && isStereo)
+    {
+        values.add(formatValue(meterBallistics.getStereoMeterValue()));
+    }
+
+    if (reportPhaseCorrelation_ && isStereo)
+    {
+        values.add(formatValue(meterBallistics.getPhaseCorrelation()));
+    }
+
+    jassert(values.size() == columnNames_.size());
+
+    String timecode = formatTime(position, sampleRate);
+
+    if (format_ == formatJson)
+    {
+        String reading = isFirstReading_ ? "\n" : ",\n";
+        isFirstReading_ = false;
+
+        reading += "    {\"timecode\": \"" + timecode + "\"";
+
+        for (int index = 0; index < values.size(); ++index)
+        {
+            // JSON does not allow a leading plus sign
+            reading += ", \"" + columnNames_[index] + "\": " +
+                       values[index].trimCharactersAtStart("+");
+        }
+
+        return reading + "}";
+    }
+
+    // quote file name for CSV
+    String fileName = audioFile.getFullPathName().replace("\"", "\"\"");
+    String reading = "\"" + fileName + "\",\"" + timecode + "\"";
+
+    for (auto &value : values)
+    {
+        reading += "," + value;
+    }
+
+    return reading + "\n";
+}
+
+
+/// Format end of output for an audio file.
+///
+/// @return formatted string
+///
+String OfflineAnalyser::formatFooter()
+{
+    if (format_ == formatJson)
+    {
+        return "\n  ]\n}";
+    }
+
+    return String();
+}
+
+
+/// Format sample position as "mm:ss.fff".
+///
+/// @param position sample position
+///
+/// @param sampleRate sample rate
+///
+/// @return formatted string
+///
+String OfflineAnalyser::formatTime(
+    const int64 position,
+    const double sampleRate)
+{
+    double time = (double) position / sampleRate;
+
+    int64 seconds = (int64) time;
+    int milliSeconds = int(1000.0 * (time - (double) seconds) + 0.5);
+
+    // avoid "00:00.1000"
+    if (milliSeconds >= 1000)
+    {
+        ++seconds;
+        milliSeconds -= 1000;
+    }
+
+    String minutesString = String(seconds / 60).paddedLeft('0', 2);
+    String secondsString = String(seconds % 60).paddedLeft('0', 2);
+    String milliSecondsString = String(milliSeconds).paddedLeft('0', 3);
+
+    return minutesString + ":" + secondsString + "." + milliSecondsString;
+}
+
+
+/// Format a value just like the validation reporters.
+///
+/// @param value value to format
+///
+/// @return formatted string
+///
+String OfflineAnalyser::formatValue(
+    const float value)
+{
+    if (value < 0.0f)
+    {
+        return String(value, 2);
+    }
+    else
+    {
+        return "+" + String(value, 2);
+    }
+}
+
+
+/// Add column names for all reported channels.
+///
+/// @param columnNames array to add to
+///
+/// @param prefix prefix of column name
+///
+/// @param numberOfChannels number of channels in audio file
+///
+void OfflineAnalyser::addColumns(
+    StringArray &columnNames,
+    const String &prefix,
+    const int numberOfChannels)
+{
+    if (reportChannel_ < 0)
+    {
+        for (int channel = 0; channel < numberOfChannels; ++channel)
+        {
+            columnNames.add(prefix + String(channel + 1));
+        }
+    }
+    else
+    {
+        columnNames.add(prefix + String(reportChannel_ + 1));
+    }
+}
+
+
+/// Add formatted levels for all reported channels.
+///
+/// @param values array to add to
+///
+/// @param numberOfChannels number of channels in audio file
+///
+/// @param getLevel returns the level of a channel
+///
+void OfflineAnalyser::addValues(
+    StringArray &values,
+    const int numberOfChannels,
+    std::function<float(int)> getLevel)
+{
+    if (reportChannel_ < 0)
+    {
+        for (int channel = 0; channel < numberOfChannels; ++channel)
+        {
+            values.add(formatValue(getLevel(channel)));
+        }
+    }
+    else
+    {
+        values.add(formatValue(getLevel(reportChannel_)));
+    }
+}
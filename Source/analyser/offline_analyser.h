@@ -0,0 +1,152 @@
+/* ----------------------------------------------------------------------------
+
+   K-Meter
+   =======
+   Implementation of a K-System meter according to Bob Katz' specifications
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+#ifndef KMETER_OFFLINE_ANALYSER_H
+#define KMETER_OFFLINE_ANALYSER_H
+
+#include "FrutHeader.h"
+#include "../meter_ballistics.h"
+#include "../meter_engine.h"
+#include "../plugin_parameters.h"
+
+
+/// Meters audio files without host, audio device or GUI.  Files are
+/// read as fast as possible and fed through the same meter engine
+/// the plug-in uses.  The readings of every chunk are written to a
+/// stream as CSV or JSON.  Values and column names match those of
+/// the validation reporters.
+///
+/// Unlike during validation, readings are not delayed by the
+/// plug-in's latency, and files may have any supported sample rate.
+///
+class OfflineAnalyser
+{
+public:
+    /// Output formats.
+    enum Format  // public namespace
+    {
+        /// comma-separated values (one line per chunk)
+        formatCsv = 0,
+
+        /// one JSON object per file
+        formatJson,
+
+        numberOfFormats
+    };
+
+    OfflineAnalyser(const int crestFactor,
+                    const int averageAlgorithm,
+                    const Format format);
+
+    void setReporters(const int reportChannel,
+                      const bool reportAverageMeterLevel,
+                      const bool reportPeakMeterLevel,
+                      const bool reportMaximumPeakLevel,
+                      const bool reportTruePeakMeterLevel,
+                      const bool reportMaximumTruePeakLevel,
+                      const bool reportStereoMeterValue,
+                      const bool reportPhaseCorrelation);
+
+    void setReadAhead(TimeSliceThread *readAheadThread,
+                      const int samplesToBuffer);
+
+    void setFftTruePeakMeter(const bool useFftTruePeakMeter);
+
+    void setCsvHeaderWritten(const bool isHeaderWritten);
+    String getCsvHeader() const;
+    String getCsvErrorHeader() const;
+
+    String formatError(const File &audioFile,
+                       const String &errorMessage) const;
+
+    bool analyseFile(const File &audioFile,
+                     OutputStream &output,
+                     String &errorMessage);
+
+    double getAnalysedSeconds() const;
+
+    static const int kmeterBufferSize = 1024;
+
+protected:
+    void analyseReader(const File &audioFile,
+                       AudioFormatReader &reader,
+                       OutputStream &output);
+
+    String formatHeader(const File &audioFile,
+                        const AudioFormatReader &reader);
+
+    String formatReading(const File &audioFile,
+                         const int64 position,
+                         const double sampleRate,
+                         MeterBallistics &meterBallistics);
+
+    String formatFooter();
+
+    String formatTime(const int64 position,
+                      const double sampleRate);
+
+    String formatValue(const float value);
+
+    void addColumns(StringArray &columnNames,
+                    const String &prefix,
+                    const int numberOfChannels);
+
+    void addValues(StringArray &values,
+                   const int numberOfChannels,
+                   std::function<float(int)> getLevel);
+
+    int crestFactor_;
+    int averageAlgorithm_;
+    Format format_;
+
+    int reportChannel_;
+    bool reportAverageMeterLevel_;
+    bool reportPeakMeterLevel_;
+    bool reportMaximumPeakLevel_;
+    bool reportTruePeakMeterLevel_;
+    bool reportMaximumTruePeakLevel_;
+    bool reportStereoMeterValue_;
+    bool reportPhaseCorrelation_;
+
+    TimeSliceThread *readAheadThread_;
+    int readAheadSamples_;
+
+    bool useFftTruePeakMeter_;
+
+    std::unique_ptr<MeterEngine> meterEngine_;
+    std::shared_ptr<MeterBallistics> meterBallistics_;
+
+    double analysedSeconds_;
+
+    StringArray columnNames_;
+    bool isHeaderWritten_;
+    String lastCsvHeader_;
+    bool isFirstReading_;
+
+private:
+    JUCE_LEAK_DETECTOR(OfflineAnalyser);
+};
+
+#endif  // KMETER_OFFLINE_ANALYSER_H
@@ -0,0 +1,601 @@
+/* ----------------------------------------------------------------------------
+
+   K-Meter
+   =======
+   Implementation of a K-System meter according to Bob Katz' specifications
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+#include "segmented_analyser.h"
+#include "offline_analyser.h"
+
+
+// pre-roll of every segment; average meter ballistics reach 99 % of
+// their final reading in 0.6 s, so after 3 seconds the remaining
+// deviation is far below the resolution of floating-point numbers
+const double PRE_ROLL_SECONDS = 3.0;
+
+// maximum share of histogram readings that may end up in a different
+// bin when analysing a file in segments
+const double HISTOGRAM_TOLERANCE = 0.001;
+
+
+SegmentedAnalyser::Summary::Summary() :
+    numberOfChannels(0),
+    sampleRate(0.0),
+    analysedSeconds(0.0),
+    numberOfReadings(0)
+{
+}
+
+
+/// Clear summary.
+///
+/// @param numberOfChannelsNew number of audio channels
+///
+/// @param sampleRateNew sample rate of audio (in Hz)
+///
+void SegmentedAnalyser::Summary::initialise(
+    const int numberOfChannelsNew,
+    const double sampleRateNew)
+{
+    float meterMinimumDecibel = MeterBallistics::getMeterMinimumDecibel();
+
+    numberOfChannels = numberOfChannelsNew;
+    sampleRate = sampleRateNew;
+
+    analysedSeconds = 0.0;
+    numberOfReadings = 0;
+
+    maximumPeakLevels.clearQuick();
+    maximumTruePeakLevels.clearQuick();
+    overflowCounts.clearQuick();
+    histogram.clearQuick();
+
+    for (int channel = 0; channel < numberOfChannels; ++channel)
+    {
+        maximumPeakLevels.add(meterMinimumDecibel);
+        maximumTruePeakLevels.add(meterMinimumDecibel);
+        overflowCounts.add(0);
+
+        for (int bin = 0; bin < numberOfHistogramBins; ++bin)
+        {
+            histogram.add(0);
+        }
+    }
+}
+
+
+/// Add the summary of a later part of the same file.
+///
+/// @param other summary to add
+///
+void SegmentedAnalyser::Summary::merge(
+    const Summary &other)
+{
+    jassert(other.numberOfChannels == numberOfChannels);
+
+    analysedSeconds += other.analysedSeconds;
+    numberOfReadings += other.numberOfReadings;
+
+    for (int channel = 0; channel < numberOfChannels; ++channel)
+    {
+        maximumPeakLevels.set(
+            channel,
+            jmax(maximumPeakLevels[channel],
+                 other.maximumPeakLevels[channel]));
+
+        maximumTruePeakLevels.set(
+            channel,
+            jmax(maximumTruePeakLevels[channel],
+                 other.maximumTruePeakLevels[channel]));
+
+        overflowCounts.set(
+            channel,
+            overflowCounts[channel] + other.overflowCounts[channel]);
+    }
+
+    for (int index = 0; index < histogram.size(); ++index)
+    {
+        histogram.set(index, histogram[index] + other.histogram[index]);
+    }
+}
+
+
+/// Add readings of a single chunk.  Call once per channel and
+/// increment numberOfReadings afterwards.
+///
+/// @param channel audio channel
+///
+/// @param peakLevel peak level of chunk (linear scale)
+///
+/// @param truePeakLevel true peak level of chunk (linear scale)
+///
+/// @param overflowCount number of overflows in chunk
+///
+/// @param averageMeterLevel average meter reading after ballistics
+///        (in decibels)
+///
+void SegmentedAnalyser::Summary::addReading(
+    const int channel,
+    const float peakLevel,
+    const float truePeakLevel,
+    const int overflowCount,
+    const float averageMeterLevel)
+{
+    // convert just like MeterBallistics, so that maximum levels are
+    // identical
+    float peakLevelDecibel = MeterBallistics::level2decibel(peakLevel);
+    float truePeakLevelDecibel = MeterBallistics::level2decibel(truePeakLevel);
+
+    if (peakLevelDecibel > maximumPeakLevels[channel])
+    {
+        maximumPeakLevels.set(channel, peakLevelDecibel);
+    }
+
+    if (truePeakLevelDecibel > maximumTruePeakLevels[channel])
+    {
+        maximumTruePeakLevels.set(channel, truePeakLevelDecibel);
+    }
+
+    overflowCounts.set(channel, overflowCounts[channel] + overflowCount);
+
+    int bin = (int) std::floor(averageMeterLevel - histogramMinimumDecibel);
+    bin = jlimit(0, numberOfHistogramBins - 1, bin);
+
+    int index = channel * numberOfHistogramBins + bin;
+    histogram.set(index, histogram[index] + 1);
+}
+
+
+/// Get number of average meter readings in a histogram bin.
+///
+/// @param channel audio channel
+///
+/// @param bin histogram bin
+///
+/// @return number of readings
+///
+int SegmentedAnalyser::Summary::getHistogramCount(
+    const int channel,
+    const int bin) const
+{
+    return histogram[channel * numberOfHistogramBins + bin];
+}
+
+
+/// Create a new segmented analyser.
+///
+/// @param averageAlgorithm algorithm for averaging (see
+///        KmeterPluginParameters)
+///
+/// @param numberOfSegments maximum number of segments (and thus
+///        threads) per file
+///
+SegmentedAnalyser::SegmentedAnalyser(
+    const int averageAlgorithm,
+    const int numberOfSegments) :
+    averageAlgorithm_(averageAlgorithm),
+    numberOfSegments_(jmax(1, numberOfSegments)),
+    useFftTruePeakMeter_(false)
+{
+}
+
+
+/// Select the oversampler of the true peak meter.
+///
+/// @see OfflineAnalyser::setFftTruePeakMeter()
+///
+void SegmentedAnalyser::setFftTruePeakMeter(
+    const bool useFftTruePeakMeter)
+{
+    useFftTruePeakMeter_ = useFftTruePeakMeter;
+}
+
+
+/// Summarise an audio file.  This call blocks until all segments have
+/// been analysed.
+///
+/// @param audioFile audio file to analyse
+///
+/// @param summary receives the summary
+///
+/// @param errorMessage receives a description of what went wrong
+///
+/// @return **true** on success
+///
+bool SegmentedAnalyser::analyseFile(
+    const File &audioFile,
+    Summary &summary,
+    String &errorMessage)
+{
+    AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<AudioFormatReader> reader(
+        formatManager.createReaderFor(audioFile));
+
+    if (reader == nullptr)
+    {
+        errorMessage = "could not open \"" +
+                       audioFile.getFullPathName() + "\"";
+        return false;
+    }
+
+    if ((reader->sampleRate < 44100) || (reader->sampleRate > 192000))
+    {
+        errorMessage = "sample rate of " + String(reader->sampleRate) +
+                       " Hz not supported (\"" +
+                       audioFile.getFullPathName() + "\")";
+        return false;
+    }
+
+    int bufferSize = OfflineAnalyser::kmeterBufferSize;
+    int64 numberOfChunks = (reader->lengthInSamples + bufferSize - 1) /
+                           bufferSize;
+    int64 preRollChunks = (int64) std::ceil(
+                              PRE_ROLL_SECONDS * reader->sampleRate /
+                              bufferSize);
+
+    // segments shorter than their pre-roll do not pay off
+    int numberOfSegments = (int) jlimit(
+                               (int64) 1,
+                               (int64) numberOfSegments_,
+                               numberOfChunks / preRollChunks);
+
+    OwnedArray<Segment> segments;
+
+    for (int index = 0; index < numberOfSegments; ++index)
+    {
+        int64 firstChunk = numberOfChunks * index / numberOfSegments;
+        int64 endChunk = numberOfChunks * (index + 1) / numberOfSegments;
+
+        segments.add(new Segment(audioFile,
+                                 averageAlgorithm_,
+                                 useFftTruePeakMeter_,
+                                 firstChunk,
+                                 endChunk,
+                                 jmin(firstChunk, preRollChunks)));
+    }
+
+    for (auto segment : segments)
+    {
+        segment->startThread();
+    }
+
+    summary.initialise((int) reader->numChannels, reader->sampleRate);
+    bool hasSucceeded = true;
+
+    // merge in order of segments
+    for (auto segment : segments)
+    {
+        segment->waitForThreadToExit(-1);
+
+        if (segment->hasSucceeded)
+        {
+            summary.merge(segment->summary);
+        }
+        else
+        {
+            hasSucceeded = false;
+        }
+    }
+
+    if (!hasSucceeded)
+    {
+        errorMessage = "could not read \"" +
+                       audioFile.getFullPathName() + "\"";
+        return false;
+    }
+
+    summary.analysedSeconds = (double) reader->lengthInSamples /
+                              reader->sampleRate;
+
+    return true;
+}
+
+
+/// Get maximum number of segments per file.
+///
+/// @return number of segments
+///
+int SegmentedAnalyser::getNumberOfSegments() const
+{
+    return numberOfSegments_;
+}
+
+
+/// Format summary as JSON object.  Levels are shown on the scale of
+/// the given K-System meter.
+///
+/// @param audioFile audio file
+///
+/// @param summary summary of audio file
+///
+/// @param crestFactor crest factor of K-System meter (0, 12, 14 or
+///        20)
+///
+/// @return formatted string
+///
+String SegmentedAnalyser::formatSummary(
+    const File &audioFile,
+    const Summary &summary,
+    const int crestFactor)
+{
+    float crestFactorFloat = (float) crestFactor;
+
+    String output = "{\n"
+                    "  \"file\": " +
+                    JSON::toString(audioFile.getFullPathName()) + ",\n"
+                    "  \"channels\": " + String(summary.numberOfChannels) +
+                    ",\n"
+                    "  \"sample_rate\": " +
+                    String(roundToInt(summary.sampleRate)) + ",\n"
+                    "  \"crest_factor\": " + String(crestFactor) + ",\n"
+                    "  \"duration\": " + String(summary.analysedSeconds, 3) +
+                    ",\n"
+                    "  \"readings\": " + String(summary.numberOfReadings) +
+                    ",\n"
+                    "  \"summary\": [";
+
+    for (int channel = 0; channel < summary.numberOfChannels; ++channel)
+    {
+        output += (channel == 0) ? "\n" : ",\n";
+
+        output += "    {\"channel\": " + String(channel + 1) +
+                  ", \"max\": " +
+                  String(crestFactorFloat +
+                         summary.maximumPeakLevels[channel], 2) +
+                  ", \"mxt\": " +
+                  String(crestFactorFloat +
+                         summary.maximumTruePeakLevels[channel], 2) +
+                  ", \"overflows\": " +
+                  String(summary.overflowCounts[channel]) +
+                  ",\n     \"histogram\": [";
+
+        bool isFirstBin = true;
+
+        // list occupied bins only
+        for (int bin = 0; bin < numberOfHistogramBins; ++bin)
+        {
+            int count = summary.getHistogramCount(channel, bin);
+
+            if (count == 0)
+            {
+                continue;
+            }
+
+            output += isFirstBin ? "" : ", ";
+            isFirstBin = false;
+
+            output += "[" + String(roundToInt(crestFactorFloat +
+                                              getHistogramLevel(bin))) +
+                      ", " + String(count) + "]";
+        }
+
+        output += "]}";
+    }
+
+    return output + "\n  ]\n}";
+}
+
+
+/// Check whether two summaries of the same file agree within the
+/// documented tolerance.
+///
+/// @param summary summary to check (usually analysed in segments)
+///
+/// @param reference reference summary (usually analysed in a single
+///        segment)
+///
+/// @param difference receives a description of the first difference
+///
+/// @return **true** if summaries agree
+///
+bool SegmentedAnalyser::compareSummaries(
+    const Summary &summary,
+    const Summary &reference,
+    String &difference)
+{
+    if ((summary.numberOfChannels != reference.numberOfChannels) ||
+            (summary.numberOfReadings != reference.numberOfReadings))
+    {
+        difference = "number of channels or readings differs";
+        return false;
+    }
+
+    for (int channel = 0; channel < summary.numberOfChannels; ++channel)
+    {
+        String channelName = "channel " + String(channel + 1) + ": ";
+
+        if (summary.maximumPeakLevels[channel] !=
+                reference.maximumPeakLevels[channel])
+        {
+            difference = channelName + "maximum peak level differs";
+            return false;
+        }
+
+        if (summary.maximumTruePeakLevels[channel] !=
+                reference.maximumTruePeakLevels[channel])
+        {
+            difference = channelName + "maximum true peak level differs";
+            return false;
+        }
+
+        if (summary.overflowCounts[channel] !=
+                reference.overflowCounts[channel])
+        {
+            difference = channelName + "number of overflows differs";
+            return false;
+        }
+
+        int sumOfDifferences = 0;
+
+        for (int bin = 0; bin < numberOfHistogramBins; ++bin)
+        {
+            sumOfDifferences += std::abs(
+                                    summary.getHistogramCount(channel, bin) -
+                                    reference.getHistogramCount(channel, bin));
+        }
+
+        // every moved reading is counted twice
+        int movedReadings = sumOfDifferences / 2;
+
+        if (movedReadings > HISTOGRAM_TOLERANCE * reference.numberOfReadings)
+        {
+            difference = channelName + String(movedReadings) +
+                         " histogram readings differ";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/// Get level of a histogram bin.
+///
+/// @param bin histogram bin
+///
+/// @return lower edge of bin (in decibels)
+///
+float SegmentedAnalyser::getHistogramLevel(
+    const int bin)
+{
+    return (float)(histogramMinimumDecibel + bin);
+}
+
+
+/// Create a new segment.
+///
+/// @param audioFile audio file to analyse
+///
+/// @param averageAlgorithm algorithm for averaging
+///
+/// @param useFftTruePeakMeter use FFT-based oversampler for true
+///        peak levels
+///
+/// @param firstChunk index of first chunk to summarise
+///
+/// @param endChunk index of chunk following the last chunk to
+///        summarise
+///
+/// @param preRollChunks number of chunks to meter before the first
+///        chunk
+///
+SegmentedAnalyser::Segment::Segment(
+    const File &audioFile,
+    const int averageAlgorithm,
+    const bool useFftTruePeakMeter,
+    const int64 firstChunk,
+    const int64 endChunk,
+    const int64 preRollChunks) :
+    Thread("K-Meter segment"),
+    hasSucceeded(false),
+    audioFile_(audioFile),
+    averageAlgorithm_(averageAlgorithm),
+    useFftTruePeakMeter_(useFftTruePeakMeter),
+    firstChunk_(firstChunk),
+    endChunk_(endChunk),
+    preRollChunks_(preRollChunks)
+{
+}
+
+
+/// Meter pre-roll and segment.
+///
+void SegmentedAnalyser::Segment::run()
+{
+    AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    // readers must not be shared between threads
+    std::unique_ptr<AudioFormatReader> reader(
+        formatManager.createReaderFor(audioFile_));
+
+    if (reader == nullptr)
+    {
+        return;
+    }
+
+    int numberOfChannels = (int) reader->numChannels;
+    int64 numberOfSamples = reader->lengthInSamples;
+    int bufferSize = OfflineAnalyser::kmeterBufferSize;
+
+    auto meterBallistics = std::make_shared<MeterBallistics>(
+                               numberOfChannels,
+                               averageAlgorithm_,
+                               false,
+                               false);
+
+    MeterEngine meterEngine(numberOfChannels,
+                            reader->sampleRate,
+                            bufferSize,
+                            meterBallistics,
+                            averageAlgorithm_,
+                            KmeterPluginParameters::selLowPassFir,
+                            false,
+                            useFftTruePeakMeter_);
+
+    AudioBuffer<float> chunk(numberOfChannels, bufferSize);
+    summary.initialise(numberOfChannels, reader->sampleRate);
+
+    for (int64 chunkIndex = firstChunk_ - preRollChunks_;
+            chunkIndex < endChunk_; ++chunkIndex)
+    {
+        if (threadShouldExit())
+        {
+            return;
+        }
+
+        int64 position = chunkIndex * bufferSize;
+        int samplesToRead = (int) jmin((int64) bufferSize,
+                                       numberOfSamples - position);
+
+        // pad last chunk with silence
+        if (samplesToRead < bufferSize)
+        {
+            chunk.clear();
+        }
+
+        reader->read(&chunk, 0, samplesToRead, position, true, true);
+        meterEngine.processChunk(chunk, false);
+
+        // pre-roll only settles filters and ballistics
+        if (chunkIndex < firstChunk_)
+        {
+            continue;
+        }
+
+        for (int channel = 0; channel < numberOfChannels; ++channel)
+        {
+            summary.addReading(
+                channel,
+                meterEngine.getPeakLevel(channel),
+                meterEngine.getTruePeakLevel(channel),
+                meterEngine.getOverflowCount(channel),
+                meterBallistics->getAverageMeterLevel(channel));
+        }
+
+        ++summary.numberOfReadings;
+    }
+
+    hasSucceeded = true;
+}
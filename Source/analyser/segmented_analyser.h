@@ -0,0 +1,158 @@
+/* ----------------------------------------------------------------------------
+
+   K-Meter
+   =======
+   Implementation of a K-System meter according to Bob Katz' specifications
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+#ifndef KMETER_SEGMENTED_ANALYSER_H
+#define KMETER_SEGMENTED_ANALYSER_H
+
+#include "FrutHeader.h"
+#include "../meter_ballistics.h"
+#include "../meter_engine.h"
+
+
+/// Summarises a single audio file using several cores.  The file is
+/// split into segments which are metered in parallel, each by its own
+/// meter engine.  Every segment starts with a pre-roll that is
+/// metered but not summarised, so that K-weighting filters, FFT
+/// overlap-add state and average meter ballistics have settled when
+/// the segment proper begins.  Segment summaries are then merged.
+///
+/// Compared to a single segment, results differ within this
+/// tolerance:
+///
+/// - maximum peak levels, maximum true peak levels and overflow
+///   counts are identical
+///
+/// - the histograms of average meter readings contain the same number
+///   of readings; rounding differences may move a reading that lies
+///   close to a bin edge to the adjacent bin, but no more than 0.1 %
+///   of all readings may be affected
+///
+/// compareSummaries() enforces this tolerance.  The self-test
+/// ("kmeter_analyse --test") checks it on a synthetic signal.
+///
+class SegmentedAnalyser
+{
+public:
+    /// Summary of a file (or a part thereof).
+    class Summary
+    {
+    public:
+        Summary();
+
+        void initialise(const int numberOfChannelsNew,
+                        const double sampleRateNew);
+
+        void merge(const Summary &other);
+
+        void addReading(const int channel,
+                        const float peakLevel,
+                        const float truePeakLevel,
+                        const int overflowCount,
+                        const float averageMeterLevel);
+
+        int getHistogramCount(const int channel,
+                              const int bin) const;
+
+        int numberOfChannels;
+        double sampleRate;
+        double analysedSeconds;
+
+        /// number of readings per channel
+        int numberOfReadings;
+
+        /// overall maximum levels (in decibels)
+        Array<float> maximumPeakLevels;
+        Array<float> maximumTruePeakLevels;
+
+        Array<int> overflowCounts;
+
+        /// histogram of average meter readings; contains
+        /// numberOfHistogramBins counts per channel
+        Array<int> histogram;
+    };
+
+    SegmentedAnalyser(const int averageAlgorithm,
+                      const int numberOfSegments);
+
+    void setFftTruePeakMeter(const bool useFftTruePeakMeter);
+
+    bool analyseFile(const File &audioFile,
+                     Summary &summary,
+                     String &errorMessage);
+
+    int getNumberOfSegments() const;
+
+    static String formatSummary(const File &audioFile,
+                                const Summary &summary,
+                                const int crestFactor);
+
+    static bool compareSummaries(const Summary &summary,
+                                 const Summary &reference,
+                                 String &difference);
+
+    static float getHistogramLevel(const int bin);
+
+    /// lower edge of first histogram bin (in decibels)
+    static const int histogramMinimumDecibel = -124;
+
+    /// number of histogram bins (1 dB each)
+    static const int numberOfHistogramBins = 130;
+
+protected:
+    /// Meters one segment of an audio file on its own thread.
+    class Segment :
+        public Thread
+    {
+    public:
+        Segment(const File &audioFile,
+                const int averageAlgorithm,
+                const bool useFftTruePeakMeter,
+                const int64 firstChunk,
+                const int64 endChunk,
+                const int64 preRollChunks);
+
+        void run() override;
+
+        bool hasSucceeded;
+        Summary summary;
+
+    private:
+        const File audioFile_;
+        const int averageAlgorithm_;
+        const bool useFftTruePeakMeter_;
+        const int64 firstChunk_;
+        const int64 endChunk_;
+        const int64 preRollChunks_;
+    };
+
+    int averageAlgorithm_;
+    int numberOfSegments_;
+    bool useFftTruePeakMeter_;
+
+private:
+    JUCE_LEAK_DETECTOR(SegmentedAnalyser);
+};
+
+#endif  // KMETER_SEGMENTED_ANALYSER_H
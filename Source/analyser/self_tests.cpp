@@ -0,0 +1,1234 @@
+/* ----------------------------------------------------------------------------
+
+   K-Meter
+   =======
+   Implementation of a K-System meter according to Bob Katz' specifications
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+// Self-tests of the meter engine, the meter worker pool and the
+// offline analyser.  They register themselves with JUCE's unit test
+// framework and are run by "kmeter_analyse --test".
+
+#include "../average_level_filtered.h"
+#include "../k_weighting_filter.h"
+#include "../meter_worker_pool.h"
+#include "segmented_analyser.h"
+
+
+namespace
+{
+
+const char *const TEST_CATEGORY = "K-Meter";
+
+
+// write a signal to a temporary 32-bit float WAV file (which keeps
+// samples above full scale intact)
+bool writeWaveFile(const File &waveFile,
+                   const AudioBuffer<float> &signal,
+                   const double sampleRate)
+{
+    std::unique_ptr<FileOutputStream> outputStream(
+        new FileOutputStream(waveFile));
+
+    if (outputStream->failedToOpen())
+    {
+        return false;
+    }
+
+    WavAudioFormat waveFormat;
+    std::unique_ptr<AudioFormatWriter> writer(
+        waveFormat.createWriterFor(outputStream.get(),
+                                   sampleRate,
+                                   (unsigned int) signal.getNumChannels(),
+                                   32,
+                                   StringPairArray(),
+                                   0));
+
+    if (writer == nullptr)
+    {
+        return false;
+    }
+
+    // writer has taken ownership of stream
+    outputStream.release();
+
+    return writer->writeFromAudioSampleBuffer(
+               signal, 0, signal.getNumSamples());
+}
+
+
+// look for a file in the "validation" directory of the source tree,
+// starting next to the executable and in the current working
+// directory
+File findValidationFile(const String &fileName)
+{
+    File startDirectories[] =
+    {
+        File::getSpecialLocation(File::currentExecutableFile)
+        .getParentDirectory(),
+        File::getCurrentWorkingDirectory()
+    };
+
+    for (File directory : startDirectories)
+    {
+        while (true)
+        {
+            File validationFile = directory.getChildFile("validation")
+                                  .getChildFile(fileName);
+
+            if (validationFile.existsAsFile())
+            {
+                return validationFile;
+            }
+
+            File parentDirectory = directory.getParentDirectory();
+
+            // reached root directory
+            if (parentDirectory == directory)
+            {
+                break;
+            }
+
+            directory = parentDirectory;
+        }
+    }
+
+    return File();
+}
+
+
+// mean square of a channel (in decibels)
+double getMeanSquareDecibel(const AudioBuffer<float> &buffer,
+                            const int channel,
+                            const int numberOfSamples)
+{
+    const float *samples = buffer.getReadPointer(channel);
+    double sumOfSquares = 0.0;
+
+    for (int sample = 0; sample < numberOfSamples; ++sample)
+    {
+        sumOfSquares += (double) samples[sample] * samples[sample];
+    }
+
+    // -200 dB for digital silence
+    return 10.0 * std::log10(sumOfSquares / numberOfSamples + 1e-20);
+}
+
+}
+
+
+/// Checks that summarising a file in segments yields the same results
+/// as summarising it in one piece (within the tolerance documented in
+/// SegmentedAnalyser).
+///
+class SegmentedAnalyserTest :
+    public UnitTest
+{
+public:
+    SegmentedAnalyserTest() :
+        UnitTest("Segmented analyser", TEST_CATEGORY)
+    {
+    }
+
+    void runTest() override
+    {
+        const double sampleRate = 48000.0;
+        const int numberOfSegments = 4;
+
+        TemporaryFile temporaryFile(".wav");
+        const File &waveFile = temporaryFile.getFile();
+
+        beginTest("Write synthetic signal");
+
+        AudioBuffer<float> signal;
+        synthesiseSignal(signal, sampleRate);
+
+        expect(writeWaveFile(waveFile, signal, sampleRate),
+               "could not write \"" + waveFile.getFullPathName() + "\"");
+
+        int algorithms[] =
+        {
+            KmeterPluginParameters::selAlgorithmRms,
+            KmeterPluginParameters::selAlgorithmItuBs1770
+        };
+
+        for (int averageAlgorithm : algorithms)
+        {
+            String algorithmName =
+                (averageAlgorithm == KmeterPluginParameters::selAlgorithmRms) ?
+                "RMS" : "ITU-R";
+
+            beginTest(String(numberOfSegments) + " segments vs. 1 segment (" +
+                      algorithmName + ")");
+
+            SegmentedAnalyser analyser(averageAlgorithm, numberOfSegments);
+            SegmentedAnalyser referenceAnalyser(averageAlgorithm, 1);
+
+            SegmentedAnalyser::Summary summary;
+            SegmentedAnalyser::Summary referenceSummary;
+            String errorMessage;
+
+            expect(analyser.analyseFile(waveFile, summary, errorMessage),
+                   errorMessage);
+            expect(referenceAnalyser.analyseFile(
+                       waveFile, referenceSummary, errorMessage),
+                   errorMessage);
+
+            // make sure that there is something to compare
+            expectEquals(summary.numberOfChannels, 2);
+            expect(summary.numberOfReadings > 0, "no readings");
+            expect(summary.overflowCounts[0] > 0, "no overflows");
+            expect(summary.maximumPeakLevels[0] > 0.0f,
+                   "signal does not exceed full scale");
+
+            String difference;
+
+            expect(SegmentedAnalyser::compareSummaries(
+                       summary, referenceSummary, difference),
+                   difference);
+
+            // the comparison must notice differences, too
+            SegmentedAnalyser::Summary changedSummary = summary;
+
+            changedSummary.maximumTruePeakLevels.set(
+                1, changedSummary.maximumTruePeakLevels[1] + 0.01f);
+
+            expect(!SegmentedAnalyser::compareSummaries(
+                       changedSummary, referenceSummary, difference),
+                   "changed maximum true peak level was not detected");
+
+            changedSummary = summary;
+            moveHistogramReadings(changedSummary, 1);
+
+            expect(!SegmentedAnalyser::compareSummaries(
+                       changedSummary, referenceSummary, difference),
+                   "moved histogram readings were not detected");
+        }
+    }
+
+private:
+    // stereo signal of 40 seconds with level changes every half second
+    // (sine wave on the left, white noise on the right) and a few
+    // samples above full scale
+    void synthesiseSignal(AudioBuffer<float> &signal,
+                          const double sampleRate)
+    {
+        const int numberOfSamples = (int)(40.0 * sampleRate);
+        const int stepLength = (int)(0.5 * sampleRate);
+
+        signal.setSize(2, numberOfSamples);
+
+        // fixed seed, so that the test is reproducible
+        Random random(20200101);
+
+        float *samplesLeft = signal.getWritePointer(0);
+        float *samplesRight = signal.getWritePointer(1);
+
+        float gainLeft = 0.0f;
+        float gainRight = 0.0f;
+
+        for (int sample = 0; sample < numberOfSamples; ++sample)
+        {
+            if ((sample % stepLength) == 0)
+            {
+                // between -70 and -3 dBFS; one step in ten is silent
+                gainLeft = (random.nextInt(10) == 0) ? 0.0f :
+                           Decibels::decibelsToGain(
+                               -70.0f + 67.0f * random.nextFloat());
+                gainRight = Decibels::decibelsToGain(
+                                -70.0f + 67.0f * random.nextFloat());
+            }
+
+            samplesLeft[sample] = gainLeft * (float) std::sin(
+                                      2.0 * M_PI * 997.0 * sample / sampleRate);
+            samplesRight[sample] = gainRight *
+                                   (2.0f * random.nextFloat() - 1.0f);
+        }
+
+        // overflows (one of them in every segment)
+        for (int index = 1; index <= 8; ++index)
+        {
+            int sample = index * numberOfSamples / 9;
+
+            samplesLeft[sample] = (index % 2 == 0) ? 1.0f : -1.25f;
+            samplesRight[sample] = 1.0f;
+        }
+    }
+
+    // move all readings of the fullest histogram bin of a channel to
+    // the adjacent bin
+    void moveHistogramReadings(SegmentedAnalyser::Summary &summary,
+                               const int channel)
+    {
+        int fullestBin = 0;
+
+        for (int bin = 1; bin < SegmentedAnalyser::numberOfHistogramBins; ++bin)
+        {
+            if (summary.getHistogramCount(channel, bin) >
+                    summary.getHistogramCount(channel, fullestBin))
+            {
+                fullestBin = bin;
+            }
+        }
+
+        int adjacentBin = (fullestBin > 0) ? fullestBin - 1 : fullestBin + 1;
+
+        int index = channel * SegmentedAnalyser::numberOfHistogramBins;
+        int readingsToMove = summary.getHistogramCount(channel, fullestBin);
+
+        summary.histogram.set(index + fullestBin, 0);
+        summary.histogram.set(index + adjacentBin,
+                              summary.histogram[index + adjacentBin] +
+                              readingsToMove);
+    }
+};
+
+static SegmentedAnalyserTest segmentedAnalyserTest;
+
+
+
+/// Checks that KWeightingFilter matches the per-channel direct-form
+/// loops it replaced on "validation/pink_noise_bandlimited.flac".
+///
+class KWeightingFilterTest :
+    public UnitTest
+{
+public:
+    KWeightingFilterTest() :
+        UnitTest("K-weighting filter", TEST_CATEGORY)
+    {
+    }
+
+    void runTest() override
+    {
+        // maximum deviation of chunk levels (in decibels)
+        const double tolerance = 0.01;
+        const int chunkSize = 1024;
+
+        beginTest("Old and new filter on band-limited pink noise");
+
+        File audioFile = findValidationFile("pink_noise_bandlimited.flac");
+
+        expect(audioFile.existsAsFile(),
+               "could not find \"validation/pink_noise_bandlimited.flac\"");
+
+        AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        std::unique_ptr<AudioFormatReader> reader(
+            formatManager.createReaderFor(audioFile));
+
+        if (reader == nullptr)
+        {
+            expect(false, "could not read \"" +
+                   audioFile.getFullPathName() + "\"");
+            return;
+        }
+
+        int numberOfChannels = (int) reader->numChannels;
+
+        KWeightingFilter filter(numberOfChannels, reader->sampleRate);
+        ReferenceFilter referenceFilter(numberOfChannels, reader->sampleRate);
+
+        AudioBuffer<float> samples(numberOfChannels, chunkSize);
+        AudioBuffer<float> referenceSamples(numberOfChannels, chunkSize);
+
+        double maximumDeviation = 0.0;
+        double sumOfDeviations = 0.0;
+        int numberOfReadings = 0;
+
+        // skip incomplete last chunk
+        for (int64 position = 0;
+                position + chunkSize <= reader->lengthInSamples;
+                position += chunkSize)
+        {
+            reader->read(&samples, 0, chunkSize, position, true, true);
+            referenceSamples.makeCopyOf(samples);
+
+            filter.processInPlace(samples, chunkSize);
+            referenceFilter.processInPlace(referenceSamples, chunkSize);
+
+            for (int channel = 0; channel < numberOfChannels; ++channel)
+            {
+                double deviation = std::abs(
+                                       getMeanSquareDecibel(
+                                           samples, channel, chunkSize) -
+                                       getMeanSquareDecibel(
+                                           referenceSamples, channel, chunkSize));
+
+                maximumDeviation = jmax(maximumDeviation, deviation);
+                sumOfDeviations += deviation;
+                ++numberOfReadings;
+            }
+        }
+
+        expect(numberOfReadings > 0, "file contains no complete chunk");
+
+        logMessage("K-weighting (" + filter.getImplementationName() +
+                   ") vs. old loops: chunk levels deviate by " +
+                   String(sumOfDeviations / jmax(numberOfReadings, 1), 6) +
+                   " dB on average and " + String(maximumDeviation, 6) +
+                   " dB at most");
+
+        expect(maximumDeviation <= tolerance,
+               "chunk levels deviate by up to " +
+               String(maximumDeviation, 6) + " dB");
+    }
+
+private:
+    // the K-weighting filter as it used to be implemented: both
+    // biquads run as separate direct-form I loops per channel; the
+    // output of every stage is rounded to float, and so is the
+    // filter history that is kept between chunks (the old code also
+    // dithered to 24 bits, which is far below the tolerance and has
+    // been left out to keep the test reproducible)
+    class ReferenceFilter
+    {
+    public:
+        ReferenceFilter(const int numberOfChannels,
+                        const double sampleRate) :
+            history_(numberOfChannels, 2 * numberOfHistorySamples)
+        {
+            history_.clear();
+
+            // pre-filter (ITU-R BS.1770-1)
+            double pf_vh = 1.584864701130855;
+            double pf_vb = sqrt(pf_vh);
+            double pf_vl = 1.0;
+            double pf_q = 0.7071752369554196;
+            double pf_cutoff = 1681.974450955533;
+            double pf_omega = tan(M_PI * pf_cutoff / sampleRate);
+            double pf_omega_2 = pow(pf_omega, 2.0);
+            double pf_omega_q = pf_omega / pf_q;
+            double pf_div = (pf_omega_2 + pf_omega_q + 1.0);
+
+            coefficients_[0][0] = (pf_vl * pf_omega_2 + pf_vb * pf_omega_q + pf_vh) / pf_div;
+            coefficients_[0][1] = 2.0 * (pf_vl * pf_omega_2 - pf_vh) / pf_div;
+            coefficients_[0][2] = (pf_vl * pf_omega_2 - pf_vb * pf_omega_q + pf_vh) / pf_div;
+            coefficients_[0][3] = -2.0 * (pf_omega_2 - 1.0) / pf_div;
+            coefficients_[0][4] = -(pf_omega_2 - pf_omega_q + 1.0) / pf_div;
+
+            // RLB weighting curve (ITU-R BS.1770-1)
+            double rlb_vh = 1.0;
+            double rlb_vb = 0.0;
+            double rlb_vl = 0.0;
+            double rlb_q = 0.5003270373238773;
+            double rlb_cutoff = 38.13547087602444;
+            double rlb_omega = tan(M_PI * rlb_cutoff / sampleRate);
+            double rlb_omega_2 = pow(rlb_omega, 2.0);
+            double rlb_omega_q = rlb_omega / rlb_q;
+            double rlb_div_1 = (rlb_vl * rlb_omega_2 + rlb_vb * rlb_omega_q + rlb_vh);
+            double rlb_div_2 = (rlb_omega_2 + rlb_omega_q + 1.0);
+
+            coefficients_[1][0] = 1.0;
+            coefficients_[1][1] = 2.0 * (rlb_vl * rlb_omega_2 - rlb_vh) / rlb_div_1;
+            coefficients_[1][2] = (rlb_vl * rlb_omega_2 - rlb_vb * rlb_omega_q + rlb_vh) / rlb_div_1;
+            coefficients_[1][3] = -2.0 * (rlb_omega_2 - 1.0) / rlb_div_2;
+            coefficients_[1][4] = -(rlb_omega_2 - rlb_omega_q + 1.0) / rlb_div_2;
+        }
+
+        void processInPlace(AudioBuffer<float> &buffer,
+                            const int numberOfSamples)
+        {
+            HeapBlock<double> output(numberOfSamples);
+
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            {
+                for (int stage = 0; stage < 2; ++stage)
+                {
+                    float *samples = buffer.getWritePointer(channel);
+                    float *history = history_.getWritePointer(
+                                         channel, stage * numberOfHistorySamples);
+                    const double *c = coefficients_[stage];
+
+                    // history: x[n - 2], x[n - 1], y[n - 2], y[n - 1]
+                    double x1 = history[1];
+                    double x2 = history[0];
+                    double y1 = history[3];
+                    double y2 = history[2];
+
+                    for (int sample = 0; sample < numberOfSamples; ++sample)
+                    {
+                        double x0 = samples[sample];
+
+                        output[sample] = c[0] * x0 + c[1] * x1 + c[2] * x2 +
+                                         c[3] * y1 + c[4] * y2;
+
+                        x2 = x1;
+                        x1 = x0;
+                        y2 = y1;
+                        y1 = output[sample];
+                    }
+
+                    history[0] = samples[numberOfSamples - 2];
+                    history[1] = samples[numberOfSamples - 1];
+
+                    for (int sample = 0; sample < numberOfSamples; ++sample)
+                    {
+                        samples[sample] = (float) output[sample];
+                    }
+
+                    history[2] = samples[numberOfSamples - 2];
+                    history[3] = samples[numberOfSamples - 1];
+                }
+            }
+        }
+
+    private:
+        static const int numberOfHistorySamples = 4;
+
+        // b0, b1, b2, -a1, -a2 of pre-filter and weighting curve
+        double coefficients_[2][5];
+
+        AudioBuffer<float> history_;
+    };
+};
+
+static KWeightingFilterTest kWeightingFilterTest;
+
+
+
+/// Checks the half-band decimator against the figures given in the
+/// manual, and that decimation hardly changes the readings of the
+/// average level meter.
+///
+class DecimationTest :
+    public UnitTest
+{
+public:
+    DecimationTest() :
+        UnitTest("Decimation", TEST_CATEGORY)
+    {
+    }
+
+    void runTest() override
+    {
+        // double and quadruple sample rate
+        const double sampleRates[] = {96000.0, 192000.0};
+
+        for (double sampleRate : sampleRates)
+        {
+            beginTest("Half-band filters at " +
+                      String(sampleRate / 1000.0, 0) + " kHz");
+
+            testResponse(sampleRate);
+        }
+
+        int algorithms[] =
+        {
+            KmeterPluginParameters::selAlgorithmRms,
+            KmeterPluginParameters::selAlgorithmItuBs1770
+        };
+
+        for (double sampleRate : sampleRates)
+        {
+            for (int averageAlgorithm : algorithms)
+            {
+                String algorithmName =
+                    (averageAlgorithm == KmeterPluginParameters::selAlgorithmRms) ?
+                    "RMS" : "ITU-R";
+
+                beginTest("Decimated vs. full-rate readings at " +
+                          String(sampleRate / 1000.0, 0) + " kHz (" +
+                          algorithmName + ")");
+
+                testReadings(sampleRate, averageAlgorithm);
+            }
+        }
+    }
+
+private:
+    static int getDecimationFactor(const double sampleRate)
+    {
+        return (sampleRate >= 176400.0) ? 4 : 2;
+    }
+
+    // gain of the decimator for a full-scale sine wave (in decibels)
+    double measureGain(HalfBandDecimator &decimator,
+                       const double sampleRate,
+                       const double frequency)
+    {
+        const int blockSize = 4096;
+        const int numberOfBlocks = 20;
+        const int settlingBlocks = 5;
+
+        int decimationFactor = decimator.getDecimationFactor();
+
+        AudioBuffer<float> input(1, blockSize);
+        AudioBuffer<float> output(1, blockSize / decimationFactor);
+
+        double sumOfSquares = 0.0;
+        int numberOfSamples = 0;
+
+        decimator.reset();
+
+        for (int block = 0; block < numberOfBlocks; ++block)
+        {
+            for (int sample = 0; sample < blockSize; ++sample)
+            {
+                int64 position = (int64) block * blockSize + sample;
+
+                input.setSample(0, sample, (float) std::sin(
+                                    2.0 * M_PI * frequency * position /
+                                    sampleRate));
+            }
+
+            decimator.process(input, output, blockSize);
+
+            if (block < settlingBlocks)
+            {
+                continue;
+            }
+
+            for (int sample = 0; sample < output.getNumSamples(); ++sample)
+            {
+                double value = output.getSample(0, sample);
+
+                sumOfSquares += value * value;
+                ++numberOfSamples;
+            }
+        }
+
+        // the mean square of a full-scale sine wave is 0.5
+        return 10.0 * std::log10(2.0 * sumOfSquares / numberOfSamples +
+                                 1e-30);
+    }
+
+    // pass band must be flat up to 20 kHz, and everything that would
+    // alias below 20 kHz must be attenuated
+    void testResponse(const double sampleRate)
+    {
+        // see section "Average level meter" of the manual
+        const double passBandTolerance = 0.002;
+        const double stopBandAttenuation = 84.0;
+
+        int decimationFactor = getDecimationFactor(sampleRate);
+        double outputSampleRate = sampleRate / decimationFactor;
+
+        HalfBandDecimator decimator(1, sampleRate, decimationFactor, 4096);
+        expectEquals(decimator.getDecimationFactor(), decimationFactor);
+
+        double passBandFrequencies[] =
+        {
+            100.0, 1000.0, 10000.0, 15000.0, 19000.0, 20000.0
+        };
+
+        double maximumDeviation = 0.0;
+
+        for (double frequency : passBandFrequencies)
+        {
+            double gain = measureGain(decimator, sampleRate, frequency);
+            maximumDeviation = jmax(maximumDeviation, std::abs(gain));
+        }
+
+        // aliases of these frequencies fold back below 20 kHz (when
+        // decimating by 4, the second set is folded back by the first
+        // stage)
+        Array<double> stopBandFrequencies;
+
+        stopBandFrequencies.add(outputSampleRate - 20000.0);
+        stopBandFrequencies.add(outputSampleRate - 15000.0);
+        stopBandFrequencies.add(outputSampleRate + 10000.0);
+        stopBandFrequencies.add(sampleRate / 2.0 - 1000.0);
+
+        double minimumAttenuation = 1000.0;
+
+        for (double frequency : stopBandFrequencies)
+        {
+            double gain = measureGain(decimator, sampleRate, frequency);
+            minimumAttenuation = jmin(minimumAttenuation, -gain);
+        }
+
+        logMessage("Decimation by " + String(decimationFactor) +
+                   ": pass band deviates by up to " +
+                   String(maximumDeviation, 4) +
+                   " dB, stop band is attenuated by at least " +
+                   String(minimumAttenuation, 1) + " dB");
+
+        expect(maximumDeviation <= passBandTolerance,
+               "pass band deviates by " + String(maximumDeviation, 4) +
+               " dB");
+        expect(minimumAttenuation >= stopBandAttenuation,
+               "stop band is attenuated by only " +
+               String(minimumAttenuation, 1) + " dB");
+    }
+
+    // meter a logarithmic sine sweep from 100 Hz to 20 kHz with and
+    // without decimation (FIR low-pass filter)
+    void testReadings(const double sampleRate,
+                      const int averageAlgorithm)
+    {
+        // see section "Average level meter" of the manual
+        const double tolerance = 0.04;
+
+        const int numberOfChannels = 2;
+        const int chunkSize = 1024;
+        const int settlingChunks = 8;
+
+        const double sweepLength = 10.0;
+        const double startFrequency = 100.0;
+        const double endFrequency = 20000.0;
+        const float gain = Decibels::decibelsToGain(-4.0f);
+
+        AverageLevelFiltered fullRate(
+            numberOfChannels, sampleRate, chunkSize, averageAlgorithm,
+            KmeterPluginParameters::selLowPassFir, false);
+
+        AverageLevelFiltered decimated(
+            numberOfChannels, sampleRate, chunkSize, averageAlgorithm,
+            KmeterPluginParameters::selLowPassFir, true);
+
+        expectEquals(fullRate.getDecimationFactor(), 1);
+        expectEquals(decimated.getDecimationFactor(),
+                     getDecimationFactor(sampleRate));
+
+        AudioBuffer<float> samples(numberOfChannels, chunkSize);
+
+        int numberOfChunks = (int)(sweepLength * sampleRate) / chunkSize;
+        double sweepRate = std::log(endFrequency / startFrequency) /
+                           sweepLength;
+
+        double sumOfDeviations = 0.0;
+        double maximumDeviation = 0.0;
+        int numberOfReadings = 0;
+
+        for (int chunk = 0; chunk < numberOfChunks; ++chunk)
+        {
+            for (int sample = 0; sample < chunkSize; ++sample)
+            {
+                double time = ((double) chunk * chunkSize + sample) /
+                              sampleRate;
+                double phase = 2.0 * M_PI * startFrequency *
+                               (std::exp(sweepRate * time) - 1.0) / sweepRate;
+
+                float value = gain * (float) std::sin(phase);
+
+                for (int channel = 0; channel < numberOfChannels; ++channel)
+                {
+                    samples.setSample(channel, sample, value);
+                }
+            }
+
+            fullRate.copyFrom(samples, chunkSize);
+            decimated.copyFrom(samples, chunkSize);
+
+            if (chunk < settlingChunks)
+            {
+                continue;
+            }
+
+            double deviation = decimated.getLevel(0) - fullRate.getLevel(0);
+
+            sumOfDeviations += deviation;
+            maximumDeviation = jmax(maximumDeviation, std::abs(deviation));
+            ++numberOfReadings;
+        }
+
+        double meanDeviation = sumOfDeviations / jmax(numberOfReadings, 1);
+
+        logMessage("Decimated readings deviate by " +
+                   String(meanDeviation, 4) + " dB on average and " +
+                   String(maximumDeviation, 4) + " dB at most");
+
+        expect(std::abs(meanDeviation) <= tolerance,
+               "readings deviate by " + String(meanDeviation, 4) +
+               " dB on average");
+    }
+};
+
+static DecimationTest decimationTest;
+
+
+
+/// Checks that ITU-R readings are settled right after switching
+/// from RMS mode, where the K-weighting filter does not run.
+///
+class AlgorithmSwitchTest :
+    public UnitTest
+{
+public:
+    AlgorithmSwitchTest() :
+        UnitTest("Switching averaging algorithms", TEST_CATEGORY)
+    {
+    }
+
+    void runTest() override
+    {
+        beginTest("RMS to ITU-R at 44.1 kHz");
+        testSwitch(44100.0, false);
+
+        beginTest("RMS to ITU-R at 96 kHz (decimated)");
+        testSwitch(96000.0, true);
+    }
+
+private:
+    // meter noise with a strong 40 Hz tone (which the high-pass
+    // stage of the K-weighting filter takes longest to settle on)
+    // in ITU-R mode and with a switch from RMS mode half-way
+    void testSwitch(const double sampleRate,
+                    const bool shouldDecimate)
+    {
+        // maximum deviation of readings (in decibels)
+        const double tolerance = 0.01;
+
+        const int numberOfChannels = 2;
+        const int chunkSize = 1024;
+        const int numberOfChunks = 60;
+        const int switchChunk = 30;
+
+        // the low-pass filter's history crosses over to K-weighted
+        // samples within one kernel length
+        const int crossOverChunks = 2;
+
+        AverageLevelFiltered reference(
+            numberOfChannels, sampleRate, chunkSize,
+            KmeterPluginParameters::selAlgorithmItuBs1770,
+            KmeterPluginParameters::selLowPassFir, shouldDecimate);
+
+        AverageLevelFiltered switched(
+            numberOfChannels, sampleRate, chunkSize,
+            KmeterPluginParameters::selAlgorithmRms,
+            KmeterPluginParameters::selLowPassFir, shouldDecimate);
+
+        AudioBuffer<float> samples(numberOfChannels, chunkSize);
+        Random random(42);
+
+        double maximumDeviation = 0.0;
+
+        for (int chunk = 0; chunk < numberOfChunks; ++chunk)
+        {
+            for (int sample = 0; sample < chunkSize; ++sample)
+            {
+                double time = ((double) chunk * chunkSize + sample) /
+                              sampleRate;
+                float tone = 0.5f * (float) std::sin(2.0 * M_PI * 40.0 * time);
+
+                for (int channel = 0; channel < numberOfChannels; ++channel)
+                {
+                    float noise = 0.1f * (random.nextFloat() - 0.5f);
+                    samples.setSample(channel, sample, tone + noise);
+                }
+            }
+
+            if (chunk == switchChunk)
+            {
+                switched.setAlgorithm(
+                    KmeterPluginParameters::selAlgorithmItuBs1770);
+            }
+
+            reference.copyFrom(samples, chunkSize);
+            switched.copyFrom(samples, chunkSize);
+
+            if (chunk < switchChunk + crossOverChunks)
+            {
+                continue;
+            }
+
+            for (int channel = 0; channel < numberOfChannels; ++channel)
+            {
+                double deviation = std::abs(switched.getLevel(channel) -
+                                            reference.getLevel(channel));
+
+                maximumDeviation = jmax(maximumDeviation, deviation);
+            }
+        }
+
+        logMessage("After switching, readings deviate by up to " +
+                   String(maximumDeviation, 6) + " dB");
+
+        expect(maximumDeviation <= tolerance,
+               "readings deviate by up to " +
+               String(maximumDeviation, 6) + " dB");
+    }
+};
+
+static AlgorithmSwitchTest algorithmSwitchTest;
+
+
+
+/// Checks that convolving all channels with batched FFTW plans gives
+/// the same output as convolving them one by one.  The plans may
+/// pick different code paths, so outputs are compared with a
+/// tolerance instead of bit by bit.
+///
+class BatchedConvolutionTest :
+    public UnitTest
+{
+public:
+    BatchedConvolutionTest() :
+        UnitTest("Batched convolution", TEST_CATEGORY)
+    {
+    }
+
+    void runTest() override
+    {
+        beginTest("Batched vs. per-channel convolution (unpartitioned)");
+        testConvolution(0, 0);
+
+        beginTest("Batched vs. per-channel convolution (partitioned)");
+        testConvolution(AverageLevelFiltered::KMETER_FILTER_PARTITION_SIZE,
+                        AverageLevelFiltered::KMETER_FILTER_KERNEL_LENGTH);
+    }
+
+private:
+    // FIR filter box with access to its sample buffer
+    class TestFilterBox :
+        public frut::dsp::FIRFilterBox
+    {
+    public:
+        TestFilterBox(const int numberOfChannels,
+                      const int fftBufferSize,
+                      const int partitionSize,
+                      const int kernelLength) :
+            FIRFilterBox(numberOfChannels, fftBufferSize,
+                         partitionSize, kernelLength)
+        {
+            calculateKernelWindowedSincLPF(21000.0 / 44100.0);
+        }
+
+        AudioBuffer<float> &getSamples()
+        {
+            return fftSampleBuffer_;
+        }
+    };
+
+    // convolve several chunks of noise, so that the overlap (or the
+    // frequency-domain delay line) is carried over between chunks
+    void testConvolution(const int partitionSize,
+                         const int kernelLength)
+    {
+        // maximum difference of output samples (-100 dBFS, far above
+        // the rounding errors of single-precision FFTs, but far below
+        // anything a meter could show)
+        const float tolerance = 1e-5f;
+
+        // odd number of channels to catch errors in the batch stride
+        const int numberOfChannels = 5;
+        const int chunkSize = 1024;
+        const int numberOfChunks = 8;
+
+        TestFilterBox perChannel(numberOfChannels, chunkSize,
+                                 partitionSize, kernelLength);
+        TestFilterBox batched(numberOfChannels, chunkSize,
+                              partitionSize, kernelLength);
+
+        Random random(42);
+        float maximumDifference = 0.0f;
+
+        for (int chunk = 0; chunk < numberOfChunks; ++chunk)
+        {
+            for (int channel = 0; channel < numberOfChannels; ++channel)
+            {
+                for (int sample = 0; sample < chunkSize; ++sample)
+                {
+                    float value = random.nextFloat() - 0.5f;
+
+                    perChannel.getSamples().setSample(channel, sample, value);
+                    batched.getSamples().setSample(channel, sample, value);
+                }
+            }
+
+            for (int channel = 0; channel < numberOfChannels; ++channel)
+            {
+                perChannel.convolveWithKernel(channel);
+            }
+
+            batched.convolveAllChannelsWithKernel();
+
+            for (int channel = 0; channel < numberOfChannels; ++channel)
+            {
+                const float *expected =
+                    perChannel.getSamples().getReadPointer(channel);
+                const float *actual =
+                    batched.getSamples().getReadPointer(channel);
+
+                for (int sample = 0; sample < chunkSize; ++sample)
+                {
+                    maximumDifference = jmax(
+                                            maximumDifference,
+                                            std::abs(actual[sample] -
+                                                     expected[sample]));
+                }
+            }
+        }
+
+        logMessage("Batched and per-channel output differ by up to " +
+                   String(maximumDifference, 9));
+
+        expect(maximumDifference <= tolerance,
+               "output differs by up to " + String(maximumDifference, 9));
+    }
+};
+
+static BatchedConvolutionTest batchedConvolutionTest;
+
+
+
+/// Stress test of MeterWorkerPool: several threads add and remove
+/// clients while their chunks are still queued.  Checks that a
+/// client is never processed by two workers at once, nor after
+/// removeClient() has returned.  Data races are only reported when
+/// built with ThreadSanitizer ("-fsanitize=thread").
+///
+class MeterWorkerPoolTest :
+    public UnitTest
+{
+public:
+    MeterWorkerPoolTest() :
+        UnitTest("Meter worker pool", TEST_CATEGORY)
+    {
+    }
+
+    void runTest() override
+    {
+        beginTest("Add and remove clients while workers keep running");
+
+        {
+            MeterWorkerPool meterWorkerPool;
+
+            // keeps the workers running
+            TestClient residentClient;
+            residentClient.setRegistered(true);
+            meterWorkerPool.addClient(&residentClient);
+
+            runClientThreads(meterWorkerPool, &residentClient);
+
+            meterWorkerPool.removeClient(&residentClient);
+            residentClient.setRegistered(false);
+
+            checkClient(residentClient, "resident client");
+        }
+
+        beginTest("Add and remove clients while workers start and stop");
+
+        {
+            MeterWorkerPool meterWorkerPool;
+            runClientThreads(meterWorkerPool, nullptr);
+        }
+    }
+
+private:
+    static const int numberOfClientThreads = 4;
+    static const int numberOfRounds = 250;
+    static const int numberOfChunksPerRound = 32;
+
+
+    // client that only counts its chunks; it keeps track of whether
+    // it is registered and being processed, so that violations of
+    // the pool's guarantees can be detected
+    class TestClient :
+        public MeterWorkerPool::Client
+    {
+    public:
+        TestClient() :
+            chunks_(8),
+            isRegistered_(false),
+            isProcessing_(false),
+            numberOfViolations_(0),
+            numberOfProcessedChunks_(0)
+        {
+        }
+
+        bool hasQueuedChunks() override
+        {
+            return !chunks_.isEmpty();
+        }
+
+        void processQueuedChunks() override
+        {
+            if (isProcessing_.exchange(true) || !isRegistered_.load())
+            {
+                ++numberOfViolations_;
+            }
+
+            while (int *chunk = chunks_.getReadSlot())
+            {
+                ignoreUnused(chunk);
+                chunks_.pop();
+
+                ++numberOfProcessedChunks_;
+
+                // widen the window for concurrent processing
+                Thread::yield();
+            }
+
+            isProcessing_ = false;
+        }
+
+        // called by the thread that owns the client (the "audio
+        // thread"); chunks are dropped while the queue is full
+        void queueChunk(const int chunkIndex)
+        {
+            if (int *chunk = chunks_.getWriteSlot())
+            {
+                *chunk = chunkIndex;
+                chunks_.push();
+            }
+        }
+
+        void setRegistered(const bool isRegistered)
+        {
+            isRegistered_ = isRegistered;
+        }
+
+        int getNumberOfViolations() const
+        {
+            return numberOfViolations_;
+        }
+
+        int getNumberOfProcessedChunks() const
+        {
+            return numberOfProcessedChunks_;
+        }
+
+    private:
+        frut::audio::SpscQueue<int> chunks_;
+
+        std::atomic<bool> isRegistered_;
+        std::atomic<bool> isProcessing_;
+
+        std::atomic<int> numberOfViolations_;
+        std::atomic<int> numberOfProcessedChunks_;
+    };
+
+
+    // registers its client, queues chunks (notifying the pool like
+    // an audio thread would) and unregisters the client while chunks
+    // may still be in flight
+    class ClientThread :
+        public Thread
+    {
+    public:
+        ClientThread(MeterWorkerPool &meterWorkerPool,
+                     TestClient *residentClient) :
+            Thread("K-Meter worker pool test"),
+            meterWorkerPool_(meterWorkerPool),
+            residentClient_(residentClient)
+        {
+        }
+
+        void run() override
+        {
+            for (int round = 0; round < numberOfRounds; ++round)
+            {
+                client_.setRegistered(true);
+                meterWorkerPool_.addClient(&client_);
+
+                queueChunks();
+
+                // let the workers catch up in every other round (so
+                // that each client gets processed at least once)
+                if ((round % 2) == 0)
+                {
+                    for (int wait = 0; wait < 100; ++wait)
+                    {
+                        if (!client_.hasQueuedChunks())
+                        {
+                            break;
+                        }
+
+                        Thread::sleep(1);
+                    }
+                }
+
+                // remove client while its chunks are in flight
+                queueChunks();
+                meterWorkerPool_.removeClient(&client_);
+                client_.setRegistered(false);
+            }
+        }
+
+        const TestClient &getClient() const
+        {
+            return client_;
+        }
+
+    private:
+        void queueChunks()
+        {
+            for (int chunk = 0; chunk < numberOfChunksPerRound; ++chunk)
+            {
+                client_.queueChunk(chunk);
+                meterWorkerPool_.notify();
+
+                // only one thread may queue chunks for the resident
+                // client at a time
+                if (residentClient_ != nullptr)
+                {
+                    const ScopedLock lock(residentLock_);
+                    residentClient_->queueChunk(chunk);
+                }
+            }
+        }
+
+
+        static CriticalSection residentLock_;
+
+        MeterWorkerPool &meterWorkerPool_;
+        TestClient *residentClient_;
+        TestClient client_;
+    };
+
+
+    void runClientThreads(MeterWorkerPool &meterWorkerPool,
+                          TestClient *residentClient)
+    {
+        OwnedArray<ClientThread> clientThreads;
+
+        for (int n = 0; n < numberOfClientThreads; ++n)
+        {
+            clientThreads.add(new ClientThread(
+                                  meterWorkerPool, residentClient));
+        }
+
+        for (auto clientThread : clientThreads)
+        {
+            clientThread->startThread();
+        }
+
+        for (auto clientThread : clientThreads)
+        {
+            clientThread->waitForThreadToExit(-1);
+        }
+
+        for (int n = 0; n < numberOfClientThreads; ++n)
+        {
+            checkClient(clientThreads[n]->getClient(),
+                        "client " + String(n + 1));
+        }
+    }
+
+
+    void checkClient(const TestClient &client,
+                     const String &clientName)
+    {
+        expectEquals(client.getNumberOfViolations(), 0,
+                     clientName + " was processed concurrently or "
+                     "after it had been removed");
+
+        expect(client.getNumberOfProcessedChunks() > 0,
+               clientName + " was never processed");
+    }
+};
+
+CriticalSection MeterWorkerPoolTest::ClientThread::residentLock_;
+
+static MeterWorkerPoolTest meterWorkerPoolTest;
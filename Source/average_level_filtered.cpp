@@ -30,24 +30,30 @@ AverageLevelFiltered::AverageLevelFiltered(
     const int numberOfChannels,
     const double sampleRate,
     const int fftBufferSize,
-    const int averageAlgorithm) :
-
-    frut::dsp::FIRFilterBox(numberOfChannels, fftBufferSize),
-    sampleRate_(sampleRate),
-    previousSamplesPreFilterInput_(
-        numberOfChannels_, KMETER_MAXIMUM_FILTER_STAGES - 1),
-    previousSamplesPreFilterOutput_(
-        numberOfChannels_, KMETER_MAXIMUM_FILTER_STAGES - 1),
-    previousSamplesWeightingFilterInput_(
-        numberOfChannels_, KMETER_MAXIMUM_FILTER_STAGES - 1),
-    previousSamplesWeightingFilterOutput_(
-        numberOfChannels_, KMETER_MAXIMUM_FILTER_STAGES - 1),
-    previousSamplesOutputTemp_(1, fftBufferSize_)
+    const int averageAlgorithm,
+    const int lowPassFilter,
+    const bool shouldDecimate) :
+
+    frut::dsp::FIRFilterBox(numberOfChannels,
+                            fftBufferSize / calculateDecimationFactor(
+                                sampleRate, fftBufferSize, shouldDecimate),
+                            KMETER_FILTER_PARTITION_SIZE,
+                            KMETER_FILTER_KERNEL_LENGTH),
+    decimationFactor_(fftBufferSize / fftBufferSize_),
+    sampleRate_(sampleRate / decimationFactor_),
+    decimator_(numberOfChannels_, sampleRate, decimationFactor_,
+               fftBufferSize),
+    kWeightingFilter_(numberOfChannels_, sampleRate_),
+    kWeightedSamples_(numberOfChannels_, fftBufferSize_),
+    numberOfPreRollChunks_(0),
+    nextPreRollChunk_(0),
+    numberOfStoredChunks_(0),
+    lowPassFilter_(lowPassFilter),
+    lowPassSamples_(numberOfChannels_, fftBufferSize_),
+    averageAlgorithm_(-1),
+    activeAlgorithm_(-1)
 {
-    dither_.initialise(numberOfChannels_, 24);
-
     peakToAverageCorrection_ = 0.0f;
-    averageAlgorithm_ = -1;
 
     float meterMinimumDecibel = MeterBallistics::getMeterMinimumDecibel();
 
@@ -56,8 +62,21 @@ AverageLevelFiltered::AverageLevelFiltered(
         loudnessValues_.add(meterMinimumDecibel);
     }
 
-    // also calculates filter kernel
+    // store whole chunks (at the decimated sample rate)
+    int preRollSamples = roundToInt(sampleRate_ *
+                                    KMETER_PRE_ROLL_MILLISECONDS / 1000.0);
+
+    numberOfPreRollChunks_ = (preRollSamples + fftBufferSize_ - 1) /
+                             fftBufferSize_;
+    preRollSamples_.setSize(numberOfChannels_,
+                            numberOfPreRollChunks_ * fftBufferSize_);
+
+    // the low-pass filter is shared by both algorithms, so calculate
+    // it only once
+    calculateFilterKernel();
+
     setAlgorithm(averageAlgorithm);
+    switchAlgorithm(averageAlgorithm_);
 }
 
 
@@ -73,13 +92,16 @@ void AverageLevelFiltered::reset()
     float meterMinimumDecibel = MeterBallistics::getMeterMinimumDecibel();
     loudnessValues_.fill(meterMinimumDecibel);
 
-    previousSamplesPreFilterInput_.clear();
-    previousSamplesPreFilterOutput_.clear();
+    kWeightingFilter_.reset();
+    decimator_.reset();
 
-    previousSamplesWeightingFilterInput_.clear();
-    previousSamplesWeightingFilterOutput_.clear();
+    nextPreRollChunk_ = 0;
+    numberOfStoredChunks_ = 0;
 
-    previousSamplesOutputTemp_.clear();
+    for (int section = 0; section < lowPassSections_.size(); ++section)
+    {
+        lowPassSections_[section]->resetDelays();
+    }
 }
 
 
@@ -89,6 +111,8 @@ int AverageLevelFiltered::getAlgorithm() const
 }
 
 
+// switching algorithms is lock-free and does not touch any filter,
+// so it may be called from any thread (including the audio thread)
 void AverageLevelFiltered::setAlgorithm(
     const int averageAlgorithm)
 {
@@ -110,54 +134,79 @@ void AverageLevelFiltered::setAlgorithm(
     {
         averageAlgorithm_ = KmeterPluginParameters::selAlgorithmItuBs1770;
     }
+}
 
-    calculateFilterKernel();
+
+// the low-pass filter is chosen when the meter is created and
+// cannot be changed later on
+int AverageLevelFiltered::getLowPassFilter() const
+{
+    return lowPassFilter_;
 }
 
 
-void AverageLevelFiltered::calculateFilterKernel()
+int AverageLevelFiltered::getDecimationFactor() const
 {
-    // reset IIR coefficients and previous samples
-    preFilterInputCoefficients_.clear();
-    preFilterOutputCoefficients_.clear();
+    return decimationFactor_;
+}
 
-    weightingFilterInputCoefficients_.clear();
-    weightingFilterOutputCoefficients_.clear();
 
-    for (int stage = 0; stage < KMETER_MAXIMUM_FILTER_STAGES; ++stage)
+// the level of signals that have passed the low-pass filter does not
+// change when the sample rate is reduced, so decimate to the lowest
+// sample rate of at least 44.1 kHz (as long as the decimated chunk
+// is still a multiple of the partition size)
+int AverageLevelFiltered::calculateDecimationFactor(
+    const double sampleRate,
+    const int fftBufferSize,
+    const bool shouldDecimate)
+{
+    int decimationFactor = 1;
+
+    if (!shouldDecimate)
     {
-        preFilterInputCoefficients_.add(0.0);
-        preFilterOutputCoefficients_.add(0.0);
+        return decimationFactor;
+    }
 
-        weightingFilterInputCoefficients_.add(0.0);
-        weightingFilterOutputCoefficients_.add(0.0);
+    while ((decimationFactor < 4) &&
+            (sampleRate / (decimationFactor * 2) >= 44100.0) &&
+            ((fftBufferSize / (decimationFactor * 2)) %
+             KMETER_FILTER_PARTITION_SIZE == 0))
+    {
+        decimationFactor *= 2;
     }
 
-    previousSamplesPreFilterInput_.clear();
-    previousSamplesPreFilterOutput_.clear();
+    return decimationFactor;
+}
 
-    previousSamplesWeightingFilterInput_.clear();
-    previousSamplesWeightingFilterOutput_.clear();
 
-    // make sure there's no overlap yet
-    fftSampleBuffer_.clear();
-    fftOverlapAddSamples_.clear();
+// called at chunk boundaries; RMS mode stores recent chunks, so the
+// K-weighting filter is settled as soon as it is pre-rolled over
+// them (see filterSamples_Rms()), and both algorithms share the
+// low-pass filter, so levels do not drop out (the low-pass filter's
+// history simply crosses over to the new algorithm within one kernel
+// length)
+void AverageLevelFiltered::switchAlgorithm(
+    const int averageAlgorithm)
+{
+    if ((activeAlgorithm_ == KmeterPluginParameters::selAlgorithmRms) &&
+            (averageAlgorithm == KmeterPluginParameters::selAlgorithmItuBs1770))
+    {
+        preRollKWeightingFilter();
+    }
+
+    activeAlgorithm_ = averageAlgorithm;
 
     // set peak-to-average gain correction, the gain to add to average
     // levels so that sine waves read the same on peak and average
     // meters
-    if (averageAlgorithm_ == KmeterPluginParameters::selAlgorithmItuBs1770)
+    if (activeAlgorithm_ == KmeterPluginParameters::selAlgorithmItuBs1770)
     {
-        calculateFilterKernel_ItuBs1770();
-
         // ITU-R BS.1770-1 provides its own peak-to-average gain
         // correction, so we don't need to apply any!
         peakToAverageCorrection_ = 0.0f;
     }
     else
     {
-        calculateFilterKernel_Rms();
-
         // RMS peak-to-average gain correction; this is simply the
         // level difference between the peak and RMS level of a sine
         // wave: RMS / A = sqrt(2) = +3.0103 dB
@@ -166,209 +215,170 @@ void AverageLevelFiltered::calculateFilterKernel()
 }
 
 
-// calculate filter kernel for windowed-sinc low-pass filter (cutoff
-// at 21.0 kHz)
-void AverageLevelFiltered::calculateFilterKernel_Rms()
+// calculate low-pass filter (cutoff at 21.0 kHz)
+void AverageLevelFiltered::calculateFilterKernel()
 {
     double cutoffFrequency = 21000.0;
-    double relativeCutoffFrequency = cutoffFrequency / sampleRate_;
 
-    calculateKernelWindowedSincLPF(relativeCutoffFrequency);
-}
+    if (lowPassFilter_ == KmeterPluginParameters::selLowPassIir)
+    {
+        DBG("[K-Meter] low-pass filter: IIR (Chebyshev)");
 
+        // Chebyshev type I filter with a pass-band ripple of 0.05 dB;
+        // unlike a Butterworth filter of the same order, it does not
+        // droop below 20 kHz at high sample rates
+        double passBandRipple = 0.05;
+        double epsilon = sqrt(pow(10.0, passBandRipple / 10.0) - 1.0);
+        double v = asinh(1.0 / epsilon) / KMETER_LOW_PASS_ORDER;
 
-void AverageLevelFiltered::calculateFilterKernel_ItuBs1770()
-{
-    // filter specifications were taken from Raiden's nice paper
-    // "ITU-R BS.1770-1 filter specifications (unofficial)" as found
-    // on http://www.scribd.com/doc/49991813/ITU-R-BS-1770-1-filters
-    //
-    // please see here for Raiden's original forum thread:
-    // http://www.hydrogenaudio.org/forums/index.php?showtopic=86116
-
-    // initialise pre-filter (ITU-R BS.1770-1)
-    double pf_vh = 1.584864701130855;
-    double pf_vb = sqrt(pf_vh);
-    double pf_vl = 1.0;
-    double pf_q = 0.7071752369554196;
-    double pf_cutoff = 1681.974450955533;
-    double pf_omega = tan(M_PI * pf_cutoff / sampleRate_);
-    double pf_omega_2 = pow(pf_omega, 2.0);
-    double pf_omega_q = pf_omega / pf_q;
-    double pf_div = (pf_omega_2 + pf_omega_q + 1.0);
-
-    preFilterInputCoefficients_.set(0, (pf_vl * pf_omega_2 + pf_vb * pf_omega_q + pf_vh) / pf_div);
-    preFilterInputCoefficients_.set(1, 2.0 * (pf_vl * pf_omega_2 - pf_vh) / pf_div);
-    preFilterInputCoefficients_.set(2, (pf_vl * pf_omega_2 - pf_vb * pf_omega_q + pf_vh) / pf_div);
-
-    preFilterOutputCoefficients_.set(0, -1.0);
-    preFilterOutputCoefficients_.set(1, -2.0 * (pf_omega_2 - 1.0) / pf_div);
-    preFilterOutputCoefficients_.set(2, -(pf_omega_2 - pf_omega_q + 1.0) / pf_div);
-
-    // initialise RLB weighting curve (ITU-R BS.1770-1)
-    double rlb_vh = 1.0;
-    double rlb_vb = 0.0;
-    double rlb_vl = 0.0;
-    double rlb_q = 0.5003270373238773;
-    double rlb_cutoff = 38.13547087602444;
-    double rlb_omega = tan(M_PI * rlb_cutoff / sampleRate_);
-    double rlb_omega_2 = pow(rlb_omega, 2.0);
-    double rlb_omega_q = rlb_omega / rlb_q;
-    double rlb_div_1 = (rlb_vl * rlb_omega_2 + rlb_vb * rlb_omega_q + rlb_vh);
-    double rlb_div_2 = (rlb_omega_2 + rlb_omega_q + 1.0);
-
-    weightingFilterInputCoefficients_.set(0, 1.0);
-    weightingFilterInputCoefficients_.set(1, 2.0 * (rlb_vl * rlb_omega_2 - rlb_vh) / rlb_div_1);
-    weightingFilterInputCoefficients_.set(2, (rlb_vl * rlb_omega_2 - rlb_vb * rlb_omega_q + rlb_vh) / rlb_div_1);
-
-    weightingFilterOutputCoefficients_.set(0, -1.0);
-    weightingFilterOutputCoefficients_.set(1, -2.0 * (rlb_omega_2 - 1.0) / rlb_div_2);
-    weightingFilterOutputCoefficients_.set(2, -(rlb_omega_2 - rlb_omega_q + 1.0) / rlb_div_2);
-
-    calculateFilterKernel_Rms();
-}
+        // pre-warp cutoff for the bilinear transform
+        double warpedCutoff = tan(M_PI * cutoffFrequency / sampleRate_);
 
+        // realise each pair of complex conjugate poles as a
+        // second-order section with unity gain at DC
+        for (int section = 0; section < KMETER_LOW_PASS_ORDER / 2; ++section)
+        {
+            double theta = M_PI * (2 * section + 1) /
+                           (2.0 * KMETER_LOW_PASS_ORDER);
 
-// apply windowed-sinc low-pass filter (cutoff at 21.0 kHz) to samples
-void AverageLevelFiltered::filterSamples_Rms(
-    const int channel)
-{
-    convolveWithKernel(channel);
+            double poleReal = -sinh(v) * sin(theta);
+            double poleImaginary = cosh(v) * cos(theta);
+            double poleRadius = sqrt(poleReal * poleReal +
+                                     poleImaginary * poleImaginary);
+
+            double qualityFactor = poleRadius / (-2.0 * poleReal);
+            double sectionFrequency = sampleRate_ / M_PI *
+                                      atan(poleRadius * warpedCutoff);
+
+            auto lowPassSection = new frut::dsp::IirFilterBox(
+                numberOfChannels_, sampleRate_);
+
+            lowPassSection->passFilterSecondOrder(
+                sectionFrequency, qualityFactor, true);
+
+            lowPassSections_.add(lowPassSection);
+        }
+    }
+    else if (lowPassFilter_ == KmeterPluginParameters::selLowPassNone)
+    {
+        DBG("[K-Meter] low-pass filter: none");
+    }
+    else
+    {
+        DBG("[K-Meter] low-pass filter: FIR (windowed sinc)");
+
+        lowPassFilter_ = KmeterPluginParameters::selLowPassFir;
+
+        double relativeCutoffFrequency = cutoffFrequency / sampleRate_;
+        calculateKernelWindowedSincLPF(relativeCutoffFrequency);
+    }
 }
 
 
-void AverageLevelFiltered::filterSamples_ItuBs1770()
+// apply low-pass filter (cutoff at 21.0 kHz) to samples
+void AverageLevelFiltered::filterSamples_Rms()
 {
+    // store samples, so that switching to ITU-R BS.1770-1 needs no
+    // settling time (copying is far cheaper than keeping the
+    // K-weighting filter running)
+    int startSample = nextPreRollChunk_ * fftBufferSize_;
+
     for (int channel = 0; channel < numberOfChannels_; ++channel)
     {
-        // pre-filter
-        previousSamplesOutputTemp_.clear();
-        const float *samplesInput = fftSampleBuffer_.getReadPointer(channel);
+        preRollSamples_.copyFrom(channel, startSample,
+                                 fftSampleBuffer_,
+                                 channel, 0,
+                                 fftBufferSize_);
+    }
 
-        // temporary buffer with only one channel
-        float *samplesOutput = previousSamplesOutputTemp_.getWritePointer(0);
+    nextPreRollChunk_ = (nextPreRollChunk_ + 1) % numberOfPreRollChunks_;
+    numberOfStoredChunks_ = jmin(numberOfStoredChunks_ + 1,
+                                 numberOfPreRollChunks_);
 
-        const float *samplesInputOld_1 = previousSamplesPreFilterInput_.getReadPointer(channel);
-        const float *samplesOutputOld_1 = previousSamplesPreFilterOutput_.getReadPointer(channel);
+    filterSamples_LowPass();
+}
 
-        for (int sample = 0; sample < fftBufferSize_; ++sample)
-        {
-            double outputSum;
 
-            if (sample < 2)
-            {
-                if (sample == 0)
-                {
-                    outputSum =
-                        preFilterInputCoefficients_[0] * samplesInput[sample] +
-                        preFilterInputCoefficients_[1] * samplesInputOld_1[1] +
-                        preFilterInputCoefficients_[2] * samplesInputOld_1[0] +
-                        preFilterOutputCoefficients_[1] * samplesOutputOld_1[1] +
-                        preFilterOutputCoefficients_[2] * samplesOutputOld_1[0];
-                }
-                else
-                {
-                    outputSum =
-                        preFilterInputCoefficients_[0] * samplesInput[sample] +
-                        preFilterInputCoefficients_[1] * samplesInput[sample - 1] +
-                        preFilterInputCoefficients_[2] * samplesInputOld_1[1] +
-                        preFilterOutputCoefficients_[1] * samplesOutput[sample - 1] +
-                        preFilterOutputCoefficients_[2] * samplesOutputOld_1[1];
-                }
-            }
-            else
-            {
-                outputSum =
-                    preFilterInputCoefficients_[0] * samplesInput[sample] +
-                    preFilterInputCoefficients_[1] * samplesInput[sample - 1] +
-                    preFilterInputCoefficients_[2] * samplesInput[sample - 2] +
-                    preFilterOutputCoefficients_[1] * samplesOutput[sample - 1] +
-                    preFilterOutputCoefficients_[2] * samplesOutput[sample - 2];
-            }
+// run the K-weighting filter over the chunks stored in RMS mode
+// (oldest first); older samples have decayed in its state anyway, so
+// it ends up where it would be had it been running all along
+void AverageLevelFiltered::preRollKWeightingFilter()
+{
+    kWeightingFilter_.reset();
 
-            // dither output to float
-            samplesOutput[sample] = dither_.ditherSample(channel, outputSum);
+    int preRollChunk = (nextPreRollChunk_ - numberOfStoredChunks_ +
+                        numberOfPreRollChunks_) % numberOfPreRollChunks_;
 
-            // avoid underflows (1e-20f corresponds to -400 dBFS)
-            if (fabs(samplesOutput[sample]) < 1e-20f)
-            {
-                samplesOutput[sample] = 0.0f;
-            }
+    for (int chunk = 0; chunk < numberOfStoredChunks_; ++chunk)
+    {
+        int startSample = preRollChunk * fftBufferSize_;
+
+        for (int channel = 0; channel < numberOfChannels_; ++channel)
+        {
+            kWeightedSamples_.copyFrom(channel, 0,
+                                       preRollSamples_,
+                                       channel, startSample,
+                                       fftBufferSize_);
         }
 
-        previousSamplesPreFilterInput_.copyFrom(
-            channel, 0, fftSampleBuffer_,
-            channel, fftBufferSize_ - 2, 2);
+        kWeightingFilter_.processInPlace(kWeightedSamples_, fftBufferSize_);
+        preRollChunk = (preRollChunk + 1) % numberOfPreRollChunks_;
+    }
 
-        previousSamplesPreFilterOutput_.copyFrom(
-            channel, 0, previousSamplesOutputTemp_,
-            0, fftBufferSize_ - 2, 2);
+    nextPreRollChunk_ = 0;
+    numberOfStoredChunks_ = 0;
+}
 
-        fftSampleBuffer_.copyFrom(
-            channel, 0, previousSamplesOutputTemp_,
-            0, 0, fftBufferSize_);
 
-        // RLB weighting filter
-        previousSamplesOutputTemp_.clear();
+void AverageLevelFiltered::filterSamples_ItuBs1770()
+{
+    // apply K-weighting filter to all channels
+    kWeightingFilter_.processInPlace(fftSampleBuffer_, fftBufferSize_);
 
-        // clearing the buffer invalidates the pointers to its sample
-        // data, so we need to update the pointers
-        samplesOutput = previousSamplesOutputTemp_.getWritePointer(0);
+    // apply low-pass filter to all channels
+    filterSamples_LowPass();
+}
 
-        const float *samplesInputOld_2 = previousSamplesWeightingFilterInput_.getReadPointer(channel);
-        const float *samplesOutputOld_2 = previousSamplesWeightingFilterOutput_.getReadPointer(channel);
 
-        for (int sample = 0; sample < fftBufferSize_; ++sample)
+// the FIR filter runs an FFT and an inverse FFT per channel and
+// partition; the IIR filter needs five multiplications and four
+// additions per sample and section and has no latency, but its
+// phase response is not linear and it attenuates less above the
+// cutoff
+void AverageLevelFiltered::filterSamples_LowPass()
+{
+    if (lowPassFilter_ == KmeterPluginParameters::selLowPassFir)
+    {
+        convolveAllChannelsWithKernel();
+    }
+    else if (lowPassFilter_ == KmeterPluginParameters::selLowPassIir)
+    {
+        for (int channel = 0; channel < numberOfChannels_; ++channel)
         {
-            double outputSum;
+            const float *source = fftSampleBuffer_.getReadPointer(channel);
+            double *destination = lowPassSamples_.getWritePointer(channel);
 
-            if (sample < 2)
-            {
-                if (sample == 0)
-                {
-                    outputSum =
-                        weightingFilterInputCoefficients_[0] * samplesInput[sample] +
-                        weightingFilterInputCoefficients_[1] * samplesInputOld_2[1] +
-                        weightingFilterInputCoefficients_[2] * samplesInputOld_2[0] +
-                        weightingFilterOutputCoefficients_[1] * samplesOutputOld_2[1] +
-                        weightingFilterOutputCoefficients_[2] * samplesOutputOld_2[0];
-                }
-                else
-                {
-                    outputSum =
-                        weightingFilterInputCoefficients_[0] * samplesInput[sample] +
-                        weightingFilterInputCoefficients_[1] * samplesInput[sample - 1] +
-                        weightingFilterInputCoefficients_[2] * samplesInputOld_2[1] +
-                        weightingFilterOutputCoefficients_[1] * samplesOutput[sample - 1] +
-                        weightingFilterOutputCoefficients_[2] * samplesOutputOld_2[1];
-                }
-            }
-            else
+            for (int n = 0; n < fftBufferSize_; ++n)
             {
-                outputSum =
-                    weightingFilterInputCoefficients_[0] * samplesInput[sample] +
-                    weightingFilterInputCoefficients_[1] * samplesInput[sample - 1] +
-                    weightingFilterInputCoefficients_[2] * samplesInput[sample - 2] +
-                    weightingFilterOutputCoefficients_[1] * samplesOutput[sample - 1] +
-                    weightingFilterOutputCoefficients_[2] * samplesOutput[sample - 2];
+                destination[n] = source[n];
             }
+        }
+
+        for (int section = 0; section < lowPassSections_.size(); ++section)
+        {
+            lowPassSections_[section]->processInPlace(lowPassSamples_);
+        }
 
-            // dither output to float
-            samplesOutput[sample] = dither_.ditherSample(channel, outputSum);
+        for (int channel = 0; channel < numberOfChannels_; ++channel)
+        {
+            const double *source = lowPassSamples_.getReadPointer(channel);
+            float *destination = fftSampleBuffer_.getWritePointer(channel);
 
-            // avoid underflows (1e-20f corresponds to -400 dBFS)
-            if (fabs(samplesOutput[sample]) < 1e-20f)
+            for (int n = 0; n < fftBufferSize_; ++n)
             {
-                samplesOutput[sample] = 0.0f;
+                destination[n] = static_cast<float>(source[n]);
             }
         }
-
-        previousSamplesWeightingFilterInput_.copyFrom(channel, 0, fftSampleBuffer_, channel, fftBufferSize_ - 2, 2);
-        previousSamplesWeightingFilterOutput_.copyFrom(channel, 0, previousSamplesOutputTemp_, 0, fftBufferSize_ - 2, 2);
-
-        fftSampleBuffer_.copyFrom(channel, 0, previousSamplesOutputTemp_, 0, 0, fftBufferSize_);
-
-        convolveWithKernel(channel);
     }
 }
 
@@ -389,7 +399,7 @@ void AverageLevelFiltered::copyTo(
 {
     jassert(fftSampleBuffer_.getNumChannels() ==
             destination.getNumChannels());
-    jassert(fftSampleBuffer_.getNumSamples() >=
+    jassert(fftSampleBuffer_.getNumSamples() * decimationFactor_ >=
             numberOfSamples);
     jassert(destination.getNumSamples() >=
             numberOfSamples);
@@ -397,12 +407,29 @@ void AverageLevelFiltered::copyTo(
     int numberOfChannels = fftSampleBuffer_.getNumChannels();
 
     // copy data to external buffer
-    for (int channel = 0; channel < numberOfChannels; ++channel)
+    if (decimationFactor_ == 1)
     {
-        destination.copyFrom(channel, 0,
-                             fftSampleBuffer_,
-                             channel, 0,
-                             numberOfSamples);
+        for (int channel = 0; channel < numberOfChannels; ++channel)
+        {
+            destination.copyFrom(channel, 0,
+                                 fftSampleBuffer_,
+                                 channel, 0,
+                                 numberOfSamples);
+        }
+    }
+    // repeat decimated samples (good enough to listen to the filter)
+    else
+    {
+        for (int channel = 0; channel < numberOfChannels; ++channel)
+        {
+            const float *source = fftSampleBuffer_.getReadPointer(channel);
+            float *samples = destination.getWritePointer(channel);
+
+            for (int n = 0; n < numberOfSamples; ++n)
+            {
+                samples[n] = source[n / decimationFactor_];
+            }
+        }
     }
 }
 
@@ -414,19 +441,11 @@ void AverageLevelFiltered::copyFrom(
 {
     jassert(fftSampleBuffer_.getNumChannels() ==
             source.getNumChannels());
-    jassert(fftSampleBuffer_.getNumSamples() ==
+    jassert(fftSampleBuffer_.getNumSamples() * decimationFactor_ ==
             numberOfSamples);
 
-    int numberOfChannels = fftSampleBuffer_.getNumChannels();
-
-    // copy data to internal buffer
-    for (int channel = 0; channel < numberOfChannels; ++channel)
-    {
-        fftSampleBuffer_.copyFrom(channel, 0,
-                                  source,
-                                  channel, 0,
-                                  numberOfSamples);
-    }
+    // copy data to internal buffer (at the decimated sample rate)
+    decimator_.process(source, fftSampleBuffer_, numberOfSamples);
 
     // calculate loudness for all channels
     calculateLoudness();
@@ -437,7 +456,14 @@ void AverageLevelFiltered::calculateLoudness()
 {
     float meterMinimumDecibel = MeterBallistics::getMeterMinimumDecibel();
 
-    if (averageAlgorithm_ == KmeterPluginParameters::selAlgorithmItuBs1770)
+    int averageAlgorithm = averageAlgorithm_;
+
+    if (averageAlgorithm != activeAlgorithm_)
+    {
+        switchAlgorithm(averageAlgorithm);
+    }
+
+    if (activeAlgorithm_ == KmeterPluginParameters::selAlgorithmItuBs1770)
     {
         // filter audio data (overwrites contents of sample buffer)
         filterSamples_ItuBs1770();
@@ -498,11 +524,11 @@ void AverageLevelFiltered::calculateLoudness()
     }
     else
     {
+        // filter audio data (overwrites contents of sample buffer)
+        filterSamples_Rms();
+
         for (int channel = 0; channel < numberOfChannels_; ++channel)
         {
-            // filter audio data (overwrites contents of sample buffer)
-            filterSamples_Rms(channel);
-
             float averageLevel = MeterBallistics::level2decibel(
                                      fftSampleBuffer_.getRMSLevel(
                                          channel, 0, fftBufferSize_));
@@ -27,6 +27,8 @@
 #define KMETER_AVERAGE_LEVEL_FILTERED_H
 
 #include "FrutHeader.h"
+#include "half_band_decimator.h"
+#include "k_weighting_filter.h"
 #include "meter_ballistics.h"
 
 
@@ -34,12 +36,26 @@ class AverageLevelFiltered :
     public frut::dsp::FIRFilterBox
 {
 public:
-    static const int KMETER_MAXIMUM_FILTER_STAGES = 3;
+    // the low-pass filter is convolved in partitions so that its
+    // length does not depend on the block size (which must be a
+    // multiple of the partition size)
+    static const int KMETER_FILTER_PARTITION_SIZE = 128;
+    static const int KMETER_FILTER_KERNEL_LENGTH = 1025;
+
+    // order of the IIR low-pass filter (two poles per section)
+    static const int KMETER_LOW_PASS_ORDER = 6;
+
+    // audio kept in RMS mode for pre-rolling the K-weighting filter
+    // (its 38 Hz high-pass stage decays by more than 150 dB within
+    // this time)
+    static const int KMETER_PRE_ROLL_MILLISECONDS = 100;
 
     AverageLevelFiltered(const int numberOfChannels,
                          const double sampleRate,
                          const int fftBufferSize,
-                         const int averageAlgorithm);
+                         const int averageAlgorithm,
+                         const int lowPassFilter,
+                         const bool shouldDecimate);
 
     virtual ~AverageLevelFiltered();
     virtual void reset();
@@ -47,6 +63,13 @@ public:
     int getAlgorithm() const;
     void setAlgorithm(const int averageAlgorithm);
 
+    int getLowPassFilter() const;
+    int getDecimationFactor() const;
+
+    static int calculateDecimationFactor(const double sampleRate,
+                                         const int fftBufferSize,
+                                         const bool shouldDecimate);
+
     float getLevel(const int channel);
 
     void copyTo(AudioBuffer<float> &destination,
@@ -59,34 +82,43 @@ private:
     JUCE_LEAK_DETECTOR(AverageLevelFiltered);
 
     void calculateFilterKernel();
-    void calculateFilterKernel_Rms();
-    void calculateFilterKernel_ItuBs1770();
+    void switchAlgorithm(const int averageAlgorithm);
 
     void calculateLoudness();
-    void filterSamples_Rms(const int channel);
+    void filterSamples_Rms();
+    void preRollKWeightingFilter();
     void filterSamples_ItuBs1770();
+    void filterSamples_LowPass();
 
+    // all filters run at the decimated sample rate
+    int decimationFactor_;
     double sampleRate_;
 
-    Array<float> loudnessValues_;
-
-    Array<double> preFilterInputCoefficients_;
-    Array<double> preFilterOutputCoefficients_;
+    HalfBandDecimator decimator_;
 
-    Array<double> weightingFilterInputCoefficients_;
-    Array<double> weightingFilterOutputCoefficients_;
+    Array<float> loudnessValues_;
 
-    AudioBuffer<float> previousSamplesPreFilterInput_;
-    AudioBuffer<float> previousSamplesPreFilterOutput_;
+    KWeightingFilter kWeightingFilter_;
+    AudioBuffer<float> kWeightedSamples_;
 
-    AudioBuffer<float> previousSamplesWeightingFilterInput_;
-    AudioBuffer<float> previousSamplesWeightingFilterOutput_;
+    // recent chunks (before K-weighting) stored in RMS mode; the
+    // K-weighting filter only runs over them when switching to
+    // ITU-R BS.1770-1
+    AudioBuffer<float> preRollSamples_;
+    int numberOfPreRollChunks_;
+    int nextPreRollChunk_;
+    int numberOfStoredChunks_;
 
-    AudioBuffer<float> previousSamplesOutputTemp_;
+    int lowPassFilter_;
+    OwnedArray<frut::dsp::IirFilterBox> lowPassSections_;
+    AudioBuffer<double> lowPassSamples_;
 
-    frut::dsp::Dither dither_;
+    // algorithm requested by setAlgorithm(), which may be called
+    // from any thread; the filters switch to it at the start of the
+    // next chunk
+    std::atomic<int> averageAlgorithm_;
+    int activeAlgorithm_;
 
-    int averageAlgorithm_;
     float peakToAverageCorrection_;
 };
 
@@ -28,8 +28,11 @@
 
 
 // normal includes
+#include "../audio/allocation_guard.h"
 #include "../audio/buffer_position.h"
 #include "../audio/ring_buffer.h"
+#include "../audio/spsc_queue.h"
+#include "../audio/triple_buffer.h"
 
 
 #endif  // FRUT_AMALGAMATED_AUDIO_H
@@ -30,14 +30,18 @@
 #include "../FrutHeader.h"
 
 #include "../dsp/biquad_filter.cpp"
+#include "../dsp/complex_vector_operations.cpp"
 #include "../dsp/dither.cpp"
+#include "../dsp/fftw_planner.cpp"
 #include "../dsp/fftw_runner.cpp"
 #include "../dsp/filter_chebyshev.cpp"
 #include "../dsp/filter_chebyshev_stage.cpp"
 #include "../dsp/fir_filter_box.cpp"
 #include "../dsp/iir_filter_box.cpp"
+#include "../dsp/kernel_spectrum_cache.cpp"
 #include "../dsp/rate_converter.cpp"
 #include "../dsp/true_peak_meter.cpp"
+#include "../dsp/true_peak_meter_polyphase.cpp"
 
 
 #endif  // FRUT_AMALGAMATED_DSP_CPP
@@ -37,13 +37,17 @@
 
 // normal includes
 #include "../dsp/biquad_filter.h"
+#include "../dsp/complex_vector_operations.h"
 #include "../dsp/dither.h"
+#include "../dsp/fftw_planner.h"
+#include "../dsp/kernel_spectrum_cache.h"
 #include "../dsp/fftw_runner.h"
 #include "../dsp/filter_chebyshev_stage.h"
 #include "../dsp/fir_filter_box.h"
 #include "../dsp/iir_filter_box.h"
 #include "../dsp/rate_converter.h"
 #include "../dsp/true_peak_meter.h"
+#include "../dsp/true_peak_meter_polyphase.h"
 
 // post includes
 #include "../dsp/filter_chebyshev.h"
@@ -31,6 +31,7 @@
 
 #include "../widgets/channel_slider.cpp"
 #include "../widgets/meter_bar.cpp"
+#include "../widgets/meter_renderer.cpp"
 #include "../widgets/meter_segment.cpp"
 #include "../widgets/meter_segment_continuous.cpp"
 #include "../widgets/meter_segment_discrete.cpp"
@@ -51,6 +51,7 @@
 
 // post includes
 #include "../widgets/meter_bar.h"
+#include "../widgets/meter_renderer.h"
 
 
 #endif  // FRUT_AMALGAMATED_WIDGETS_H
@@ -0,0 +1,231 @@
+/* ----------------------------------------------------------------------------
+
+   FrutJUCE
+   ========
+   Common classes for use with the JUCE library
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+#if FRUT_USE_CRT_ALLOCATION_HOOK
+#include <crtdbg.h>
+#endif
+
+
+namespace frut
+{
+namespace audio
+{
+
+#ifdef DEBUG
+
+thread_local int ScopedAllocationGuard::guardCount_ = 0;
+
+
+ScopedAllocationGuard::ScopedAllocationGuard()
+{
+    ++guardCount_;
+}
+
+
+ScopedAllocationGuard::~ScopedAllocationGuard()
+{
+    --guardCount_;
+}
+
+
+/// Check whether heap allocations are currently forbidden on this
+/// thread.
+///
+/// @return true if a guard is active on the current thread
+///
+bool ScopedAllocationGuard::isActive()
+{
+    return guardCount_ > 0;
+}
+
+
+ScopedAllocationGuard::Exemption::Exemption() :
+    savedGuardCount_(guardCount_)
+{
+    guardCount_ = 0;
+}
+
+
+ScopedAllocationGuard::Exemption::~Exemption()
+{
+    guardCount_ = savedGuardCount_;
+}
+
+#else
+
+ScopedAllocationGuard::ScopedAllocationGuard()
+{
+}
+
+
+ScopedAllocationGuard::~ScopedAllocationGuard()
+{
+}
+
+
+bool ScopedAllocationGuard::isActive()
+{
+    return false;
+}
+
+
+ScopedAllocationGuard::Exemption::Exemption() :
+    savedGuardCount_(0)
+{
+}
+
+
+ScopedAllocationGuard::Exemption::~Exemption()
+{
+}
+
+#endif  // DEBUG
+
+}
+}
+
+
+#if FRUT_REPLACE_GLOBAL_NEW
+
+// replace the global "new" operators to detect heap allocations while
+// a guard is active; as memory is now taken from malloc(), the global
+// "delete" operators must be replaced as well to hand it back to
+// free() -- all of these operators apply to the whole process
+void *operator new(std::size_t size)
+{
+    if (frut::audio::ScopedAllocationGuard::isActive())
+    {
+        // the assertion may allocate as well
+        frut::audio::ScopedAllocationGuard::Exemption allowAllocation;
+
+        // heap allocation on a guarded (i.e. real-time) thread
+        jassertfalse;
+    }
+
+    void *memory = std::malloc(size > 0 ? size : 1);
+
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    return memory;
+}
+
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+
+void operator delete[](void *memory) noexcept
+{
+    std::free(memory);
+}
+
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+
+void operator delete[](void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+#endif  // FRUT_REPLACE_GLOBAL_NEW
+
+
+#if FRUT_USE_CRT_ALLOCATION_HOOK
+
+namespace
+{
+
+_CRT_ALLOC_HOOK previousAllocationHook = nullptr;
+
+
+// called by the debug CRT on every heap operation of the modules
+// that use it; unlike replacing the global "new" operator, this does
+// not change how memory is allocated
+int detectAllocation(
+    int allocationType,
+    void *userData,
+    size_t size,
+    int blockType,
+    long requestNumber,
+    const unsigned char *fileName,
+    int lineNumber)
+{
+    if ((allocationType != _HOOK_FREE) &&
+            (blockType != _CRT_BLOCK) &&
+            frut::audio::ScopedAllocationGuard::isActive())
+    {
+        // the assertion may allocate as well
+        frut::audio::ScopedAllocationGuard::Exemption allowAllocation;
+
+        // heap allocation on a guarded (i.e. real-time) thread
+        jassertfalse;
+    }
+
+    if (previousAllocationHook != nullptr)
+    {
+        return previousAllocationHook(allocationType, userData, size,
+                                      blockType, requestNumber,
+                                      fileName, lineNumber);
+    }
+
+    return TRUE;
+}
+
+
+// installs the hook while this module is loaded
+class AllocationHookInstaller
+{
+public:
+    AllocationHookInstaller()
+    {
+        previousAllocationHook = _CrtSetAllocHook(detectAllocation);
+    }
+
+    ~AllocationHookInstaller()
+    {
+        _CrtSetAllocHook(previousAllocationHook);
+    }
+};
+
+AllocationHookInstaller allocationHookInstaller;
+
+}
+
+#endif  // FRUT_USE_CRT_ALLOCATION_HOOK
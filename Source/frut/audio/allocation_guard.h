@@ -0,0 +1,112 @@
+/* ----------------------------------------------------------------------------
+
+   FrutJUCE
+   ========
+   Common classes for use with the JUCE library
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+#ifndef FRUT_AUDIO_ALLOCATION_GUARD_H
+#define FRUT_AUDIO_ALLOCATION_GUARD_H
+
+// replace the global "new" and "delete" operators (see
+// ScopedAllocationGuard); define as 0 or 1 to override the default
+#ifndef FRUT_REPLACE_GLOBAL_NEW
+#if defined(DEBUG) && defined(JucePlugin_Build_Standalone) && JucePlugin_Build_Standalone
+#define FRUT_REPLACE_GLOBAL_NEW 1
+#else
+#define FRUT_REPLACE_GLOBAL_NEW 0
+#endif
+#endif
+
+// detect heap allocations with an allocation hook of Microsoft's
+// debug CRT instead (see ScopedAllocationGuard); define as 0 or 1 to
+// override the default
+#ifndef FRUT_USE_CRT_ALLOCATION_HOOK
+#if defined(DEBUG) && defined(_MSC_VER) && defined(_DEBUG) && !FRUT_REPLACE_GLOBAL_NEW
+#define FRUT_USE_CRT_ALLOCATION_HOOK 1
+#else
+#define FRUT_USE_CRT_ALLOCATION_HOOK 0
+#endif
+#endif
+
+
+namespace frut
+{
+namespace audio
+{
+
+/// Detects heap allocations on the audio thread.  As long as an
+/// instance of this class exists, every call of the global "new"
+/// operator on the same thread will trigger an assertion.  **This
+/// class only works in debug builds and does nothing in release
+/// builds.  Calls of malloc() are not detected.**
+///
+/// Detection relies on replacing the global "new" and "delete"
+/// operators.  These are not limited to the guarded code: they serve
+/// every allocation in the process, including those of a plug-in
+/// host.  Hence, the operators are only replaced when
+/// FRUT_REPLACE_GLOBAL_NEW is 1 (default: debug builds of the
+/// standalone application).
+///
+/// Debug builds of plug-ins for Windows install an allocation hook
+/// of the debug CRT instead (FRUT_USE_CRT_ALLOCATION_HOOK).  It sees
+/// only allocations of modules that use the debug CRT (so not those
+/// of a release build of the host) and only asserts on threads that
+/// hold a guard.  Plug-in builds for other platforms still count
+/// guards, which can be queried with isActive(), but do not detect
+/// allocations.
+///
+class ScopedAllocationGuard
+{
+public:
+    ScopedAllocationGuard();
+    ~ScopedAllocationGuard();
+
+    static bool isActive();
+
+
+    /// Temporarily allows heap allocations on the current thread
+    /// (for code that is known to allocate, such as validation).
+    ///
+    class Exemption
+    {
+    public:
+        Exemption();
+        ~Exemption();
+
+    private:
+        JUCE_DECLARE_NON_COPYABLE(Exemption);
+
+        int savedGuardCount_;
+    };
+
+private:
+    JUCE_DECLARE_NON_COPYABLE(ScopedAllocationGuard);
+
+#ifdef DEBUG
+    static thread_local int guardCount_;
+#endif
+};
+
+}
+}
+
+#endif  // FRUT_AUDIO_ALLOCATION_GUARD_H
@@ -67,6 +67,9 @@ RingBuffer<Type>::RingBuffer(
     chunkSize_ = chunkSize;
     this->setCallbackClass(nullptr);
 
+    // allocate buffer for callback function
+    chunkBuffer_.setSize(numberOfChannels_, chunkSize_);
+
     // allocate memory for samples and pad memory areas to allow the
     // detection of memory leaks
     int paddedTotalLength = totalLength + 2;
@@ -309,16 +312,15 @@ void RingBuffer<Type>::importFrom(
             // run callback (if any)
             if (callbackClass_)
             {
-                AudioBuffer<Type> buffer(numberOfChannels_, chunkSize_);
-
-                copyTo(buffer, 0, chunkSize_);
+                copyTo(chunkBuffer_, 0, chunkSize_);
 
                 // process buffer chunk
-                bool writeBack = callbackClass_->processBufferChunk(buffer);
+                bool writeBack = callbackClass_->processBufferChunk(
+                                     chunkBuffer_);
 
                 if (writeBack)
                 {
-                    overwriteFrom(buffer, 0, chunkSize_);
+                    overwriteFrom(chunkBuffer_, 0, chunkSize_);
                 }
             }
         }
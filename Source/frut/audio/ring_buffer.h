@@ -170,6 +170,10 @@ protected:
     Array<int> channelOffsets_;
     HeapBlock<Type> audioData_;
 
+    // passed to the callback function; allocated only once to keep
+    // heap allocations off the audio thread
+    AudioBuffer<Type> chunkBuffer_;
+
     int numberOfChannels_;
     int chunkSize_;
     int samplesToFilledChunk_;
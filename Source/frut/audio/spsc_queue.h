@@ -0,0 +1,173 @@
+/* ----------------------------------------------------------------------------
+
+   FrutJUCE
+   ========
+   Common classes for use with the JUCE library
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+#ifndef FRUT_AUDIO_SPSC_QUEUE_H
+#define FRUT_AUDIO_SPSC_QUEUE_H
+
+namespace frut
+{
+namespace audio
+{
+
+/// Lock-free bounded queue for passing items from a single producer
+/// thread (such as the audio thread) to a single consumer thread
+/// (such as a worker thread).  Items are written to and read from
+/// pre-allocated slots in place, so neither side ever blocks,
+/// allocates or copies an item.
+///
+/// The queue holds up to (capacity - 1) items.
+///
+template <typename Type>
+class SpscQueue
+{
+public:
+    /// Create a new queue.  All slots are default-constructed.
+    ///
+    /// @param capacity number of slots
+    ///
+    explicit SpscQueue(const int capacity) :
+        capacity_(jmax(2, capacity)),
+        slots_(new Type[capacity_]),
+        writeIndex_(0),
+        readIndex_(0)
+    {
+    }
+
+
+    /// Get number of slots.
+    ///
+    /// @return number of slots
+    ///
+    int getCapacity() const
+    {
+        return capacity_;
+    }
+
+
+    /// Get a slot for pre-allocating its contents.  **Must not be
+    /// called while the queue is in use.**
+    ///
+    /// @param index slot index
+    ///
+    /// @return slot
+    ///
+    Type &getSlot(const int index)
+    {
+        jassert(isPositiveAndBelow(index, capacity_));
+        return slots_[index];
+    }
+
+
+    /// Get slot that may be written to by the producer.  **Must only
+    /// be called by the producer thread.**
+    ///
+    /// @return free slot, or **nullptr** if the queue is full
+    ///
+    Type *getWriteSlot()
+    {
+        int writeIndex = writeIndex_.load(std::memory_order_relaxed);
+        int nextIndex = (writeIndex + 1) % capacity_;
+
+        if (nextIndex == readIndex_.load(std::memory_order_acquire))
+        {
+            return nullptr;
+        }
+
+        return &slots_[writeIndex];
+    }
+
+
+    /// Hand the slot returned by getWriteSlot() to the consumer.
+    /// **Must only be called by the producer thread.**
+    ///
+    void push()
+    {
+        int writeIndex = writeIndex_.load(std::memory_order_relaxed);
+        writeIndex_.store((writeIndex + 1) % capacity_,
+                          std::memory_order_release);
+    }
+
+
+    /// Get oldest item.  **Must only be called by the consumer
+    /// thread.**
+    ///
+    /// @return oldest item, or **nullptr** if the queue is empty
+    ///
+    Type *getReadSlot()
+    {
+        int readIndex = readIndex_.load(std::memory_order_relaxed);
+
+        if (readIndex == writeIndex_.load(std::memory_order_acquire))
+        {
+            return nullptr;
+        }
+
+        return &slots_[readIndex];
+    }
+
+
+    /// Return the slot returned by getReadSlot() to the producer.
+    /// **Must only be called by the consumer thread.**
+    ///
+    void pop()
+    {
+        int readIndex = readIndex_.load(std::memory_order_relaxed);
+        readIndex_.store((readIndex + 1) % capacity_,
+                         std::memory_order_release);
+    }
+
+
+    /// Check whether the queue contains items.  May be called from
+    /// any thread, but the answer may be outdated on return.
+    ///
+    /// @return **true** if queue is empty
+    ///
+    bool isEmpty() const
+    {
+        return readIndex_.load(std::memory_order_acquire) ==
+               writeIndex_.load(std::memory_order_acquire);
+    }
+
+private:
+    JUCE_DECLARE_NON_COPYABLE(SpscQueue);
+
+    static const int cacheLineSize_ = 64;
+
+    const int capacity_;
+    std::unique_ptr<Type[]> slots_;
+
+    // written by the producer
+    std::atomic<int> writeIndex_;
+    char writerPadding_[cacheLineSize_ - sizeof(std::atomic<int>)];
+
+    // written by the consumer
+    std::atomic<int> readIndex_;
+    char readerPadding_[cacheLineSize_ - sizeof(std::atomic<int>)];
+};
+
+}
+}
+
+#endif  // FRUT_AUDIO_SPSC_QUEUE_H
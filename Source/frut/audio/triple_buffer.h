@@ -0,0 +1,182 @@
+/* ----------------------------------------------------------------------------
+
+   FrutJUCE
+   ========
+   Common classes for use with the JUCE library
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+#ifndef FRUT_AUDIO_TRIPLE_BUFFER_H
+#define FRUT_AUDIO_TRIPLE_BUFFER_H
+
+namespace frut
+{
+namespace audio
+{
+
+/// Wait-free triple buffer for passing snapshots of plain data from
+/// a single writer thread (such as the audio thread) to a single
+/// reader thread (such as the message thread).  Neither side ever
+/// blocks, and the reader always sees a complete snapshot.  Slots
+/// and indices start on separate cache lines so that writer and
+/// reader do not contend.  Instances allocated with "new" are
+/// aligned to cache lines even before C++17; embedded in another
+/// object, they are only as aligned as that object.
+///
+/// **Type must be trivially copyable.**
+///
+template <typename Type>
+class TripleBuffer
+{
+public:
+    TripleBuffer() :
+        writeIndex_(0),
+        readIndex_(1),
+        backIndex_(2)
+    {
+        static_assert(std::is_trivially_copyable<Type>::value,
+                      "TripleBuffer requires trivially copyable data");
+        static_assert(alignof(Slot) == cacheLineSize_,
+                      "slots must be aligned to cache lines");
+
+        for (int index = 0; index < numberOfSlots_; ++index)
+        {
+            slots_[index].value = Type();
+        }
+    }
+
+
+    /// Allocate memory that is aligned to cache lines (plain "new"
+    /// only guarantees this from C++17 on).
+    ///
+    /// @param size number of bytes
+    ///
+    /// @return aligned memory
+    ///
+    static void *operator new(std::size_t size)
+    {
+        // keep the address returned by the global operator just
+        // before the aligned block
+        void *memory = ::operator new(size + cacheLineSize_ + sizeof(void *));
+
+        std::uintptr_t address = reinterpret_cast<std::uintptr_t>(memory) +
+                                 sizeof(void *);
+        address = (address + cacheLineSize_ - 1) &
+                  ~static_cast<std::uintptr_t>(cacheLineSize_ - 1);
+
+        void *alignedMemory = reinterpret_cast<void *>(address);
+        static_cast<void **>(alignedMemory)[-1] = memory;
+
+        return alignedMemory;
+    }
+
+
+    static void operator delete(void *alignedMemory)
+    {
+        if (alignedMemory != nullptr)
+        {
+            ::operator delete(static_cast<void **>(alignedMemory)[-1]);
+        }
+    }
+
+
+    /// Get buffer that may be written to by the writer thread.
+    ///
+    /// @return buffer which is private to the writer
+    ///
+    Type &getWriteBuffer()
+    {
+        return slots_[writeIndex_].value;
+    }
+
+
+    /// Publish the contents of the write buffer to the reader and
+    /// acquire a new write buffer.  **Must only be called by the
+    /// writer thread.**
+    ///
+    void publish()
+    {
+        int previousBack = backIndex_.exchange(writeIndex_ | dirtyFlag_,
+                                               std::memory_order_acq_rel);
+
+        writeIndex_ = previousBack & indexMask_;
+    }
+
+
+    /// Fetch the most recently published snapshot (if any).  **Must
+    /// only be called by the reader thread.**
+    ///
+    /// @return true if a new snapshot has been published since the
+    ///         last call
+    ///
+    bool update()
+    {
+        if ((backIndex_.load(std::memory_order_relaxed) & dirtyFlag_) == 0)
+        {
+            return false;
+        }
+
+        int previousBack = backIndex_.exchange(readIndex_,
+                                               std::memory_order_acq_rel);
+
+        readIndex_ = previousBack & indexMask_;
+        return true;
+    }
+
+
+    /// Get snapshot that has been fetched by the last call of
+    /// update().  **Must only be called by the reader thread.**
+    ///
+    /// @return latest snapshot
+    ///
+    const Type &getReadBuffer() const
+    {
+        return slots_[readIndex_].value;
+    }
+
+private:
+    JUCE_DECLARE_NON_COPYABLE(TripleBuffer);
+
+    static const int cacheLineSize_ = 64;
+    static const int numberOfSlots_ = 3;
+    static const int indexMask_ = 0x03;
+    static const int dirtyFlag_ = 0x04;
+
+    struct alignas(cacheLineSize_) Slot
+    {
+        Type value;
+    };
+
+    Slot slots_[numberOfSlots_];
+
+    // owned by the writer
+    alignas(cacheLineSize_) int writeIndex_;
+
+    // owned by the reader
+    alignas(cacheLineSize_) int readIndex_;
+
+    // shared; contains index of back buffer and "dirty" flag
+    alignas(cacheLineSize_) std::atomic<int> backIndex_;
+};
+
+}
+}
+
+#endif  // FRUT_AUDIO_TRIPLE_BUFFER_H
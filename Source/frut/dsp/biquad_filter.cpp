@@ -188,21 +188,33 @@ void BiquadFilter::processInPlace(
 {
     jassert(buffer.getNumChannels() == numberOfChannels_);
 
+    int numberOfSamples = buffer.getNumSamples();
+
     for (int channel = 0; channel < numberOfChannels_; ++channel)
     {
-        double &x0 = x0_.getReference(channel);
-        double &x1 = x1_.getReference(channel);
-        double &x2 = x2_.getReference(channel);
+        // work on local copies of the delays, as the compiler cannot
+        // keep array elements in registers while writing to the
+        // buffer (both are doubles and might alias)
+        double x0 = x0_[channel];
+        double x1 = x1_[channel];
+        double x2 = x2_[channel];
 
-        double &y1 = y1_.getReference(channel);
-        double &y2 = y2_.getReference(channel);
+        double y1 = y1_[channel];
+        double y2 = y2_[channel];
+
+        double *samples = buffer.getWritePointer(channel);
 
-        for (int sampleId = 0; sampleId < buffer.getNumSamples(); ++sampleId)
+        for (int sampleId = 0; sampleId < numberOfSamples; ++sampleId)
         {
-            double sampleValue = buffer.getSample(channel, sampleId);
-            processSampleInternal(sampleValue, x0, x1, x2, y1, y2);
-            buffer.setSample(channel, sampleId, sampleValue);
+            processSampleInternal(samples[sampleId], x0, x1, x2, y1, y2);
         }
+
+        x0_.set(channel, x0);
+        x1_.set(channel, x1);
+        x2_.set(channel, x2);
+
+        y1_.set(channel, y1);
+        y2_.set(channel, y2);
     }
 }
 
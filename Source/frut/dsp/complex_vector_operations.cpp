@@ -0,0 +1,338 @@
+/* ----------------------------------------------------------------------------
+
+   FrutJUCE
+   ========
+   Common classes for use with the JUCE library
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+#if JUCE_INTEL
+#include <immintrin.h>
+
+// allow SIMD code in functions without changing the compiler flags
+// of the whole project (Visual C++ does not need this)
+#if defined (__GNUC__) || defined (__clang__)
+#define FRUT_DSP_TARGET_SSE2 __attribute__((target("sse2")))
+#define FRUT_DSP_TARGET_AVX __attribute__((target("avx")))
+#else
+#define FRUT_DSP_TARGET_SSE2
+#define FRUT_DSP_TARGET_AVX
+#endif
+
+#endif  // JUCE_INTEL
+
+
+namespace frut
+{
+namespace dsp
+{
+
+namespace
+{
+
+void multiply_Scalar(
+    float *destination,
+    const float *source,
+    const int numberOfValues)
+{
+    for (int i = 0; i < 2 * numberOfValues; i += 2)
+    {
+        // multiplication of complex numbers: index 0 contains the real
+        // part, index 1 the imaginary part
+        float realPart = destination[i] * source[i] -
+                         destination[i + 1] * source[i + 1];
+        float imagPart = destination[i + 1] * source[i] +
+                         destination[i] * source[i + 1];
+
+        destination[i] = realPart;
+        destination[i + 1] = imagPart;
+    }
+}
+
+
+void multiplyAdd_Scalar(
+    float *destination,
+    const float *source1,
+    const float *source2,
+    const int numberOfValues)
+{
+    for (int i = 0; i < 2 * numberOfValues; i += 2)
+    {
+        destination[i] += source1[i] * source2[i] -
+                          source1[i + 1] * source2[i + 1];
+        destination[i + 1] += source1[i + 1] * source2[i] +
+                              source1[i] * source2[i + 1];
+    }
+}
+
+
+#if JUCE_INTEL
+
+// multiplies two complex numbers in every half of "a" and "b"
+FRUT_DSP_TARGET_SSE2 inline __m128 multiplyPairs_Sse2(
+    const __m128 a,
+    const __m128 b)
+{
+    // SSE2 lacks "addsub", so flip the sign of the real part instead
+    const __m128 signMask = _mm_setr_ps(-0.0f, 0.0f, -0.0f, 0.0f);
+
+    __m128 bReal = _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 2, 0, 0));
+    __m128 bImag = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 3, 1, 1));
+    __m128 aSwapped = _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1));
+
+    return _mm_add_ps(_mm_mul_ps(a, bReal),
+                      _mm_xor_ps(_mm_mul_ps(aSwapped, bImag), signMask));
+}
+
+
+FRUT_DSP_TARGET_SSE2 void multiply_Sse2(
+    float *destination,
+    const float *source,
+    const int numberOfValues)
+{
+    int numberOfFloats = 2 * numberOfValues;
+    int i = 0;
+
+    for (; i + 4 <= numberOfFloats; i += 4)
+    {
+        __m128 product = multiplyPairs_Sse2(_mm_loadu_ps(destination + i),
+                                            _mm_loadu_ps(source + i));
+
+        _mm_storeu_ps(destination + i, product);
+    }
+
+    multiply_Scalar(destination + i, source + i, (numberOfFloats - i) / 2);
+}
+
+
+FRUT_DSP_TARGET_SSE2 void multiplyAdd_Sse2(
+    float *destination,
+    const float *source1,
+    const float *source2,
+    const int numberOfValues)
+{
+    int numberOfFloats = 2 * numberOfValues;
+    int i = 0;
+
+    for (; i + 4 <= numberOfFloats; i += 4)
+    {
+        __m128 product = multiplyPairs_Sse2(_mm_loadu_ps(source1 + i),
+                                            _mm_loadu_ps(source2 + i));
+
+        _mm_storeu_ps(destination + i,
+                      _mm_add_ps(_mm_loadu_ps(destination + i), product));
+    }
+
+    multiplyAdd_Scalar(destination + i, source1 + i, source2 + i,
+                       (numberOfFloats - i) / 2);
+}
+
+
+// multiplies four complex numbers in "a" and "b"
+FRUT_DSP_TARGET_AVX inline __m256 multiplyQuads_Avx(
+    const __m256 a,
+    const __m256 b)
+{
+    __m256 bReal = _mm256_moveldup_ps(b);
+    __m256 bImag = _mm256_movehdup_ps(b);
+    __m256 aSwapped = _mm256_permute_ps(a, _MM_SHUFFLE(2, 3, 0, 1));
+
+    return _mm256_addsub_ps(_mm256_mul_ps(a, bReal),
+                            _mm256_mul_ps(aSwapped, bImag));
+}
+
+
+FRUT_DSP_TARGET_AVX void multiply_Avx(
+    float *destination,
+    const float *source,
+    const int numberOfValues)
+{
+    int numberOfFloats = 2 * numberOfValues;
+    int i = 0;
+
+    for (; i + 8 <= numberOfFloats; i += 8)
+    {
+        __m256 product = multiplyQuads_Avx(_mm256_loadu_ps(destination + i),
+                                           _mm256_loadu_ps(source + i));
+
+        _mm256_storeu_ps(destination + i, product);
+    }
+
+    // the scalar code uses legacy SSE encoding; without clearing the
+    // upper halves of the AVX registers first, it (and all SSE code
+    // that runs after this function) is slowed down by state
+    // transitions (the compiler may turn the call into a jump and
+    // omit "vzeroupper")
+    _mm256_zeroupper();
+
+    multiply_Scalar(destination + i, source + i, (numberOfFloats - i) / 2);
+}
+
+
+FRUT_DSP_TARGET_AVX void multiplyAdd_Avx(
+    float *destination,
+    const float *source1,
+    const float *source2,
+    const int numberOfValues)
+{
+    int numberOfFloats = 2 * numberOfValues;
+    int i = 0;
+
+    for (; i + 8 <= numberOfFloats; i += 8)
+    {
+        __m256 product = multiplyQuads_Avx(_mm256_loadu_ps(source1 + i),
+                                           _mm256_loadu_ps(source2 + i));
+
+        _mm256_storeu_ps(destination + i,
+                         _mm256_add_ps(_mm256_loadu_ps(destination + i), product));
+    }
+
+    // see multiply_Avx()
+    _mm256_zeroupper();
+
+    multiplyAdd_Scalar(destination + i, source1 + i, source2 + i,
+                       (numberOfFloats - i) / 2);
+}
+
+#endif  // JUCE_INTEL
+
+}
+
+
+/// Multiply complex numbers in place.
+///
+/// @param destination complex numbers to be multiplied (interleaved)
+///
+/// @param source complex numbers to multiply with (interleaved)
+///
+/// @param numberOfValues number of complex numbers
+///
+void ComplexVectorOperations::multiply(
+    float *destination,
+    const float *source,
+    const int numberOfValues)
+{
+    getImplementation().multiply(destination, source, numberOfValues);
+}
+
+
+/// Multiply complex numbers and add products to destination.
+///
+/// @param destination accumulated complex numbers (interleaved)
+///
+/// @param source1 first factors (interleaved)
+///
+/// @param source2 second factors (interleaved)
+///
+/// @param numberOfValues number of complex numbers
+///
+void ComplexVectorOperations::multiplyAdd(
+    float *destination,
+    const float *source1,
+    const float *source2,
+    const int numberOfValues)
+{
+    getImplementation().multiplyAdd(destination, source1, source2,
+                                    numberOfValues);
+}
+
+
+/// Get name of the code path selected for this CPU.
+///
+/// @return "AVX", "SSE2" or "scalar"
+///
+String ComplexVectorOperations::getImplementationName()
+{
+    return getImplementation().name;
+}
+
+
+/// Select a code path by name, e.g. to compare code paths in a
+/// benchmark.  **Must not be called while other threads use this
+/// class.**
+///
+/// @param name "AVX", "SSE2" or "scalar"
+///
+/// @return **false** if this CPU does not support the code path
+///
+bool ComplexVectorOperations::setImplementation(
+    const String &name)
+{
+    for (auto implementation : getAvailableImplementations())
+    {
+        if (name == implementation.name)
+        {
+            getImplementation() = implementation;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+ComplexVectorOperations::Implementation &ComplexVectorOperations::getImplementation()
+{
+    // selected once (thread-safe since C++11); only changed by
+    // setImplementation()
+    static Implementation implementation = selectImplementation();
+
+    return implementation;
+}
+
+
+/// Get code paths that can run on this CPU.
+///
+/// @return implementations, fastest first
+///
+Array<ComplexVectorOperations::Implementation> ComplexVectorOperations::getAvailableImplementations()
+{
+    Array<Implementation> implementations;
+
+#if JUCE_INTEL
+
+    // AVX comes first, as it handles twice as many values per
+    // instruction as SSE2 ("kmeter_analyse --benchmark" compares all
+    // code paths on the host's processor)
+    if (SystemStats::hasAVX())
+    {
+        implementations.add({"AVX", multiply_Avx, multiplyAdd_Avx});
+    }
+
+    if (SystemStats::hasSSE2())
+    {
+        implementations.add({"SSE2", multiply_Sse2, multiplyAdd_Sse2});
+    }
+
+#endif  // JUCE_INTEL
+
+    implementations.add({"scalar", multiply_Scalar, multiplyAdd_Scalar});
+
+    return implementations;
+}
+
+
+ComplexVectorOperations::Implementation ComplexVectorOperations::selectImplementation()
+{
+    return getAvailableImplementations().getFirst();
+}
+
+}
+}
@@ -0,0 +1,76 @@
+/* ----------------------------------------------------------------------------
+
+   FrutJUCE
+   ========
+   Common classes for use with the JUCE library
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+#ifndef FRUT_DSP_COMPLEX_VECTOR_OPERATIONS_H
+#define FRUT_DSP_COMPLEX_VECTOR_OPERATIONS_H
+
+namespace frut
+{
+namespace dsp
+{
+
+/// Vector operations on complex numbers stored in interleaved
+/// layout (real part followed by imaginary part, as in FFTW's
+/// "fftwf_complex").
+///
+/// On Intel CPUs, SSE2 or AVX code is selected at run time
+/// depending on the features of the host's processor.  The SIMD
+/// code performs exactly the same floating-point operations as the
+/// plain C++ code, so results do not depend on the CPU.
+///
+class ComplexVectorOperations
+{
+public:
+    static void multiply(float *destination,
+                         const float *source,
+                         const int numberOfValues);
+
+    static void multiplyAdd(float *destination,
+                            const float *source1,
+                            const float *source2,
+                            const int numberOfValues);
+
+    static String getImplementationName();
+
+    struct Implementation
+    {
+        const char *name;
+
+        void (*multiply)(float *, const float *, const int);
+        void (*multiplyAdd)(float *, const float *, const float *, const int);
+    };
+
+    static Array<Implementation> getAvailableImplementations();
+    static bool setImplementation(const String &name);
+
+private:
+    static Implementation &getImplementation();
+    static Implementation selectImplementation();
+};
+
+}
+}
+
+#endif  // FRUT_DSP_COMPLEX_VECTOR_OPERATIONS_H
@@ -55,23 +55,10 @@ void Dither::initialise(
     jassert(numberOfBits <= 24);
 
     numberOfChannels_ = numberOfChannels;
+    channelStates_.calloc(static_cast<size_t>(numberOfChannels_));
 
-    randomNumber_1_.clear();
-    randomNumber_2_.clear();
-
-    errorFeedback_1_.clear();
-    errorFeedback_2_.clear();
-
-    for (int currentChannel = 0; currentChannel < numberOfChannels_; ++currentChannel)
-    {
-        // rectangular-PDF random numbers
-        randomNumber_1_.add(0);
-        randomNumber_2_.add(0);
-
-        // error feedback buffers
-        errorFeedback_1_.add(0.0);
-        errorFeedback_2_.add(0.0);
-    }
+    // rectangular-PDF random numbers and error feedback buffers
+    seed(defaultSeed);
 
     // set to 0.0 for no noise shaping
     noiseShaping_ = noiseShaping;
@@ -81,7 +68,7 @@ void Dither::initialise(
     wordLengthInverted_ = 1.0 / wordLength_;
 
     // dither amplitude (2 LSB)
-    ditherAmplitude_ = wordLengthInverted_ / RAND_MAX;
+    ditherAmplitude_ = wordLengthInverted_ / randomMaximum;
 
     // remove DC offset
     dcOffset_ = wordLengthInverted_ * 0.5;
@@ -90,6 +77,42 @@ void Dither::initialise(
 }
 
 
+/// Resets the dither state of all channels and seeds their random
+/// number generators.  Identical seeds yield identical output, so
+/// renders can be reproduced.
+///
+/// @param seedValue seed for the random number generators (every
+///        channel derives its own seed from this value)
+///
+void Dither::seed(
+    const uint32 seedValue)
+{
+    for (int currentChannel = 0; currentChannel < numberOfChannels_; ++currentChannel)
+    {
+        ChannelState &state = channelStates_[currentChannel];
+
+        // decorrelate channels (MurmurHash3 finaliser)
+        uint32 randomState = seedValue + 0x9E3779B9u *
+                             static_cast<uint32>(currentChannel + 1);
+
+        randomState ^= randomState >> 16;
+        randomState *= 0x85EBCA6Bu;
+        randomState ^= randomState >> 13;
+        randomState *= 0xC2B2AE35u;
+        randomState ^= randomState >> 16;
+
+        // xorshift generators must not be seeded with zero
+        state.randomState = (randomState != 0) ? randomState : defaultSeed;
+
+        state.randomNumber_1 = 0;
+        state.randomNumber_2 = 0;
+
+        state.errorFeedback_1 = 0.0;
+        state.errorFeedback_2 = 0.0;
+    }
+}
+
+
 
 void Dither::convertToDouble(
     const AudioBuffer<float> &sourceBufferFloat,
@@ -246,29 +269,36 @@ void Dither::denormalizeToDouble(
 
 // Thanks to Paul Kellet for the code snippet!
 // (http://www.musicdsp.org/showone.php?id=77)
-float Dither::ditherSample(
-    const int currentChannel,
-    const double &sourceValueDouble)
+inline float Dither::ditherValue(
+    ChannelState &state,
+    const double sourceValueDouble) const
 {
-    jassert(isInitialized_);
+    // xorshift32 (period of 2^32 - 1); use the upper 31 bits to get
+    // non-negative random numbers that cannot overflow when
+    // subtracted from each other
+    uint32 randomState = state.randomState;
+
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
 
-    // can make HP-TRI dither by subtracting previous rand()
-    randomNumber_2_.set(currentChannel,
-                        randomNumber_1_[currentChannel]);
-    randomNumber_1_.set(currentChannel,
-                        rand());
+    state.randomState = randomState;
+
+    // can make HP-TRI dither by subtracting previous random number
+    state.randomNumber_2 = state.randomNumber_1;
+    state.randomNumber_1 = static_cast<int>(randomState >> 1);
 
     // error feedback
     double destinationValue = sourceValueDouble + noiseShaping_ *
-                              (errorFeedback_1_[currentChannel] +
-                               errorFeedback_1_[currentChannel] -
-                               errorFeedback_2_[currentChannel]);
+                              (state.errorFeedback_1 +
+                               state.errorFeedback_1 -
+                               state.errorFeedback_2);
 
     // DC offset and dither
     double tempDestinationValue = destinationValue + dcOffset_ +
                                   ditherAmplitude_ * static_cast<double>(
-                                      randomNumber_1_[currentChannel] -
-                                      randomNumber_2_[currentChannel]);
+                                      state.randomNumber_1 -
+                                      state.randomNumber_2);
 
     // truncate downwards
     int destinationTruncate = static_cast<int>(
@@ -281,19 +311,67 @@ float Dither::ditherSample(
     }
 
     // old error feedback
-    errorFeedback_2_.set(currentChannel,
-                         errorFeedback_1_[currentChannel]);
+    state.errorFeedback_2 = state.errorFeedback_1;
 
     // new error feedback
-    errorFeedback_1_.set(currentChannel,
-                         destinationValue - wordLengthInverted_ *
-                         static_cast<double>(destinationTruncate));
+    state.errorFeedback_1 = destinationValue - wordLengthInverted_ *
+                            static_cast<double>(destinationTruncate);
 
     // return dithered destination sample
     return static_cast<float>(destinationValue);
 }
 
 
+float Dither::ditherSample(
+    const int currentChannel,
+    const double &sourceValueDouble)
+{
+    jassert(isInitialized_);
+    jassert(isPositiveAndBelow(currentChannel, numberOfChannels_));
+
+    return ditherValue(channelStates_[currentChannel],
+                       sourceValueDouble);
+}
+
+
+/// Dithers a span of samples of a single channel.  Prefer this over
+/// calling ditherSample() in a loop.
+///
+/// The error feedback of the noise shaper depends on the previous
+/// sample, so samples cannot be processed in parallel.  Instead,
+/// the state of the channel is loaded once and kept in registers
+/// for the whole span.
+///
+/// @param currentChannel channel whose dither state is used
+///
+/// @param sourceSamplesDouble samples to be dithered
+///
+/// @param destinationSamplesFloat receives the dithered samples;
+///        may not overlap with the source
+///
+/// @param numberOfSamples number of samples to dither
+///
+void Dither::ditherBlock(
+    const int currentChannel,
+    const double *sourceSamplesDouble,
+    float *destinationSamplesFloat,
+    const int numberOfSamples)
+{
+    jassert(isInitialized_);
+    jassert(isPositiveAndBelow(currentChannel, numberOfChannels_));
+
+    ChannelState state = channelStates_[currentChannel];
+
+    for (int currentSample = 0; currentSample < numberOfSamples; ++currentSample)
+    {
+        destinationSamplesFloat[currentSample] = ditherValue(
+                    state, sourceSamplesDouble[currentSample]);
+    }
+
+    channelStates_[currentChannel] = state;
+}
+
+
 void Dither::ditherToFloat(
     const AudioBuffer<double> &sourceBufferDouble,
     AudioBuffer<float> &destinationBufferFloat)
@@ -308,22 +386,11 @@ void Dither::ditherToFloat(
 
     for (int currentChannel = 0; currentChannel < numberOfChannels; ++currentChannel)
     {
-        for (int currentSample = 0; currentSample < numberOfSamples; ++currentSample)
-        {
-            // load sample
-            double sourceValueDouble = sourceBufferDouble.getSample(
-                                           currentChannel, currentSample);
-
-            // dither sample
-            float destinationValueFloat = ditherSample(currentChannel,
-                                          sourceValueDouble);
-
-            // store sample
-            destinationBufferFloat.setSample(
-                currentChannel, currentSample, destinationValueFloat);
-        }
+        ditherBlock(currentChannel,
+                    sourceBufferDouble.getReadPointer(currentChannel),
+                    destinationBufferFloat.getWritePointer(currentChannel),
+                    numberOfSamples);
     }
 }
-
 }
 }
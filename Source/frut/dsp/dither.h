@@ -40,6 +40,8 @@ public:
                     const int numberOfBits,
                     const double noiseShaping = 0.5);
 
+    void seed(const uint32 seedValue);
+
     void convertToDouble(const AudioBuffer<float> &sourceBufferFloat,
                          AudioBuffer<double> &destinationBufferDouble);
 
@@ -55,15 +57,36 @@ public:
     float ditherSample(const int currentChannel,
                        const double &sourceValueDouble);
 
+    void ditherBlock(const int currentChannel,
+                     const double *sourceSamplesDouble,
+                     float *destinationSamplesFloat,
+                     const int numberOfSamples);
+
     void ditherToFloat(const AudioBuffer<double> &sourceBufferDouble,
                        AudioBuffer<float> &destinationBufferFloat);
 
 private:
-    Array<int> randomNumber_1_;
-    Array<int> randomNumber_2_;
+    /// Dither state of a single channel.  Every channel owns its
+    /// random number generator, so dithering neither takes a lock
+    /// nor depends on the order in which channels are processed.
+    struct ChannelState
+    {
+        uint32 randomState;
+
+        int randomNumber_1;
+        int randomNumber_2;
+
+        double errorFeedback_1;
+        double errorFeedback_2;
+    };
 
-    Array<double> errorFeedback_1_;
-    Array<double> errorFeedback_2_;
+    inline float ditherValue(ChannelState &state,
+                             const double sourceValueDouble) const;
+
+    static const uint32 defaultSeed = 0x4B4D5452u;
+    static const int randomMaximum = 0x7FFFFFFF;
+
+    HeapBlock<ChannelState> channelStates_;
 
     const float antiDenormalFloat_;
     const double antiDenormalDouble_;
@@ -77,6 +100,8 @@ private:
     double noiseShaping_;
     double wordLength_;
     double wordLengthInverted_;
+
+    JUCE_LEAK_DETECTOR(Dither);
 };
 
 }
@@ -0,0 +1,468 @@
+/* ----------------------------------------------------------------------------
+
+   FrutJUCE
+   ========
+   Common classes for use with the JUCE library
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+#if FRUT_DSP_USE_FFTW
+
+namespace frut
+{
+namespace dsp
+{
+
+namespace
+{
+
+// FFTW reads and writes wisdom one character at a time
+void writeWisdomCharacter(
+    char character,
+    void *data)
+{
+    static_cast<MemoryOutputStream *>(data)->writeByte(character);
+}
+
+
+int readWisdomCharacter(
+    void *data)
+{
+    auto wisdom = static_cast<MemoryInputStream *>(data);
+
+    if (wisdom->isExhausted())
+    {
+        return EOF;
+    }
+
+    return static_cast<unsigned char>(wisdom->readByte());
+}
+
+}
+
+
+bool FftwPlanner::PlanRequest::operator==(
+    const PlanRequest &other) const
+{
+    return (isInverse == other.isInverse) &&
+           (fftSize == other.fftSize) &&
+           (numberOfTransforms == other.numberOfTransforms) &&
+           (isInPlace == other.isInPlace);
+}
+
+
+FftwPlanner::FftwPlanner() :
+    Thread("FFTW planner")
+{
+#if (defined (_WIN32) || defined (_WIN64))
+    File currentExecutableFile = File::getSpecialLocation(
+                                     File::currentExecutableFile);
+
+#ifdef _WIN64
+    File dynamicLibraryFftwFile = currentExecutableFile.getSiblingFile(
+                                      "kmeter/fftw/libfftw3f-3_x64.dll");
+#else
+    File dynamicLibraryFftwFile = currentExecutableFile.getSiblingFile(
+                                      "kmeter/fftw/libfftw3f-3.dll");
+#endif
+
+    String dynamicLibraryFftwPath = dynamicLibraryFftwFile.getFullPathName();
+    dynamicLibraryFFTW.open(dynamicLibraryFftwPath);
+
+    if (!dynamicLibraryFFTW.getNativeHandle())
+    {
+        NativeMessageBox::showMessageBox(
+            AlertWindow::WarningIcon,
+            "Missing library",
+            "Could not find the FFTW library at\n" + dynamicLibraryFftwPath,
+            nullptr);
+    }
+
+    fftwf_alloc_real = (float * (*)(size_t)) dynamicLibraryFFTW.getFunction(
+                           "fftwf_alloc_real");
+    fftwf_alloc_complex = (fftwf_complex * (*)(size_t)) dynamicLibraryFFTW.getFunction(
+                              "fftwf_alloc_complex");
+    fftwf_free = (void (*)(void *)) dynamicLibraryFFTW.getFunction(
+                     "fftwf_free");
+
+    fftwf_plan_many_dft_r2c = (fftwf_plan(*)(int, const int *, int, float *, const int *, int, int, fftwf_complex *, const int *, int, int, unsigned)) dynamicLibraryFFTW.getFunction(
+                                  "fftwf_plan_many_dft_r2c");
+    fftwf_plan_many_dft_c2r = (fftwf_plan(*)(int, const int *, int, fftwf_complex *, const int *, int, int, float *, const int *, int, int, unsigned)) dynamicLibraryFFTW.getFunction(
+                                  "fftwf_plan_many_dft_c2r");
+    fftwf_destroy_plan = (void (*)(fftwf_plan)) dynamicLibraryFFTW.getFunction(
+                             "fftwf_destroy_plan");
+
+    fftwf_execute_dft_r2c = (void (*)(const fftwf_plan, float *, fftwf_complex *)) dynamicLibraryFFTW.getFunction(
+                                "fftwf_execute_dft_r2c");
+    fftwf_execute_dft_c2r = (void (*)(const fftwf_plan, fftwf_complex *, float *)) dynamicLibraryFFTW.getFunction(
+                                "fftwf_execute_dft_c2r");
+
+    fftwf_export_wisdom = (void (*)(void (*)(char, void *), void *)) dynamicLibraryFFTW.getFunction(
+                              "fftwf_export_wisdom");
+    fftwf_import_wisdom = (int (*)(int (*)(void *), void *)) dynamicLibraryFFTW.getFunction(
+                              "fftwf_import_wisdom");
+#endif
+
+    importWisdom();
+
+    // measuring must not compete with audio threads
+    startThread(2);
+}
+
+
+FftwPlanner::~FftwPlanner()
+{
+    // measuring a single plan takes well below a second
+    signalThreadShouldExit();
+    notify();
+    stopThread(10000);
+
+    // all runners must have released their plans by now
+    const ScopedLock lock(plannerLock_);
+
+    for (auto &planEntry : planEntries_)
+    {
+        jassert(planEntry.referenceCount == 0);
+        fftwf_destroy_plan(planEntry.plan);
+    }
+
+    planEntries_.clear();
+}
+
+
+/// Get a plan for real-to-complex (or complex-to-real) transforms.
+/// Release it with releasePlan() when done.  **Not real-time safe.**
+///
+/// @param isInverse **true** for complex-to-real transforms
+///
+/// @param fftSize number of real samples per transform
+///
+/// @param numberOfTransforms number of transforms that are executed
+///        at once; their arrays must follow each other in memory
+///
+/// @param isInPlace **true** if real and complex arrays share their
+///        memory
+///
+/// @return FFTW plan
+///
+fftwf_plan FftwPlanner::getPlan(
+    const bool isInverse,
+    const int fftSize,
+    const int numberOfTransforms,
+    const bool isInPlace)
+{
+    PlanRequest request = {isInverse, fftSize, numberOfTransforms, isInPlace};
+
+    {
+        const ScopedLock lock(cacheLock_);
+        int index = findPlanEntry(request);
+
+        if (index >= 0)
+        {
+            planEntries_.getReference(index).referenceCount++;
+            return planEntries_.getReference(index).plan;
+        }
+    }
+
+    bool isMeasured = true;
+    fftwf_plan plan;
+
+    {
+        const ScopedLock lock(plannerLock_);
+
+        // use wisdom if available; otherwise make do with an
+        // estimated plan until a measured one has been created
+        plan = createPlan(request, FFTW_MEASURE | FFTW_WISDOM_ONLY);
+
+        if (!plan)
+        {
+            plan = createPlan(request, FFTW_ESTIMATE);
+            isMeasured = false;
+        }
+    }
+
+    fftwf_plan obsoletePlan = nullptr;
+
+    {
+        const ScopedLock lock(cacheLock_);
+        int index = findPlanEntry(request);
+
+        // another thread may have created a measured plan in the
+        // meantime; use that one instead
+        if ((index >= 0) && planEntries_.getReference(index).isMeasured)
+        {
+            planEntries_.getReference(index).referenceCount++;
+
+            obsoletePlan = plan;
+            plan = planEntries_.getReference(index).plan;
+        }
+        else
+        {
+            planEntries_.add({request, plan, 1, isMeasured});
+
+            if (!isMeasured && !pendingRequests_.contains(request))
+            {
+                pendingRequests_.add(request);
+                notify();
+            }
+        }
+    }
+
+    if (obsoletePlan)
+    {
+        const ScopedLock lock(plannerLock_);
+        fftwf_destroy_plan(obsoletePlan);
+    }
+
+    return plan;
+}
+
+
+/// Release a plan obtained from getPlan().  **Not real-time safe.**
+///
+/// @param plan FFTW plan
+///
+void FftwPlanner::releasePlan(
+    const fftwf_plan plan)
+{
+    bool isObsolete = false;
+
+    {
+        const ScopedLock lock(cacheLock_);
+
+        for (int index = 0; index < planEntries_.size(); ++index)
+        {
+            auto &planEntry = planEntries_.getReference(index);
+
+            if (planEntry.plan == plan)
+            {
+                planEntry.referenceCount--;
+
+                // measured plans are kept for later use
+                if ((planEntry.referenceCount == 0) && !planEntry.isMeasured)
+                {
+                    planEntries_.remove(index);
+                    isObsolete = true;
+                }
+
+                break;
+            }
+        }
+    }
+
+    if (isObsolete)
+    {
+        const ScopedLock lock(plannerLock_);
+        fftwf_destroy_plan(plan);
+    }
+}
+
+
+/// Get file that stores FFTW's wisdom for the current user.
+///
+/// @return wisdom file
+///
+File FftwPlanner::getWisdomFile()
+{
+    return File::getSpecialLocation(
+               File::userApplicationDataDirectory).getChildFile(
+               "FrutJUCE/fftwf_wisdom.txt");
+}
+
+
+void FftwPlanner::run()
+{
+    while (!threadShouldExit())
+    {
+        if (!measureNextPlan())
+        {
+            wait(-1);
+        }
+    }
+}
+
+
+// call with "plannerLock_" held; overwrites contents of arrays when
+// measuring, so temporary arrays are used
+fftwf_plan FftwPlanner::createPlan(
+    const PlanRequest &request,
+    const unsigned flags)
+{
+    int fftSize = request.fftSize;
+    int halfFftSizePlusOne = fftSize / 2 + 1;
+
+    // in-place transforms pad real arrays to the size of spectra
+    int realDistance = request.isInPlace ? 2 * halfFftSizePlusOne : fftSize;
+    int complexDistance = halfFftSizePlusOne;
+
+    fftwf_complex *complexSamples = fftwf_alloc_complex(
+                                        request.numberOfTransforms * complexDistance);
+    float *realSamples = request.isInPlace ?
+                         reinterpret_cast<float *>(complexSamples) :
+                         fftwf_alloc_real(request.numberOfTransforms * realDistance);
+
+    fftwf_plan plan;
+
+    if (request.isInverse)
+    {
+        plan = fftwf_plan_many_dft_c2r(
+                   1, &fftSize, request.numberOfTransforms,
+                   complexSamples, nullptr, 1, complexDistance,
+                   realSamples, nullptr, 1, realDistance,
+                   flags);
+    }
+    else
+    {
+        plan = fftwf_plan_many_dft_r2c(
+                   1, &fftSize, request.numberOfTransforms,
+                   realSamples, nullptr, 1, realDistance,
+                   complexSamples, nullptr, 1, complexDistance,
+                   flags);
+    }
+
+    // plans are only executed on new arrays, so temporary arrays may
+    // be freed right away
+    if (!request.isInPlace)
+    {
+        fftwf_free(realSamples);
+    }
+
+    fftwf_free(complexSamples);
+
+    return plan;
+}
+
+
+// call with "cacheLock_" held; prefers measured plans
+int FftwPlanner::findPlanEntry(
+    const PlanRequest &request) const
+{
+    int foundIndex = -1;
+
+    for (int index = 0; index < planEntries_.size(); ++index)
+    {
+        const auto &planEntry = planEntries_.getReference(index);
+
+        if (planEntry.request == request)
+        {
+            if (planEntry.isMeasured)
+            {
+                return index;
+            }
+
+            foundIndex = index;
+        }
+    }
+
+    return foundIndex;
+}
+
+
+// measure plan for the oldest pending request and store it in the
+// cache
+//
+// @return **false** if there were no pending requests
+//
+bool FftwPlanner::measureNextPlan()
+{
+    PlanRequest request;
+
+    {
+        const ScopedLock lock(cacheLock_);
+
+        if (pendingRequests_.isEmpty())
+        {
+            return false;
+        }
+
+        request = pendingRequests_.getFirst();
+        int index = findPlanEntry(request);
+
+        // a plan created from wisdom is as good as a measured one
+        if ((index >= 0) && planEntries_.getReference(index).isMeasured)
+        {
+            pendingRequests_.removeFirstMatchingValue(request);
+            return true;
+        }
+    }
+
+    fftwf_plan plan;
+
+    {
+        const ScopedLock lock(plannerLock_);
+        plan = createPlan(request, FFTW_MEASURE);
+    }
+
+    {
+        const ScopedLock lock(cacheLock_);
+
+        pendingRequests_.removeFirstMatchingValue(request);
+        planEntries_.add({request, plan, 0, true});
+    }
+
+    exportWisdom();
+
+    return true;
+}
+
+
+void FftwPlanner::importWisdom()
+{
+    MemoryBlock wisdomData;
+
+    if (!getWisdomFile().loadFileAsData(wisdomData))
+    {
+        return;
+    }
+
+    MemoryInputStream wisdom(wisdomData, false);
+    const ScopedLock lock(plannerLock_);
+
+    // FFTW ignores wisdom it cannot parse (e.g. from another version)
+    fftwf_import_wisdom(readWisdomCharacter, &wisdom);
+}
+
+
+void FftwPlanner::exportWisdom()
+{
+    MemoryOutputStream wisdom;
+
+    {
+        const ScopedLock lock(plannerLock_);
+        fftwf_export_wisdom(writeWisdomCharacter, &wisdom);
+    }
+
+    File wisdomFile = getWisdomFile();
+    wisdomFile.getParentDirectory().createDirectory();
+
+    // several processes may update the file at the same time
+    TemporaryFile temporaryFile(wisdomFile);
+
+    if (temporaryFile.getFile().replaceWithData(wisdom.getData(),
+                                                wisdom.getDataSize()))
+    {
+        temporaryFile.overwriteTargetFileWithTemporary();
+    }
+}
+
+}
+}
+
+#endif  // FRUT_DSP_USE_FFTW
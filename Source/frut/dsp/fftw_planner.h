@@ -0,0 +1,138 @@
+/* ----------------------------------------------------------------------------
+
+   FrutJUCE
+   ========
+   Common classes for use with the JUCE library
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+#if FRUT_DSP_USE_FFTW
+
+#ifndef FRUT_DSP_FFTW_PLANNER_H
+#define FRUT_DSP_FFTW_PLANNER_H
+
+namespace frut
+{
+namespace dsp
+{
+
+/// Process-wide cache of FFTW plans.  Obtain it through a
+/// SharedResourcePointer, so that every FftwRunner in a process
+/// shares the same plans.
+///
+/// Plans are keyed by direction, size and number of transforms and
+/// are reference-counted.  They are created for contiguous arrays
+/// allocated with "fftwf_alloc_*" and must be executed with the
+/// new-array functions "fftwf_execute_dft_r2c" and
+/// "fftwf_execute_dft_c2r".  In-place transforms pad every real
+/// array to the size of its spectrum.
+///
+/// FFTW's wisdom is kept in a per-user cache file.  Plans that are
+/// not covered by wisdom are created with FFTW_ESTIMATE, which is
+/// fast, and measured on a background thread.  Measured plans are
+/// handed out to runners created afterwards and stay in the cache
+/// until the planner is deleted, so that re-creating runners (as
+/// in prepareToPlay) costs next to nothing.
+///
+class FftwPlanner :
+    private Thread
+{
+public:
+    FftwPlanner();
+    ~FftwPlanner();
+
+    fftwf_plan getPlan(const bool isInverse,
+                       const int fftSize,
+                       const int numberOfTransforms,
+                       const bool isInPlace);
+
+    void releasePlan(const fftwf_plan plan);
+
+    static File getWisdomFile();
+
+#if (defined (_WIN32) || defined (_WIN64))
+    float *(*fftwf_alloc_real)(size_t);
+    fftwf_complex *(*fftwf_alloc_complex)(size_t);
+    void (*fftwf_free)(void *);
+
+    fftwf_plan(*fftwf_plan_many_dft_r2c)(int, const int *, int, float *, const int *, int, int, fftwf_complex *, const int *, int, int, unsigned);
+    fftwf_plan(*fftwf_plan_many_dft_c2r)(int, const int *, int, fftwf_complex *, const int *, int, int, float *, const int *, int, int, unsigned);
+    void (*fftwf_destroy_plan)(fftwf_plan);
+
+    void (*fftwf_execute_dft_r2c)(const fftwf_plan, float *, fftwf_complex *);
+    void (*fftwf_execute_dft_c2r)(const fftwf_plan, fftwf_complex *, float *);
+
+    void (*fftwf_export_wisdom)(void (*)(char, void *), void *);
+    int (*fftwf_import_wisdom)(int (*)(void *), void *);
+#endif
+
+private:
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FftwPlanner);
+
+    struct PlanRequest
+    {
+        bool isInverse;
+        int fftSize;
+        int numberOfTransforms;
+        bool isInPlace;
+
+        bool operator==(const PlanRequest &other) const;
+    };
+
+    struct PlanEntry
+    {
+        PlanRequest request;
+        fftwf_plan plan;
+
+        int referenceCount;
+        bool isMeasured;
+    };
+
+    void run() override;
+
+    fftwf_plan createPlan(const PlanRequest &request,
+                          const unsigned flags);
+
+    int findPlanEntry(const PlanRequest &request) const;
+    bool measureNextPlan();
+
+    void importWisdom();
+    void exportWisdom();
+
+    // FFTW's planner is not thread-safe, so plans must not be created
+    // or destroyed by several threads at the same time; never lock
+    // "cacheLock_" while holding this lock
+    CriticalSection plannerLock_;
+
+    CriticalSection cacheLock_;
+    Array<PlanEntry> planEntries_;
+    Array<PlanRequest> pendingRequests_;
+
+#if (defined (_WIN32) || defined (_WIN64))
+    DynamicLibrary dynamicLibraryFFTW;
+#endif
+};
+
+}
+}
+
+#endif  // FRUT_DSP_FFTW_PLANNER_H
+
+#endif  // FRUT_DSP_USE_FFTW
@@ -30,102 +30,128 @@ namespace frut
 namespace dsp
 {
 
+/// Create a new FFTW runner.
+///
+/// @param numberOfChannels number of audio channels
+///
+/// @param fftBufferSize number of samples in a block
+///
+/// @param partitionSize number of samples in a partition; must
+///        divide "fftBufferSize".  Set to zero to convolve every block
+///        in one go.
+///
+/// @param kernelLength number of samples in filter kernel
+///        (partitioned convolution only; defaults to "fftBufferSize"
+///        plus one)
+///
 FftwRunner::FftwRunner(
     const int numberOfChannels,
-    const int fftBufferSize) :
+    const int fftBufferSize,
+    const int partitionSize,
+    const int kernelLength) :
 
+    filterKernel_FD_(nullptr),
     numberOfChannels_(numberOfChannels),
     fftBufferSize_(fftBufferSize),
-    fftSize_(fftBufferSize_ * 2),
+    partitionSize_((partitionSize > 0) ? partitionSize : fftBufferSize),
+    fftSize_(partitionSize_ * 2),
     halfFftSizePlusOne_(fftSize_ / 2 + 1),
+    batchStride_(halfFftSizePlusOne_ * 2),
+    isPartitioned_(partitionSize > 0),
+    kernelLength_(fftBufferSize + 1),
+    numberOfPartitions_(1),
     fftSampleBuffer_(numberOfChannels_, fftBufferSize_),
-    fftOverlapAddSamples_(numberOfChannels_, fftBufferSize_)
+    fftOverlapAddSamples_(numberOfChannels_, fftBufferSize_),
+    frequencyDelayLine_(nullptr)
 
 {
     jassert(numberOfChannels_ > 0);
+    jassert(fftBufferSize_ % partitionSize_ == 0);
 
-#if (defined (_WIN32) || defined (_WIN64))
-    File currentExecutableFile = File::getSpecialLocation(
-                                     File::currentExecutableFile);
-
-#ifdef _WIN64
-    File dynamicLibraryFftwFile = currentExecutableFile.getSiblingFile(
-                                      "kmeter/fftw/libfftw3f-3_x64.dll");
-#else
-    File dynamicLibraryFftwFile = currentExecutableFile.getSiblingFile(
-                                      "kmeter/fftw/libfftw3f-3.dll");
-#endif
-
-    String dynamicLibraryFftwPath = dynamicLibraryFftwFile.getFullPathName();
-    dynamicLibraryFFTW.open(dynamicLibraryFftwPath);
-
-    if (!dynamicLibraryFFTW.getNativeHandle())
+    if (isPartitioned_)
     {
-        NativeMessageBox::showMessageBox(
-            AlertWindow::WarningIcon,
-            "Missing library",
-            "Could not find the FFTW library at\n" + dynamicLibraryFftwPath,
-            nullptr);
+        if (kernelLength > 0)
+        {
+            kernelLength_ = kernelLength;
+        }
+
+        numberOfPartitions_ = (kernelLength_ + partitionSize_ - 1) /
+                              partitionSize_;
+
+        for (int channel = 0; channel < numberOfChannels_; ++channel)
+        {
+            frequencyDelayLineHeads_.add(0);
+        }
+
+        // current and previous input partition
+        partitionInputSamples_.setSize(numberOfChannels_, fftSize_);
+        partitionInputSamples_.clear();
     }
 
-    fftwf_alloc_real = (float * (*)(size_t)) dynamicLibraryFFTW.getFunction(
-                           "fftwf_alloc_real");
-    fftwf_alloc_complex = (fftwf_complex * (*)(size_t)) dynamicLibraryFFTW.getFunction(
-                              "fftwf_alloc_complex");
-    fftwf_free = (void (*)(void *)) dynamicLibraryFFTW.getFunction(
-                     "fftwf_free");
-
-    fftwf_plan_dft_r2c_1d = (fftwf_plan(*)(int, float *, fftwf_complex *, unsigned)) dynamicLibraryFFTW.getFunction(
-                                "fftwf_plan_dft_r2c_1d");
-    fftwf_plan_dft_c2r_1d = (fftwf_plan(*)(int, fftwf_complex *, float *, unsigned)) dynamicLibraryFFTW.getFunction(
-                                "fftwf_plan_dft_c2r_1d");
-    fftwf_destroy_plan = (void (*)(fftwf_plan)) dynamicLibraryFFTW.getFunction(
-                             "fftwf_destroy_plan");
+#if (defined (_WIN32) || defined (_WIN64))
+    // the planner loads the FFTW library
+    fftwf_alloc_real = fftwPlanner_->fftwf_alloc_real;
+    fftwf_alloc_complex = fftwPlanner_->fftwf_alloc_complex;
+    fftwf_free = fftwPlanner_->fftwf_free;
 
-    fftwf_execute = (void (*)(const fftwf_plan)) dynamicLibraryFFTW.getFunction(
-                        "fftwf_execute");
+    fftwf_execute_dft_r2c = fftwPlanner_->fftwf_execute_dft_r2c;
+    fftwf_execute_dft_c2r = fftwPlanner_->fftwf_execute_dft_c2r;
 #endif
 
-    filterKernel_TD_ = fftwf_alloc_real(fftSize_);
-    filterKernel_FD_ = fftwf_alloc_complex(halfFftSizePlusOne_);
-
-    filterKernelPlan_DFT_ = fftwf_plan_dft_r2c_1d(
-                                fftSize_, filterKernel_TD_, filterKernel_FD_,
-                                FFTW_MEASURE);
-
+    // plans are shared with all other runners of the same size
     audioSamples_TD_ = fftwf_alloc_real(fftSize_);
     audioSamples_FD_ = fftwf_alloc_complex(halfFftSizePlusOne_);
 
-    audioSamplesPlan_DFT_ = fftwf_plan_dft_r2c_1d(
-                                fftSize_, audioSamples_TD_, audioSamples_FD_,
-                                FFTW_MEASURE);
-    audioSamplesPlan_IDFT_ = fftwf_plan_dft_c2r_1d(
-                                 fftSize_, audioSamples_FD_, audioSamples_TD_,
-                                 FFTW_MEASURE);
+    audioSamplesPlan_DFT_ = fftwPlanner_->getPlan(false, fftSize_, 1, false);
+    audioSamplesPlan_IDFT_ = fftwPlanner_->getPlan(true, fftSize_, 1, false);
+
+    // in-place transforms of all channels; every real input array is
+    // padded to the size of its spectrum
+    batchSamples_FD_ = fftwf_alloc_complex(
+                           numberOfChannels_ * halfFftSizePlusOne_);
+    batchSamples_TD_ = reinterpret_cast<float *>(batchSamples_FD_);
+
+    batchSamplesPlan_DFT_ = fftwPlanner_->getPlan(
+                                false, fftSize_, numberOfChannels_, true);
+    batchSamplesPlan_IDFT_ = fftwPlanner_->getPlan(
+                                 true, fftSize_, numberOfChannels_, true);
+
+    if (isPartitioned_)
+    {
+        int partitionSpectraSize = numberOfPartitions_ * halfFftSizePlusOne_;
+
+        frequencyDelayLine_ = fftwf_alloc_complex(
+                                  numberOfChannels_ * partitionSpectraSize);
+
+        memset(frequencyDelayLine_, 0,
+               numberOfChannels_ * partitionSpectraSize * sizeof(fftwf_complex));
+    }
 }
 
 
 FftwRunner::~FftwRunner()
 {
-    fftwf_destroy_plan(filterKernelPlan_DFT_);
-    fftwf_free(filterKernel_TD_);
-    fftwf_free(filterKernel_FD_);
-
-    fftwf_destroy_plan(audioSamplesPlan_DFT_);
-    fftwf_destroy_plan(audioSamplesPlan_IDFT_);
+    fftwPlanner_->releasePlan(audioSamplesPlan_DFT_);
+    fftwPlanner_->releasePlan(audioSamplesPlan_IDFT_);
     fftwf_free(audioSamples_TD_);
     fftwf_free(audioSamples_FD_);
 
+    fftwPlanner_->releasePlan(batchSamplesPlan_DFT_);
+    fftwPlanner_->releasePlan(batchSamplesPlan_IDFT_);
+    fftwf_free(batchSamples_FD_);
+
+    if (isPartitioned_)
+    {
+        fftwf_free(frequencyDelayLine_);
+    }
+
 #if (defined (_WIN32) || defined (_WIN64))
     fftwf_alloc_real = nullptr;
     fftwf_alloc_complex = nullptr;
     fftwf_free = nullptr;
 
-    fftwf_plan_dft_r2c_1d = nullptr;
-    fftwf_plan_dft_c2r_1d = nullptr;
-    fftwf_destroy_plan = nullptr;
-
-    fftwf_execute = nullptr;
+    fftwf_execute_dft_r2c = nullptr;
+    fftwf_execute_dft_c2r = nullptr;
 #endif
 }
 
@@ -134,20 +160,203 @@ void FftwRunner::reset()
 {
     fftSampleBuffer_.clear();
     fftOverlapAddSamples_.clear();
+
+    if (isPartitioned_)
+    {
+        partitionInputSamples_.clear();
+
+        memset(frequencyDelayLine_, 0,
+               numberOfChannels_ * numberOfPartitions_ *
+               halfFftSizePlusOne_ * sizeof(fftwf_complex));
+    }
 }
 
 
-// "oversamplingRate" is needed for normalising the synthesised audio
-// data during oversampling only and should be left alone in any other
-// case
-void FftwRunner::convolveWithKernel(
+/// Find out whether blocks are split into partitions.
+///
+/// @return **true** if convolution is partitioned
+///
+bool FftwRunner::isPartitioned() const
+{
+    return isPartitioned_;
+}
+
+
+/// Get number of samples in a partition.
+///
+/// @return partition size (equals the block size for unpartitioned
+///         convolution)
+///
+int FftwRunner::getPartitionSize() const
+{
+    return partitionSize_;
+}
+
+
+/// Get number of samples in filter kernel.
+///
+/// @return kernel length
+///
+int FftwRunner::getKernelLength() const
+{
+    return kernelLength_;
+}
+
+
+/// Get key that identifies a kernel spectrum in the cache.
+///
+/// @param kernelName unique description of the time-domain kernel
+///        (type and parameters)
+///
+/// @return key for KernelSpectrumCache
+///
+String FftwRunner::getKernelKey(
+    const String &kernelName) const
+{
+    // runners with the same FFT size, kernel length and number of
+    // partitions compute identical spectra
+    return kernelName + " | FFT size " + String(fftSize_) +
+           " | kernel length " + String(kernelLength_) +
+           " | partitions " + String(isPartitioned_ ? numberOfPartitions_ : 0);
+}
+
+
+/// Use a kernel spectrum that has already been calculated by this or
+/// another runner.  **Not real-time safe.**
+///
+/// @param kernelName unique description of the time-domain kernel
+///
+/// @return **true** if the spectrum was found
+///
+bool FftwRunner::loadKernelSpectrum(
+    const String &kernelName)
+{
+    String kernelKey = getKernelKey(kernelName);
+
+    if (kernelSpectrum_ && (kernelSpectrum_->key == kernelKey))
+    {
+        return true;
+    }
+
+    auto kernelSpectrum = kernelSpectrumCache_->find(kernelKey);
+
+    if (!kernelSpectrum)
+    {
+        return false;
+    }
+
+    kernelSpectrum_ = kernelSpectrum;
+    filterKernel_FD_ = kernelSpectrum_->values.get();
+
+    return true;
+}
+
+
+/// Calculate spectrum of a filter kernel and share it with other
+/// runners.  The spectrum is scaled so that the inverse transform
+/// needs no further normalisation.  **Not real-time safe** (with or
+/// without partitions, as it allocates memory); filters call it from
+/// their constructors, i.e. from prepareToPlay().
+///
+/// @param kernelSamples filter kernel with "kernelLength_" samples
+///
+/// @param kernelName unique description of the time-domain kernel
+///
+void FftwRunner::transformKernel(
+    const float *kernelSamples,
+    const String &kernelName)
+{
+    auto kernelSpectrum = std::make_shared<KernelSpectrumCache::Spectrum>(
+                              getKernelKey(kernelName),
+                              numberOfPartitions_ * halfFftSizePlusOne_);
+
+    // temporary arrays that are aligned like those the plan was
+    // created for
+    float *kernel_TD = fftwf_alloc_real(fftSize_);
+    fftwf_complex *kernel_FD = fftwf_alloc_complex(halfFftSizePlusOne_);
+
+    // FFTW does not normalise its transforms
+    float normaliser = 1.0f / float(fftSize_);
+
+    for (int partition = 0; partition < numberOfPartitions_; ++partition)
+    {
+        int startSample = partition * partitionSize_;
+        int numberOfSamples = isPartitioned_ ?
+                              jmin(partitionSize_, kernelLength_ - startSample) :
+                              kernelLength_;
+
+        // copy partition and pad with zeros
+        for (int i = 0; i < fftSize_; ++i)
+        {
+            kernel_TD[i] = (i < numberOfSamples) ?
+                           kernelSamples[startSample + i] : 0.0f;
+        }
+
+        // calculate DFT of filter kernel
+        fftwf_execute_dft_r2c(audioSamplesPlan_DFT_, kernel_TD, kernel_FD);
+
+        FloatVectorOperations::multiply(
+            reinterpret_cast<float *>(kernel_FD),
+            normaliser, 2 * halfFftSizePlusOne_);
+
+        memcpy(kernelSpectrum->values + partition * halfFftSizePlusOne_,
+               kernel_FD,
+               halfFftSizePlusOne_ * sizeof(fftwf_complex));
+    }
+
+    fftwf_free(kernel_TD);
+    fftwf_free(kernel_FD);
+
+    // another runner may have added the same spectrum in the meantime
+    kernelSpectrum_ = kernelSpectrumCache_->add(kernelSpectrum);
+    filterKernel_FD_ = kernelSpectrum_->values.get();
+}
+
+
+// multiply spectrum of audio data with (unpartitioned) kernel
+void FftwRunner::multiplyWithKernel(
+    fftwf_complex *samples_FD,
+    const fftwf_complex *kernel_FD)
+{
+    jassert(kernel_FD != nullptr);
+
+    ComplexVectorOperations::multiply(
+        reinterpret_cast<float *>(samples_FD),
+        reinterpret_cast<const float *>(kernel_FD),
+        halfFftSizePlusOne_);
+}
+
+
+// add old overlapping samples to the first half of the convolved
+// block and store its second half for the next block (single pass)
+void FftwRunner::addOverlappingSamples(
     const int channel,
-    const float oversamplingRate)
+    const float *convolvedSamples)
+{
+    float *samples = fftSampleBuffer_.getWritePointer(channel);
+    float *overlapAddSamples = fftOverlapAddSamples_.getWritePointer(channel);
+
+    for (int i = 0; i < fftBufferSize_; ++i)
+    {
+        samples[i] = convolvedSamples[i] + overlapAddSamples[i];
+        overlapAddSamples[i] = convolvedSamples[fftBufferSize_ + i];
+    }
+}
+
+
+void FftwRunner::convolveWithKernel(
+    const int channel)
 
 {
     jassert(channel >= 0);
     jassert(channel < numberOfChannels_);
 
+    if (isPartitioned_)
+    {
+        convolveWithPartitionedKernel(channel);
+        return;
+    }
+
     // copy audio data to temporary buffer as the sample buffer is not
     // optimised for MME
     memcpy(audioSamples_TD_,
@@ -161,45 +370,234 @@ void FftwRunner::convolveWithKernel(
     }
 
     // calculate DFT of audio data
-    fftwf_execute(audioSamplesPlan_DFT_);
+    fftwf_execute_dft_r2c(audioSamplesPlan_DFT_,
+                          audioSamples_TD_, audioSamples_FD_);
+
+    // convolve audio data with (normalised) filter kernel
+    multiplyWithKernel(audioSamples_FD_, filterKernel_FD_);
+
+    // synthesise audio data from frequency spectrum (this destroys the
+    // contents of "audioSamples_FD_"!!!)
+    fftwf_execute_dft_c2r(audioSamplesPlan_IDFT_,
+                          audioSamples_FD_, audioSamples_TD_);
+
+    addOverlappingSamples(channel, audioSamples_TD_);
+}
+
+
+// uniformly partitioned overlap-save convolution
+void FftwRunner::convolveWithPartitionedKernel(
+    const int channel)
+{
+    float *samples = fftSampleBuffer_.getWritePointer(channel);
+    float *inputSamples = partitionInputSamples_.getWritePointer(channel);
+
+    int delayLineSize = numberOfPartitions_ * halfFftSizePlusOne_;
+    fftwf_complex *delayLine = frequencyDelayLine_ + channel * delayLineSize;
+    int delayLineHead = frequencyDelayLineHeads_[channel];
 
-    // convolve audio data with filter kernel
-    for (int i = 0; i < halfFftSizePlusOne_; ++i)
+    for (int offset = 0; offset < fftBufferSize_; offset += partitionSize_)
     {
-        // multiplication of complex numbers: index 0 contains the real
-        // part, index 1 the imaginary part
-        float realPart = audioSamples_FD_[i][0] * filterKernel_FD_[i][0] -
-                         audioSamples_FD_[i][1] * filterKernel_FD_[i][1];
-        float imagPart = audioSamples_FD_[i][1] * filterKernel_FD_[i][0] +
-                         audioSamples_FD_[i][0] * filterKernel_FD_[i][1];
+        // slide input by one partition (previous partition followed
+        // by current one)
+        memmove(inputSamples, inputSamples + partitionSize_,
+                partitionSize_ * sizeof(float));
+        memcpy(inputSamples + partitionSize_, samples + offset,
+               partitionSize_ * sizeof(float));
+
+        memcpy(audioSamples_TD_, inputSamples,
+               fftSize_ * sizeof(float));
+
+        // calculate DFT of input and store it in delay line
+        fftwf_execute_dft_r2c(audioSamplesPlan_DFT_,
+                              audioSamples_TD_, audioSamples_FD_);
+
+        delayLineHead = (delayLineHead + 1) % numberOfPartitions_;
+
+        memcpy(delayLine + delayLineHead * halfFftSizePlusOne_,
+               audioSamples_FD_,
+               halfFftSizePlusOne_ * sizeof(fftwf_complex));
+
+        // multiply-accumulate spectra of past input partitions with
+        // spectra of (normalised) kernel partitions
+        FloatVectorOperations::clear(
+            reinterpret_cast<float *>(audioSamples_FD_),
+            2 * halfFftSizePlusOne_);
+
+        for (int partition = 0; partition < numberOfPartitions_; ++partition)
+        {
+            int slot = delayLineHead - partition;
+
+            if (slot < 0)
+            {
+                slot += numberOfPartitions_;
+            }
+
+            const fftwf_complex *inputSpectrum = delayLine + slot * halfFftSizePlusOne_;
+            const fftwf_complex *kernelSpectrum = filterKernel_FD_ + partition * halfFftSizePlusOne_;
+
+            ComplexVectorOperations::multiplyAdd(
+                reinterpret_cast<float *>(audioSamples_FD_),
+                reinterpret_cast<const float *>(inputSpectrum),
+                reinterpret_cast<const float *>(kernelSpectrum),
+                halfFftSizePlusOne_);
+        }
+
+        // synthesise audio data from frequency spectrum (this destroys
+        // the contents of "audioSamples_FD_"!!!)
+        fftwf_execute_dft_c2r(audioSamplesPlan_IDFT_,
+                              audioSamples_FD_, audioSamples_TD_);
+
+        // the second half contains the valid (non-circular) part of
+        // the convolution
+        memcpy(samples + offset, audioSamples_TD_ + partitionSize_,
+               partitionSize_ * sizeof(float));
+    }
+
+    frequencyDelayLineHeads_.set(channel, delayLineHead);
+}
+
 
-        audioSamples_FD_[i][0] = realPart;
-        audioSamples_FD_[i][1] = imagPart;
+// convolve all channels using batched transforms
+void FftwRunner::convolveAllChannelsWithKernel()
+{
+    if (isPartitioned_)
+    {
+        convolveAllChannelsWithPartitionedKernel();
+        return;
     }
 
-    // synthesise audio data from frequency spectrum (this destroys the
-    // contents of "audioSamples_FD_"!!!)
-    fftwf_execute(audioSamplesPlan_IDFT_);
+    for (int channel = 0; channel < numberOfChannels_; ++channel)
+    {
+        float *channelSamples_TD = batchSamples_TD_ + channel * batchStride_;
+
+        memcpy(channelSamples_TD,
+               fftSampleBuffer_.getReadPointer(channel),
+               fftBufferSize_ * sizeof(float));
+
+        // pad audio data with zeros
+        for (int sample = fftBufferSize_; sample < fftSize_; ++sample)
+        {
+            channelSamples_TD[sample] = 0.0f;
+        }
+    }
+
+    // calculate DFT of audio data
+    fftwf_execute_dft_r2c(batchSamplesPlan_DFT_,
+                          batchSamples_TD_, batchSamples_FD_);
 
-    // normalise synthesised audio data
-    float normaliser = float(fftSize_ / oversamplingRate);
+    // convolve audio data with (normalised) filter kernel; the kernel
+    // spectrum is re-used for every channel and thus stays in the
+    // cache
+    for (int channel = 0; channel < numberOfChannels_; ++channel)
+    {
+        multiplyWithKernel(batchSamples_FD_ + channel * halfFftSizePlusOne_,
+                           filterKernel_FD_);
+    }
 
-    for (int i = 0; i < fftSize_; ++i)
+    // synthesise audio data from frequency spectrum
+    fftwf_execute_dft_c2r(batchSamplesPlan_IDFT_,
+                          batchSamples_FD_, batchSamples_TD_);
+
+    for (int channel = 0; channel < numberOfChannels_; ++channel)
     {
-        audioSamples_TD_[i] = audioSamples_TD_[i] / normaliser;
+        addOverlappingSamples(channel,
+                              batchSamples_TD_ + channel * batchStride_);
     }
+}
 
-    // copy data from temporary buffer back to sample buffer
-    fftSampleBuffer_.copyFrom(channel, 0, audioSamples_TD_,
-                              fftBufferSize_);
 
-    // add old overlapping samples
-    fftSampleBuffer_.addFrom(channel, 0, fftOverlapAddSamples_,
-                             channel, 0, fftBufferSize_);
+// batched version of convolveWithPartitionedKernel()
+void FftwRunner::convolveAllChannelsWithPartitionedKernel()
+{
+    int delayLineSize = numberOfPartitions_ * halfFftSizePlusOne_;
 
-    // store new overlapping samples
-    fftOverlapAddSamples_.copyFrom(channel, 0, audioSamples_TD_ + fftBufferSize_,
-                                   fftBufferSize_);
+    for (int offset = 0; offset < fftBufferSize_; offset += partitionSize_)
+    {
+        for (int channel = 0; channel < numberOfChannels_; ++channel)
+        {
+            const float *samples = fftSampleBuffer_.getReadPointer(channel);
+            float *inputSamples = partitionInputSamples_.getWritePointer(channel);
+
+            // slide input by one partition (previous partition
+            // followed by current one)
+            memmove(inputSamples, inputSamples + partitionSize_,
+                    partitionSize_ * sizeof(float));
+            memcpy(inputSamples + partitionSize_, samples + offset,
+                   partitionSize_ * sizeof(float));
+
+            memcpy(batchSamples_TD_ + channel * batchStride_, inputSamples,
+                   fftSize_ * sizeof(float));
+        }
+
+        // calculate DFT of input
+        fftwf_execute_dft_r2c(batchSamplesPlan_DFT_,
+                              batchSamples_TD_, batchSamples_FD_);
+
+        for (int channel = 0; channel < numberOfChannels_; ++channel)
+        {
+            fftwf_complex *channelSamples_FD = batchSamples_FD_ +
+                                               channel * halfFftSizePlusOne_;
+
+            fftwf_complex *delayLine = frequencyDelayLine_ + channel * delayLineSize;
+            int delayLineHead = (frequencyDelayLineHeads_[channel] + 1) %
+                                numberOfPartitions_;
+
+            // store spectrum of input in delay line
+            memcpy(delayLine + delayLineHead * halfFftSizePlusOne_,
+                   channelSamples_FD,
+                   halfFftSizePlusOne_ * sizeof(fftwf_complex));
+
+            frequencyDelayLineHeads_.set(channel, delayLineHead);
+
+            FloatVectorOperations::clear(
+                reinterpret_cast<float *>(channelSamples_FD),
+                2 * halfFftSizePlusOne_);
+        }
+
+        // multiply-accumulate spectra of past input partitions with
+        // spectra of (normalised) kernel partitions; every kernel
+        // partition is applied to all channels while it is in the
+        // cache
+        for (int partition = 0; partition < numberOfPartitions_; ++partition)
+        {
+            const fftwf_complex *kernelSpectrum = filterKernel_FD_ + partition * halfFftSizePlusOne_;
+
+            for (int channel = 0; channel < numberOfChannels_; ++channel)
+            {
+                fftwf_complex *channelSamples_FD = batchSamples_FD_ +
+                                                   channel * halfFftSizePlusOne_;
+
+                int slot = frequencyDelayLineHeads_[channel] - partition;
+
+                if (slot < 0)
+                {
+                    slot += numberOfPartitions_;
+                }
+
+                const fftwf_complex *inputSpectrum = frequencyDelayLine_ + channel * delayLineSize + slot * halfFftSizePlusOne_;
+
+                ComplexVectorOperations::multiplyAdd(
+                    reinterpret_cast<float *>(channelSamples_FD),
+                    reinterpret_cast<const float *>(inputSpectrum),
+                    reinterpret_cast<const float *>(kernelSpectrum),
+                    halfFftSizePlusOne_);
+            }
+        }
+
+        // synthesise audio data from frequency spectrum
+        fftwf_execute_dft_c2r(batchSamplesPlan_IDFT_,
+                              batchSamples_FD_, batchSamples_TD_);
+
+        // the second half contains the valid (non-circular) part of
+        // the convolution
+        for (int channel = 0; channel < numberOfChannels_; ++channel)
+        {
+            memcpy(fftSampleBuffer_.getWritePointer(channel) + offset,
+                   batchSamples_TD_ + channel * batchStride_ + partitionSize_,
+                   partitionSize_ * sizeof(float));
+        }
+    }
 }
 
 }
@@ -33,49 +33,108 @@ namespace frut
 namespace dsp
 {
 
+/// Convolves blocks of audio with a filter kernel using FFTW.
+///
+/// By default, every block of "fftBufferSize" samples is convolved
+/// in one go (overlap-add), which ties the length of the kernel to
+/// the block size.  When a partition size is given, blocks are
+/// split into partitions of that size instead and the kernel may
+/// have any length.  Its partitions are transformed once, and the
+/// spectra of past input partitions are kept in a frequency-domain
+/// delay line (uniformly partitioned overlap-save convolution).  The
+/// cost per sample then only depends on the partition size and the
+/// length of the kernel.
+///
+/// convolveAllChannelsWithKernel() transforms all channels at once
+/// using batched FFTW plans, which saves plan dispatches and keeps
+/// the kernel spectrum in the cache while it is applied to the
+/// channels.  Prefer it to calling convolveWithKernel() for every
+/// channel.
+///
+/// Plans are obtained from FftwPlanner and kernel spectra from
+/// KernelSpectrumCache; both are shared with all other runners in
+/// the process.
+///
 class FftwRunner
 {
 public:
     FftwRunner(const int numberOfChannels,
-               const int fftBufferSize);
+               const int fftBufferSize,
+               const int partitionSize = 0,
+               const int kernelLength = 0);
 
     virtual ~FftwRunner();
 
     virtual void reset();
-    void convolveWithKernel(const int channel,
-                            const float oversamplingRate = 1.0f);
+    void convolveWithKernel(const int channel);
+    void convolveAllChannelsWithKernel();
+
+    bool isPartitioned() const;
+    int getPartitionSize() const;
+    int getKernelLength() const;
 
 protected:
-    DynamicLibrary dynamicLibraryFFTW;
+    String getKernelKey(const String &kernelName) const;
+    bool loadKernelSpectrum(const String &kernelName);
+    void transformKernel(const float *kernelSamples,
+                         const String &kernelName);
+
+    void convolveWithPartitionedKernel(const int channel);
+    void convolveAllChannelsWithPartitionedKernel();
+
+    void multiplyWithKernel(fftwf_complex *samples_FD,
+                            const fftwf_complex *kernel_FD);
+    void addOverlappingSamples(const int channel,
+                               const float *convolvedSamples);
+
+    SharedResourcePointer<FftwPlanner> fftwPlanner_;
+    SharedResourcePointer<KernelSpectrumCache> kernelSpectrumCache_;
 
-    float *filterKernel_TD_;
-    fftwf_complex *filterKernel_FD_;
-    fftwf_plan filterKernelPlan_DFT_;
+    // spectra of all kernel partitions (a single one unless
+    // partitioned), shared with other runners and never changed
+    std::shared_ptr<const KernelSpectrumCache::Spectrum> kernelSpectrum_;
+    const fftwf_complex *filterKernel_FD_;
 
     float *audioSamples_TD_;
     fftwf_complex *audioSamples_FD_;
     fftwf_plan audioSamplesPlan_DFT_;
     fftwf_plan audioSamplesPlan_IDFT_;
 
+    // all channels, transformed in place ("batchSamples_TD_" and
+    // "batchSamples_FD_" share their memory); every channel occupies
+    // "batchStride_" floats
+    float *batchSamples_TD_;
+    fftwf_complex *batchSamples_FD_;
+    fftwf_plan batchSamplesPlan_DFT_;
+    fftwf_plan batchSamplesPlan_IDFT_;
+
     int numberOfChannels_;
     int fftBufferSize_;
+    int partitionSize_;
 
     int fftSize_;
     int halfFftSizePlusOne_;
+    int batchStride_;
+
+    bool isPartitioned_;
+    int kernelLength_;
+    int numberOfPartitions_;
 
     AudioBuffer<float> fftSampleBuffer_;
     AudioBuffer<float> fftOverlapAddSamples_;
 
+    // frequency-domain delay line (partitioned convolution only)
+    fftwf_complex *frequencyDelayLine_;
+    Array<int> frequencyDelayLineHeads_;
+    AudioBuffer<float> partitionInputSamples_;
+
 #if (defined (_WIN32) || defined (_WIN64))
     float *(*fftwf_alloc_real)(size_t);
     fftwf_complex *(*fftwf_alloc_complex)(size_t);
     void (*fftwf_free)(void *);
 
-    fftwf_plan(*fftwf_plan_dft_r2c_1d)(int, float *, fftwf_complex *, unsigned);
-    fftwf_plan(*fftwf_plan_dft_c2r_1d)(int, fftwf_complex *, float *, unsigned);
-    void (*fftwf_destroy_plan)(fftwf_plan);
-
-    void (*fftwf_execute)(const fftwf_plan);
+    void (*fftwf_execute_dft_r2c)(const fftwf_plan, float *, fftwf_complex *);
+    void (*fftwf_execute_dft_c2r)(const fftwf_plan, fftwf_complex *, float *);
 #endif
 
 private:
@@ -30,11 +30,17 @@ namespace frut
 namespace dsp
 {
 
+/// Create a new FIR filter box.  See FftwRunner for a description
+/// of the parameters.
+///
 FIRFilterBox::FIRFilterBox(
     const int numberOfChannels,
-    const int fftBufferSize) :
+    const int fftBufferSize,
+    const int partitionSize,
+    const int kernelLength) :
 
-    frut::dsp::FftwRunner(numberOfChannels, fftBufferSize)
+    frut::dsp::FftwRunner(numberOfChannels, fftBufferSize,
+                          partitionSize, kernelLength)
 {
 }
 
@@ -50,50 +56,59 @@ void FIRFilterBox::reset()
 }
 
 
-// calculate filter kernel for windowed-sinc low-pass filter
+// calculate filter kernel for windowed-sinc low-pass filter;
+// "gain" is the gain at DC (use the upsampling factor for
+// interpolation filters)
 void FIRFilterBox::calculateKernelWindowedSincLPF(
-    const double relativeCutoffFrequency)
+    const double relativeCutoffFrequency,
+    const double gain)
 {
-    int samples = fftBufferSize_ + 1;
+    String kernelName = "windowed-sinc low-pass (cutoff " +
+                        String(relativeCutoffFrequency, 17) + ", gain " +
+                        String(gain, 17) + ")";
+
+    // kernel spectra are shared by all runners of the same size
+    if (loadKernelSpectrum(kernelName))
+    {
+        return;
+    }
+
+    int samples = kernelLength_;
     double samplesHalf = samples / 2.0;
 
+    HeapBlock<float> filterKernelSamples(samples);
+
     // calculate filter kernel
     for (int i = 0; i < samples; ++i)
     {
         if (i == samplesHalf)
         {
-            filterKernel_TD_[i] = static_cast<float>(
-                                      2.0 * M_PI * relativeCutoffFrequency);
+            filterKernelSamples[i] = static_cast<float>(
+                                         2.0 * M_PI * relativeCutoffFrequency);
         }
         else
         {
-            filterKernel_TD_[i] = static_cast<float>(
-                                      sin(2.0 * M_PI * relativeCutoffFrequency * (i - samplesHalf)) / (i - samplesHalf) * (0.42 - 0.5 * cos(2.0 * M_PI * i / samples) + 0.08 * cos(4.0 * M_PI * i / samples)));
+            filterKernelSamples[i] = static_cast<float>(
+                                         sin(2.0 * M_PI * relativeCutoffFrequency * (i - samplesHalf)) / (i - samplesHalf) * (0.42 - 0.5 * cos(2.0 * M_PI * i / samples) + 0.08 * cos(4.0 * M_PI * i / samples)));
         }
     }
 
-    // normalise filter kernel for unity gain at DC
+    // normalise filter kernel to the given gain at DC
     double kernelSum = 0.0;
 
     for (int i = 0; i < samples; ++i)
     {
-        kernelSum += filterKernel_TD_[i];
+        kernelSum += filterKernelSamples[i];
     }
 
     for (int i = 0; i < samples; ++i)
     {
-        filterKernel_TD_[i] = static_cast<float>(
-                                  filterKernel_TD_[i] / kernelSum);
-    }
-
-    // pad filter kernel with zeros
-    for (int i = samples; i < fftSize_; ++i)
-    {
-        filterKernel_TD_[i] = 0.0f;
+        filterKernelSamples[i] = static_cast<float>(
+                                     gain * filterKernelSamples[i] / kernelSum);
     }
 
-    // calculate DFT of filter kernel
-    fftwf_execute(filterKernelPlan_DFT_);
+    // calculate spectrum of filter kernel
+    transformKernel(filterKernelSamples, kernelName);
 }
 
 }
@@ -38,13 +38,16 @@ class FIRFilterBox :
 {
 public:
     FIRFilterBox(const int numberOfChannels,
-                 const int fftBufferSize);
+                 const int fftBufferSize,
+                 const int partitionSize = 0,
+                 const int kernelLength = 0);
 
     virtual ~FIRFilterBox();
 
     virtual void reset();
     void calculateKernelWindowedSincLPF(
-        const double relativeCutoffFrequency);
+        const double relativeCutoffFrequency,
+        const double gain = 1.0);
 
 private:
     JUCE_LEAK_DETECTOR(FIRFilterBox);
@@ -0,0 +1,115 @@
+/* ----------------------------------------------------------------------------
+
+   FrutJUCE
+   ========
+   Common classes for use with the JUCE library
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+#if FRUT_DSP_USE_FFTW
+
+namespace frut
+{
+namespace dsp
+{
+
+/// Create a new (zeroed) kernel spectrum.
+///
+/// @param key unique description of kernel and transform
+///
+/// @param numberOfValues number of complex values
+///
+KernelSpectrumCache::Spectrum::Spectrum(
+    const String &key,
+    const int numberOfValues) :
+
+    key(key)
+{
+    values.calloc(static_cast<size_t>(numberOfValues));
+}
+
+
+KernelSpectrumCache::KernelSpectrumCache()
+{
+}
+
+
+/// Find a spectrum in the cache.  **Not real-time safe.**
+///
+/// @param key unique description of kernel and transform
+///
+/// @return spectrum, or **nullptr** if the cache does not contain it
+///
+std::shared_ptr<const KernelSpectrumCache::Spectrum> KernelSpectrumCache::find(
+    const String &key)
+{
+    const ScopedLock lock(cacheLock_);
+
+    for (auto &entry : entries_)
+    {
+        if (entry.key == key)
+        {
+            // may be empty if the spectrum has just been freed
+            return entry.spectrum.lock();
+        }
+    }
+
+    return nullptr;
+}
+
+
+/// Add a spectrum to the cache.  If another thread has added a
+/// spectrum with the same key in the meantime, that one is returned
+/// instead.  **Not real-time safe.**
+///
+/// @param spectrum new spectrum; must not be changed afterwards
+///
+/// @return spectrum to be used
+///
+std::shared_ptr<const KernelSpectrumCache::Spectrum> KernelSpectrumCache::add(
+    std::shared_ptr<const Spectrum> spectrum)
+{
+    const ScopedLock lock(cacheLock_);
+
+    // remove entries of freed spectra
+    for (int index = entries_.size() - 1; index >= 0; --index)
+    {
+        auto &entry = entries_.getReference(index);
+        auto cachedSpectrum = entry.spectrum.lock();
+
+        if (!cachedSpectrum)
+        {
+            entries_.remove(index);
+        }
+        else if (entry.key == spectrum->key)
+        {
+            return cachedSpectrum;
+        }
+    }
+
+    entries_.add({spectrum->key, spectrum});
+
+    return spectrum;
+}
+
+}
+}
+
+#endif  // FRUT_DSP_USE_FFTW
@@ -0,0 +1,82 @@
+/* ----------------------------------------------------------------------------
+
+   FrutJUCE
+   ========
+   Common classes for use with the JUCE library
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+#if FRUT_DSP_USE_FFTW
+
+#ifndef FRUT_DSP_KERNEL_SPECTRUM_CACHE_H
+#define FRUT_DSP_KERNEL_SPECTRUM_CACHE_H
+
+namespace frut
+{
+namespace dsp
+{
+
+/// Process-wide cache of filter kernel spectra.  Obtain it through a
+/// SharedResourcePointer, so that all runners in a process share
+/// their spectra.
+///
+/// Spectra are immutable once they have been added and are
+/// reference-counted: the cache only keeps weak references, so a
+/// spectrum is freed as soon as the last runner using it has gone.
+///
+class KernelSpectrumCache
+{
+public:
+    /// Spectrum of a filter kernel (all partitions in a row).
+    struct Spectrum
+    {
+        Spectrum(const String &key,
+                 const int numberOfValues);
+
+        const String key;
+        HeapBlock<fftwf_complex> values;
+
+        JUCE_DECLARE_NON_COPYABLE(Spectrum);
+    };
+
+    KernelSpectrumCache();
+
+    std::shared_ptr<const Spectrum> find(const String &key);
+    std::shared_ptr<const Spectrum> add(std::shared_ptr<const Spectrum> spectrum);
+
+private:
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(KernelSpectrumCache);
+
+    struct Entry
+    {
+        String key;
+        std::weak_ptr<const Spectrum> spectrum;
+    };
+
+    CriticalSection cacheLock_;
+    Array<Entry> entries_;
+};
+
+}
+}
+
+#endif  // FRUT_DSP_KERNEL_SPECTRUM_CACHE_H
+
+#endif  // FRUT_DSP_USE_FFTW
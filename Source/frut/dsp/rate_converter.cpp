@@ -73,7 +73,9 @@ void RateConverter::calculateFilterKernel()
     // (8 * 1024) and an initial sampling rate of 44100 Hz
     double relativeCutoffFrequency = 0.5 / upsamplingFactor_;
 
-    calculateKernelWindowedSincLPF(relativeCutoffFrequency);
+    // the gain compensates for the zeros inserted during upsampling
+    calculateKernelWindowedSincLPF(relativeCutoffFrequency,
+                                   upsamplingFactor_);
 }
 
 
@@ -98,10 +100,7 @@ void RateConverter::upsample()
     }
 
     // filter audio data (overwrites contents of sample buffer)
-    for (int channel = 0; channel < numberOfChannels_; ++channel)
-    {
-        convolveWithKernel(channel, static_cast<float>(upsamplingFactor_));
-    }
+    convolveAllChannelsWithKernel();
 }
 
 }
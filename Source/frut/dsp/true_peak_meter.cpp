@@ -39,6 +39,10 @@ TruePeakMeter::TruePeakMeter(
                              originalFftBufferSize,
                              upsamplingFactor)
 {
+    for (int channel = 0; channel < numberOfChannels_; ++channel)
+    {
+        truePeakLevels_.add(0.0f);
+    }
 }
 
 
@@ -51,7 +55,8 @@ void TruePeakMeter::reset()
 {
     RateConverter::reset();
 
-    truePeakLevels_.clear();
+    // do not clear array to avoid re-allocation on the audio thread
+    truePeakLevels_.fill(0.0f);
 }
 
 
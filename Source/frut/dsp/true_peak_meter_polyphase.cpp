@@ -0,0 +1,292 @@
+/* ----------------------------------------------------------------------------
+
+   FrutJUCE
+   ========
+   Common classes for use with the JUCE library
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+namespace frut
+{
+namespace dsp
+{
+
+namespace
+{
+
+// modified Bessel function of the first kind (order zero), needed
+// for the Kaiser window
+double besselI0(
+    const double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+
+    for (int k = 1; k < 50; ++k)
+    {
+        double factor = x / (2.0 * k);
+        term *= factor * factor;
+        sum += term;
+
+        if (term < 1e-12 * sum)
+        {
+            break;
+        }
+    }
+
+    return sum;
+}
+
+}
+
+
+/// Create a new polyphase true peak meter.
+///
+/// @param numberOfChannels number of audio channels
+///
+/// @param bufferSize maximum number of samples that will be passed
+///        to copyFrom() at once
+///
+/// @param upsamplingFactor oversampling factor (number of phases)
+///
+TruePeakMeterPolyphase::TruePeakMeterPolyphase(
+    const int numberOfChannels,
+    const int bufferSize,
+    const int upsamplingFactor) :
+
+    numberOfChannels_(numberOfChannels),
+    bufferSize_(bufferSize),
+    upsamplingFactor_(upsamplingFactor),
+    tapsPerPhase_((upsamplingFactor == 4) ?
+                  annexTapsPerPhase_ : sincTapsPerPhase_),
+    historySize_(tapsPerPhase_ - 1),
+    sampleBuffer_(numberOfChannels_, historySize_ + bufferSize_)
+{
+    jassert(numberOfChannels_ > 0);
+    jassert(bufferSize_ > 0);
+    jassert(upsamplingFactor_ > 0);
+
+    filterKernel_.calloc(upsamplingFactor_ * tapsPerPhase_);
+    calculateFilterKernel();
+
+    for (int channel = 0; channel < numberOfChannels_; ++channel)
+    {
+        truePeakLevels_.add(0.0f);
+    }
+
+    reset();
+}
+
+
+TruePeakMeterPolyphase::~TruePeakMeterPolyphase()
+{
+}
+
+
+void TruePeakMeterPolyphase::reset()
+{
+    sampleBuffer_.clear();
+
+    for (int channel = 0; channel < numberOfChannels_; ++channel)
+    {
+        truePeakLevels_.set(channel, 0.0f);
+    }
+}
+
+
+/// Calculate the polyphase interpolation filter.  For four-fold
+/// oversampling, the 48-tap filter from Annex 2 of ITU-R BS.1770-4
+/// is used verbatim.  Other factors use a Kaiser-windowed sinc
+/// filter with a cutoff at the original Nyquist frequency.
+///
+/// The coefficients of each phase are stored in reversed order, so
+/// that the oldest input sample is multiplied with the first
+/// coefficient.
+///
+void TruePeakMeterPolyphase::calculateFilterKernel()
+{
+    if (upsamplingFactor_ == 4)
+    {
+        const double annexCoefficients[4][annexTapsPerPhase_] =
+        {
+            {
+                0.0017089843750, 0.0109863281250, -0.0196533203125,
+                0.0332031250000, -0.0594482421875, 0.1373291015625,
+                0.9721679687500, -0.1022949218750, 0.0476074218750,
+                -0.0266113281250, 0.0148925781250, -0.0083007812500
+            },
+            {
+                -0.0291748046875, 0.0292968750000, -0.0517578125000,
+                0.0891113281250, -0.1665039062500, 0.4650878906250,
+                0.7797851562500, -0.2003173828125, 0.1015625000000,
+                -0.0582275390625, 0.0330810546875, -0.0189208984375
+            },
+            {
+                -0.0189208984375, 0.0330810546875, -0.0582275390625,
+                0.1015625000000, -0.2003173828125, 0.7797851562500,
+                0.4650878906250, -0.1665039062500, 0.0891113281250,
+                -0.0517578125000, 0.0292968750000, -0.0291748046875
+            },
+            {
+                -0.0083007812500, 0.0148925781250, -0.0266113281250,
+                0.0476074218750, -0.1022949218750, 0.9721679687500,
+                0.1373291015625, -0.0594482421875, 0.0332031250000,
+                -0.0196533203125, 0.0109863281250, 0.0017089843750
+            }
+        };
+
+        for (int phase = 0; phase < upsamplingFactor_; ++phase)
+        {
+            float *phaseKernel = filterKernel_ + phase * tapsPerPhase_;
+
+            for (int tap = 0; tap < tapsPerPhase_; ++tap)
+            {
+                phaseKernel[tapsPerPhase_ - 1 - tap] = static_cast<float>(
+                        annexCoefficients[phase][tap]);
+            }
+        }
+
+        return;
+    }
+
+    // windowed-sinc prototype filter (Kaiser window) of
+    // "tapsPerPhase_ * upsamplingFactor_" samples; with 24 taps per
+    // phase, the pass band is flat to within 0.1 dB up to 0.45 times
+    // the original sample rate and images above 0.55 times the
+    // original sample rate are attenuated by at least 41 dB
+    int samples = tapsPerPhase_ * upsamplingFactor_;
+    double samplesCentre = (samples - 1) / 2.0;
+    double beta = 3.5;
+
+    for (int phase = 0; phase < upsamplingFactor_; ++phase)
+    {
+        float *phaseKernel = filterKernel_ + phase * tapsPerPhase_;
+        double phaseSum = 0.0;
+
+        for (int tap = 0; tap < tapsPerPhase_; ++tap)
+        {
+            int i = tap * upsamplingFactor_ + phase;
+            double x = (i - samplesCentre) / upsamplingFactor_;
+            double sinc = (x == 0.0) ? 1.0 : sin(M_PI * x) / (M_PI * x);
+            double relativeDistance = (i - samplesCentre) / samplesCentre;
+            double window = besselI0(beta * sqrt(1.0 - relativeDistance *
+                                                 relativeDistance)) /
+                            besselI0(beta);
+
+            double coefficient = sinc * window;
+            phaseKernel[tapsPerPhase_ - 1 - tap] = static_cast<float>(
+                    coefficient);
+
+            phaseSum += coefficient;
+        }
+
+        // normalise every phase for unity gain at DC
+        for (int tap = 0; tap < tapsPerPhase_; ++tap)
+        {
+            phaseKernel[tap] = static_cast<float>(
+                                   phaseKernel[tap] / phaseSum);
+        }
+    }
+}
+
+
+float TruePeakMeterPolyphase::getLevel(
+    const int channel)
+{
+    jassert(isPositiveAndBelow(channel, numberOfChannels_));
+
+    return truePeakLevels_[channel];
+}
+
+
+void TruePeakMeterPolyphase::copyFrom(
+    const AudioBuffer<float> &source,
+    const int numberOfSamples)
+{
+    jassert(source.getNumChannels() ==
+            numberOfChannels_);
+    jassert(source.getNumSamples() >=
+            numberOfSamples);
+    jassert(isPositiveAndNotGreaterThan(numberOfSamples,
+                                        bufferSize_));
+
+    for (int channel = 0; channel < numberOfChannels_; ++channel)
+    {
+        // append input samples to filter history
+        sampleBuffer_.copyFrom(channel, historySize_,
+                               source,
+                               channel, 0,
+                               numberOfSamples);
+
+        truePeakLevels_.set(channel,
+                            processChannel(channel, numberOfSamples));
+
+        // keep the last samples as history for the next call
+        float *samples = sampleBuffer_.getWritePointer(channel);
+
+        memmove(samples,
+                samples + numberOfSamples,
+                sizeof(float) * historySize_);
+    }
+}
+
+
+/// Interpolate all phases of a channel and return the maximum
+/// magnitude.  The interpolated samples themselves are discarded.
+///
+/// @param channel audio channel to process
+///
+/// @param numberOfSamples number of input samples (excluding history)
+///
+/// @return true peak level
+///
+float TruePeakMeterPolyphase::processChannel(
+    const int channel,
+    const int numberOfSamples)
+{
+    const float *samples = sampleBuffer_.getReadPointer(channel);
+    const float *kernel = filterKernel_.get();
+
+    float truePeakLevel = 0.0f;
+
+    for (int sample = 0; sample < numberOfSamples; ++sample)
+    {
+        const float *window = samples + sample;
+
+        for (int phase = 0; phase < upsamplingFactor_; ++phase)
+        {
+            const float *phaseKernel = kernel + phase * tapsPerPhase_;
+            float interpolatedSample = 0.0f;
+
+            for (int tap = 0; tap < tapsPerPhase_; ++tap)
+            {
+                interpolatedSample += phaseKernel[tap] * window[tap];
+            }
+
+            truePeakLevel = jmax(truePeakLevel,
+                                 std::abs(interpolatedSample));
+        }
+    }
+
+    return truePeakLevel;
+}
+
+}
+}
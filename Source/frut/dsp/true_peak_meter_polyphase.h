@@ -0,0 +1,88 @@
+/* ----------------------------------------------------------------------------
+
+   FrutJUCE
+   ========
+   Common classes for use with the JUCE library
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+#ifndef FRUT_DSP_TRUE_PEAK_METER_POLYPHASE_H
+#define FRUT_DSP_TRUE_PEAK_METER_POLYPHASE_H
+
+namespace frut
+{
+namespace dsp
+{
+
+/// True peak meter using a polyphase FIR interpolator as described in
+/// Annex 2 of ITU-R BS.1770-4.  Only the interpolated phases are
+/// computed and the upsampled signal is never stored; the peak level
+/// is tracked as a running maximum instead.
+///
+/// Four-fold oversampling uses the 48-tap filter of Annex 2.  Other
+/// factors use a longer Kaiser-windowed sinc filter that is flat to
+/// within 0.1 dB up to 0.45 times the original sample rate (the Annex
+/// 2 filter is flat to within 0.17 dB up to 0.42 times the original
+/// sample rate).
+///
+class TruePeakMeterPolyphase
+{
+public:
+    TruePeakMeterPolyphase(const int numberOfChannels,
+                           const int bufferSize,
+                           const int upsamplingFactor);
+
+    virtual ~TruePeakMeterPolyphase();
+    virtual void reset();
+
+    float getLevel(const int channel);
+
+    void copyFrom(const AudioBuffer<float> &source,
+                  const int numberOfSamples);
+
+protected:
+    void calculateFilterKernel();
+    float processChannel(const int channel,
+                         const int numberOfSamples);
+
+    // taps per phase of the Annex 2 filter and of the windowed-sinc
+    // filter
+    static const int annexTapsPerPhase_ = 12;
+    static const int sincTapsPerPhase_ = 24;
+
+    int numberOfChannels_;
+    int bufferSize_;
+    int upsamplingFactor_;
+    int tapsPerPhase_;
+    int historySize_;
+
+    HeapBlock<float> filterKernel_;
+    AudioBuffer<float> sampleBuffer_;
+
+    Array<float> truePeakLevels_;
+
+private:
+    JUCE_LEAK_DETECTOR(TruePeakMeterPolyphase);
+};
+
+}
+}
+
+#endif  // FRUT_DSP_TRUE_PEAK_METER_POLYPHASE_H
@@ -505,6 +505,31 @@ bool MeterBar::isMeterInverted()
 }
 
 
+/// Get number of meter segments.
+///
+/// @return number of meter segments
+///
+int MeterBar::getNumberOfSegments()
+{
+    return meterSegments_.size();
+}
+
+
+/// Get a meter segment.  Segments are ordered as they have been
+/// added, which is also the order in which they are painted.
+///
+/// @param index index of meter segment
+///
+/// @return meter segment (or **nullptr** for invalid indices)
+///
+widgets::MeterSegment *MeterBar::getSegment(
+    int index)
+
+{
+    return meterSegments_[index];
+}
+
+
 /// Get current segment width.
 ///
 /// @return segment width for vertical meters and segment height for
@@ -74,6 +74,9 @@ public:
     virtual void invertMeter(bool invert);
     virtual bool isMeterInverted();
 
+    int getNumberOfSegments();
+    widgets::MeterSegment *getSegment(int index);
+
     virtual int getSegmentWidth();
     virtual void setSegmentWidth(int segmentWidth);
 
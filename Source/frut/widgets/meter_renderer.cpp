@@ -0,0 +1,408 @@
+/* ----------------------------------------------------------------------------
+
+   FrutJUCE
+   ========
+   Common classes for use with the JUCE library
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+namespace frut
+{
+namespace widgets
+{
+
+/// Create a new (empty) meter renderer.
+///
+MeterRenderer::MeterRenderer()
+{
+}
+
+
+/// Remove all meter bars.  **Call this before deleting any of the
+/// registered meter bars.**
+///
+void MeterRenderer::clear()
+{
+    meterBars_.clear();
+    segments_.clear();
+    spriteSets_.clear();
+
+    dirtyRegion_ = Rectangle<int>();
+}
+
+
+/// Add a meter bar to the renderer.  The meter bar should have been
+/// added to the renderer's parent component using
+/// addChildComponent() and must have been placed and oriented.  If
+/// the meter bar changes its layout afterwards, clear the renderer
+/// and add all meter bars again.
+///
+/// @param meterBar meter bar to add (will **not** be deleted
+///        automatically)
+///
+void MeterRenderer::addMeterBar(
+    MeterBar *meterBar)
+
+{
+    jassert(meterBar != nullptr);
+
+    // lowest level of a 24-bit-signal in decibels (identical to
+    // initial levels of meter bar)
+    float initialLevel = -144.0f;
+
+    MeterBarEntry meterBarEntry;
+
+    meterBarEntry.meterBar = meterBar;
+    meterBarEntry.bounds = meterBar->getBounds();
+    meterBarEntry.firstSegment = segments_.size();
+    meterBarEntry.numberOfSegments = meterBar->getNumberOfSegments();
+
+    meterBarEntry.normalLevel = initialLevel;
+    meterBarEntry.normalLevelPeak = initialLevel;
+    meterBarEntry.discreteLevel = initialLevel;
+    meterBarEntry.discreteLevelPeak = initialLevel;
+
+    Point<int> barPosition = meterBarEntry.bounds.getPosition();
+
+    for (int index = 0; index < meterBarEntry.numberOfSegments; ++index)
+    {
+        SegmentEntry segmentEntry;
+
+        segmentEntry.segment = meterBar->getSegment(index);
+        segmentEntry.discreteSegment =
+            dynamic_cast<MeterSegmentDiscrete *>(segmentEntry.segment);
+
+        // convert segment bounds to parent coordinates
+        segmentEntry.bounds = segmentEntry.segment->getBounds() +
+                              barPosition;
+
+        if (segmentEntry.discreteSegment != nullptr)
+        {
+            segmentEntry.spriteIndex = findSpriteSet(
+                                           segmentEntry.discreteSegment);
+        }
+        else
+        {
+            segmentEntry.spriteIndex = -1;
+        }
+
+        segments_.add(segmentEntry);
+    }
+
+    meterBars_.add(meterBarEntry);
+
+    // meter bar has to be painted
+    dirtyRegion_ = dirtyRegion_.getUnion(meterBarEntry.bounds);
+}
+
+
+/// Get number of meter bars.
+///
+/// @return number of meter bars
+///
+int MeterRenderer::getNumberOfMeterBars() const
+{
+    return meterBars_.size();
+}
+
+
+/// Set normal (average) levels of a meter bar.  Use this only if you
+/// completely disregard discrete (peak) levels!
+///
+/// @param meterBarIndex index of meter bar
+///
+/// @param normalLevel new normal level
+///
+/// @param normalLevelPeak new normal peak level
+///
+void MeterRenderer::setNormalLevels(
+    int meterBarIndex,
+    float normalLevel,
+    float normalLevelPeak)
+
+{
+    // lowest level of a 24-bit-signal in decibels
+    float initialLevel = -144.0f;
+
+    setLevels(meterBarIndex, normalLevel, normalLevelPeak,
+              initialLevel, initialLevel);
+}
+
+
+/// Set discrete (peak) and normal (average) levels of a meter bar.
+/// Segments whose appearance changes are added to the dirty region.
+///
+/// @param meterBarIndex index of meter bar
+///
+/// @param normalLevel new normal level
+///
+/// @param normalLevelPeak new normal peak level
+///
+/// @param discreteLevel new discrete level
+///
+/// @param discreteLevelPeak new discrete peak level
+///
+void MeterRenderer::setLevels(
+    int meterBarIndex,
+    float normalLevel,
+    float normalLevelPeak,
+    float discreteLevel,
+    float discreteLevelPeak)
+
+{
+    jassert(isPositiveAndBelow(meterBarIndex, meterBars_.size()));
+
+    MeterBarEntry &meterBarEntry = meterBars_.getReference(meterBarIndex);
+
+    // levels have not changed
+    if ((meterBarEntry.normalLevel == normalLevel) &&
+            (meterBarEntry.normalLevelPeak == normalLevelPeak) &&
+            (meterBarEntry.discreteLevel == discreteLevel) &&
+            (meterBarEntry.discreteLevelPeak == discreteLevelPeak))
+    {
+        return;
+    }
+
+    meterBarEntry.normalLevel = normalLevel;
+    meterBarEntry.normalLevelPeak = normalLevelPeak;
+    meterBarEntry.discreteLevel = discreteLevel;
+    meterBarEntry.discreteLevelPeak = discreteLevelPeak;
+
+    int lastSegment = meterBarEntry.firstSegment +
+                      meterBarEntry.numberOfSegments;
+
+    for (int index = meterBarEntry.firstSegment;
+            index < lastSegment; ++index)
+    {
+        SegmentEntry &segmentEntry = segments_.getReference(index);
+
+        if (segmentEntry.segment->updateLevels(
+                    normalLevel, normalLevelPeak,
+                    discreteLevel, discreteLevelPeak))
+        {
+            dirtyRegion_ = dirtyRegion_.getUnion(segmentEntry.bounds);
+        }
+    }
+}
+
+
+/// Get region that has to be re-painted and reset it.  Pass the
+/// result to the parent's repaint() after all meter bars have been
+/// updated.
+///
+/// @return dirty region in parent coordinates (may be empty)
+///
+Rectangle<int> MeterRenderer::fetchDirtyRegion()
+{
+    Rectangle<int> dirtyRegion = dirtyRegion_;
+    dirtyRegion_ = Rectangle<int>();
+
+    return dirtyRegion;
+}
+
+
+/// Paint all meter bars that intersect the clip region.  Call this
+/// from the parent's paint().
+///
+/// @param g graphics context of parent component
+///
+void MeterRenderer::paint(
+    Graphics &g)
+
+{
+    Rectangle<int> clipBounds = g.getClipBounds();
+
+    // sprites are only pixel-exact when drawn without scaling
+    bool useSprites =
+        (g.getInternalContext().getPhysicalPixelScaleFactor() == 1.0f);
+
+    for (int barIndex = 0; barIndex < meterBars_.size(); ++barIndex)
+    {
+        const MeterBarEntry &meterBarEntry = meterBars_.getReference(
+                barIndex);
+
+        if (!meterBarEntry.bounds.intersects(clipBounds))
+        {
+            continue;
+        }
+
+        // fill background with black (disabled peak markers will be
+        // drawn in black)
+        g.setColour(Colours::black);
+        g.fillRect(meterBarEntry.bounds);
+
+        // disabled segments are attenuated in their paint() function
+        bool useSpritesForBar = useSprites &&
+                                meterBarEntry.meterBar->isEnabled();
+
+        int lastSegment = meterBarEntry.firstSegment +
+                          meterBarEntry.numberOfSegments;
+
+        // paint segments in order, as the outlines of discrete
+        // segments overlap
+        for (int index = meterBarEntry.firstSegment;
+                index < lastSegment; ++index)
+        {
+            const SegmentEntry &segmentEntry = segments_.getReference(
+                                                   index);
+
+            if (!segmentEntry.bounds.intersects(clipBounds))
+            {
+                continue;
+            }
+
+            if (useSpritesForBar && (segmentEntry.spriteIndex >= 0))
+            {
+                const Image &sprite = getSprite(
+                                          segmentEntry.spriteIndex,
+                                          segmentEntry.discreteSegment);
+
+                if (sprite.isValid())
+                {
+                    g.drawImageAt(sprite,
+                                  segmentEntry.bounds.getX(),
+                                  segmentEntry.bounds.getY());
+
+                    continue;
+                }
+            }
+
+            // paint segment directly, just like the component
+            // hierarchy would
+            Graphics::ScopedSaveState savedState(g);
+
+            g.setOrigin(segmentEntry.bounds.getPosition());
+            g.reduceClipRegion(0, 0,
+                               segmentEntry.bounds.getWidth(),
+                               segmentEntry.bounds.getHeight());
+
+            segmentEntry.segment->paint(g);
+        }
+    }
+}
+
+
+/// Find cached sprites matching a discrete segment (or create an
+/// empty sprite set).
+///
+/// @param segment discrete segment
+///
+/// @return index of sprite set
+///
+int MeterRenderer::findSpriteSet(
+    const MeterSegmentDiscrete *segment)
+
+{
+    int width = segment->getWidth();
+    int height = segment->getHeight();
+
+    for (int index = 0; index < spriteSets_.size(); ++index)
+    {
+        const SpriteSet &spriteSet = spriteSets_.getReference(index);
+
+        if ((spriteSet.width == width) &&
+                (spriteSet.height == height) &&
+                (spriteSet.segmentColour == segment->getSegmentColour()) &&
+                (spriteSet.peakMarkerColour ==
+                 segment->getPeakMarkerColour()))
+        {
+            return index;
+        }
+    }
+
+    // sprites are rendered on first use
+    SpriteSet spriteSet;
+
+    spriteSet.width = width;
+    spriteSet.height = height;
+    spriteSet.segmentColour = segment->getSegmentColour();
+    spriteSet.peakMarkerColour = segment->getPeakMarkerColour();
+
+    spriteSets_.add(spriteSet);
+
+    return spriteSets_.size() - 1;
+}
+
+
+/// Get sprite showing the current state of a discrete segment.
+///
+/// @param spriteIndex index of sprite set
+///
+/// @param segment discrete segment
+///
+/// @return sprite; invalid if the segment is neither dark nor fully
+///         lit and thus has to be painted directly
+///
+const Image &MeterRenderer::getSprite(
+    int spriteIndex,
+    const MeterSegmentDiscrete *segment)
+
+{
+    static const Image invalidSprite;
+
+    float brightness = segment->getBrightness();
+    int state;
+
+    if (brightness == 0.0f)
+    {
+        state = 0;
+    }
+    else if (brightness == 1.0f)
+    {
+        state = 2;
+    }
+    else
+    {
+        return invalidSprite;
+    }
+
+    bool displayPeakMarker = segment->isPeakMarkerLit();
+
+    if (displayPeakMarker)
+    {
+        state += 1;
+    }
+
+    SpriteSet &spriteSet = spriteSets_.getReference(spriteIndex);
+    Image &sprite = spriteSet.sprites[state];
+
+    if (sprite.isNull())
+    {
+        sprite = Image(Image::ARGB,
+                       spriteSet.width,
+                       spriteSet.height,
+                       true);
+
+        Graphics spriteGraphics(sprite);
+
+        MeterSegmentDiscrete::drawSegment(spriteGraphics,
+                                          spriteSet.width,
+                                          spriteSet.height,
+                                          brightness,
+                                          displayPeakMarker,
+                                          spriteSet.segmentColour,
+                                          spriteSet.peakMarkerColour);
+    }
+
+    return sprite;
+}
+
+}
+}
@@ -0,0 +1,148 @@
+/* ----------------------------------------------------------------------------
+
+   FrutJUCE
+   ========
+   Common classes for use with the JUCE library
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+#ifndef FRUT_WIDGETS_METER_RENDERER_H
+#define FRUT_WIDGETS_METER_RENDERER_H
+
+namespace frut
+{
+namespace widgets
+{
+
+/// Batched renderer for meter bars.  Instead of letting every meter
+/// segment paint itself as a separate component, all registered
+/// meter bars are drawn by their common parent in a single paint()
+/// call:
+///
+/// - meter bars are added to the parent using addChildComponent(),
+///   so they keep their layout but never paint themselves
+///
+/// - level changes are collected in a single dirty region, which the
+///   parent should re-paint after all meter bars have been updated
+///
+/// - the pixel bounds of all segments are stored in a table when a
+///   meter bar is added, so painting does not need to query the
+///   component hierarchy
+///
+/// - fully lit and dark discrete segments are cached in sprites
+///
+/// Segments are painted using the same code as in the component
+/// based meter bar, so both look exactly the same.
+///
+/// @see MeterBar
+///
+class MeterRenderer
+{
+public:
+    MeterRenderer();
+
+    void clear();
+    void addMeterBar(MeterBar *meterBar);
+    int getNumberOfMeterBars() const;
+
+    void setNormalLevels(int meterBarIndex,
+                         float normalLevel,
+                         float normalLevelPeak);
+
+    void setLevels(int meterBarIndex,
+                   float normalLevel,
+                   float normalLevelPeak,
+                   float discreteLevel,
+                   float discreteLevelPeak);
+
+    Rectangle<int> fetchDirtyRegion();
+
+    void paint(Graphics &g);
+
+protected:
+    /// Painting information on a single meter segment.
+    struct SegmentEntry
+    {
+        /// meter segment
+        MeterSegment *segment;
+
+        /// meter segment if it is discrete, otherwise **nullptr**
+        MeterSegmentDiscrete *discreteSegment;
+
+        /// bounds of segment in parent coordinates
+        Rectangle<int> bounds;
+
+        /// index of cached sprites (or -1 if there are none)
+        int spriteIndex;
+    };
+
+    /// Painting information on a meter bar.
+    struct MeterBarEntry
+    {
+        /// meter bar
+        MeterBar *meterBar;
+
+        /// bounds of meter bar in parent coordinates
+        Rectangle<int> bounds;
+
+        /// index of meter bar's first segment
+        int firstSegment;
+
+        /// number of segments in meter bar
+        int numberOfSegments;
+
+        /// current levels
+        float normalLevel;
+        float normalLevelPeak;
+        float discreteLevel;
+        float discreteLevelPeak;
+    };
+
+    /// Cached images of a discrete segment.
+    struct SpriteSet
+    {
+        int width;
+        int height;
+
+        Colour segmentColour;
+        Colour peakMarkerColour;
+
+        /// dark or fully lit segment, with and without peak marker
+        Image sprites[4];
+    };
+
+    int findSpriteSet(const MeterSegmentDiscrete *segment);
+    const Image &getSprite(int spriteIndex,
+                           const MeterSegmentDiscrete *segment);
+
+    Array<MeterBarEntry> meterBars_;
+    Array<SegmentEntry> segments_;
+    Array<SpriteSet> spriteSets_;
+
+    Rectangle<int> dirtyRegion_;
+
+private:
+    JUCE_LEAK_DETECTOR(MeterRenderer);
+};
+
+}
+}
+
+#endif  // FRUT_WIDGETS_METER_RENDERER_H
@@ -104,5 +104,29 @@ void MeterSegment::setDiscreteLevels(
     setLevels(initialLevel, initialLevel, discreteLevel, discreteLevelPeak);
 }
 
+
+/// Set discrete (peak) and normal (average) levels.  The segment is
+/// only re-painted when its appearance has changed.
+///
+/// @param normalLevel new normal level
+///
+/// @param normalLevelPeak new normal peak level
+///
+/// @param discreteLevel new discrete level
+///
+/// @param discreteLevelPeak new discrete peak level
+///
+void MeterSegment::setLevels(
+    float normalLevel, float normalLevelPeak,
+    float discreteLevel, float discreteLevelPeak)
+
+{
+    if (updateLevels(normalLevel, normalLevelPeak,
+                     discreteLevel, discreteLevelPeak))
+    {
+        repaint();
+    }
+}
+
 }
 }
@@ -48,7 +48,14 @@ public:
     virtual void setDiscreteLevels(float discreteLevel,
                                    float discreteLevelPeak);
 
-    /// Set discrete (peak) and normal (average) levels.
+    virtual void setLevels(float normalLevel,
+                           float normalLevelPeak,
+                           float discreteLevel,
+                           float discreteLevelPeak);
+
+    /// Update discrete (peak) and normal (average) levels without
+    /// re-painting the segment.  This allows a MeterRenderer to draw
+    /// the segment instead of the component itself.
     ///
     /// @param normalLevel new normal level
     ///
@@ -58,10 +65,12 @@ public:
     ///
     /// @param discreteLevelPeak new discrete peak level
     ///
-    virtual void setLevels(float normalLevel,
-                           float normalLevelPeak,
-                           float discreteLevel,
-                           float discreteLevelPeak) = 0 ;
+    /// @return **true** if the segment's appearance has changed
+    ///
+    virtual bool updateLevels(float normalLevel,
+                              float normalLevelPeak,
+                              float discreteLevel,
+                              float discreteLevelPeak) = 0 ;
 
     virtual widgets::Orientation getOrientation();
     virtual void setOrientation(widgets::Orientation orientation);
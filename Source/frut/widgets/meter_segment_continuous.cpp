@@ -490,7 +490,8 @@ float MeterSegmentContinuous::calculateLevelPosition(
 }
 
 
-/// Set discrete (peak) and normal (average) levels.
+/// Update discrete (peak) and normal (average) levels without
+/// re-painting the segment.
 ///
 /// @param normalLevel new normal level
 ///
@@ -500,7 +501,9 @@ float MeterSegmentContinuous::calculateLevelPosition(
 ///
 /// @param discreteLevelPeak new discrete peak level
 ///
-void MeterSegmentContinuous::setLevels(
+/// @return **true** if the segment's appearance has changed
+///
+bool MeterSegmentContinuous::updateLevels(
     float normalLevel, float normalLevelPeak,
     float discreteLevel, float discreteLevelPeak)
 
@@ -525,14 +528,11 @@ void MeterSegmentContinuous::setLevels(
     // calculate new discrete peak level position
     discretePeakPosition_ = calculateLevelPosition(discreteLevelPeak, false);
 
-    // re-paint meter segment only if something has changed
-    if ((normalLevelPosition_ != normalLevelPositionOld) ||
-            (normalPeakPosition_ != normalPeakPositionOld) ||
-            (discreteLevelPosition_ != discreteLevelPositionOld) ||
-            (discretePeakPosition_ != discretePeakPositionOld))
-    {
-        repaint();
-    }
+    // meter segment needs re-painting only if something has changed
+    return (normalLevelPosition_ != normalLevelPositionOld) ||
+           (normalPeakPosition_ != normalPeakPositionOld) ||
+           (discreteLevelPosition_ != discreteLevelPositionOld) ||
+           (discretePeakPosition_ != discretePeakPositionOld);
 }
 
 }
@@ -52,10 +52,10 @@ public:
     virtual void setColours(const Colour &segmentColour,
                             const Colour &peakMarkerColour);
 
-    virtual void setLevels(float normalLevel,
-                           float normalLevelPeak,
-                           float discreteLevel,
-                           float discreteLevelPeak);
+    virtual bool updateLevels(float normalLevel,
+                              float normalLevelPeak,
+                              float discreteLevel,
+                              float discreteLevelPeak) override;
 
     virtual void paint(Graphics &g);
     virtual void resized();
@@ -164,34 +164,89 @@ void MeterSegmentDiscrete::setColours(
 }
 
 
-/// Paint segment.
+/// Get the segment's current brightness.
 ///
-/// @param g the graphics context that must be used to do the drawing
-///        operations
+/// @return brightness (range: 0.0 to 1.0)
 ///
-void MeterSegmentDiscrete::paint(
-    Graphics &g)
+float MeterSegmentDiscrete::getBrightness() const
+{
+    return brightness_;
+}
+
+
+/// Find out whether the peak marker is currently lit.
+///
+/// @return **true** if peak marker is lit
+///
+bool MeterSegmentDiscrete::isPeakMarkerLit() const
+{
+    return displayPeakMarker_;
+}
+
+
+/// Get colour of segment.
+///
+/// @return segment colour
+///
+const Colour &MeterSegmentDiscrete::getSegmentColour() const
+{
+    return segmentColour_;
+}
+
+
+/// Get colour of peak marker.
+///
+/// @return peak marker colour
+///
+const Colour &MeterSegmentDiscrete::getPeakMarkerColour() const
+{
+    return peakMarkerColour_;
+}
+
+
+/// Draw an enabled segment.  This is used by paint() and allows a
+/// MeterRenderer to cache the segment's appearance in sprites.
+///
+/// @param g graphics context
+///
+/// @param width width of segment (in pixels)
+///
+/// @param height height of segment (in pixels)
+///
+/// @param brightness brightness of segment (range: 0.0 to 1.0)
+///
+/// @param displayPeakMarker determines whether the peak marker is
+///        lit
+///
+/// @param segmentColour colour of the segment
+///
+/// @param peakMarkerColour colour of the peak marker
+///
+void MeterSegmentDiscrete::drawSegment(
+    Graphics &g,
+    int width,
+    int height,
+    float brightness,
+    bool displayPeakMarker,
+    const Colour &segmentColour,
+    const Colour &peakMarkerColour)
 
 {
     // to look well, meter segments should be left with some
     // colour and not have maximum brightness
-    float segmentBrightnessModifier = brightness_ * 0.80f + 0.20f;
-    float outlineBrightnessModifier = brightness_ * 0.70f + 0.25f;
-
-    // get meter segment's dimensions
-    int width = getWidth();
-    int height = getHeight();
+    float segmentBrightnessModifier = brightness * 0.80f + 0.20f;
+    float outlineBrightnessModifier = brightness * 0.70f + 0.25f;
 
     // initialise segment colour from brightness modifier
-    Colour segmentColour = segmentColour_.withMultipliedBrightness(
-                               segmentBrightnessModifier);
+    Colour segmentColourCurrent = segmentColour.withMultipliedBrightness(
+                                      segmentBrightnessModifier);
 
     // initialise outline colour from brightness modifier
-    Colour outlineColour = segmentColour_.withMultipliedBrightness(
+    Colour outlineColour = segmentColour.withMultipliedBrightness(
                                outlineBrightnessModifier);
 
     // set segment colour
-    g.setColour(segmentColour);
+    g.setColour(segmentColourCurrent);
 
     // fill meter segment, but leave a border of two pixels for
     // outline and peak marker
@@ -205,11 +260,25 @@ void MeterSegmentDiscrete::paint(
 
     // if peak marker is lit, draw peak marker around meter segment
     // (width: 1 pixel)
-    if (displayPeakMarker_)
+    if (displayPeakMarker)
     {
-        g.setColour(peakMarkerColour_);
+        g.setColour(peakMarkerColour);
         g.drawRect(0, 0, width, height);
     }
+}
+
+
+/// Paint segment.
+///
+/// @param g the graphics context that must be used to do the drawing
+///        operations
+///
+void MeterSegmentDiscrete::paint(
+    Graphics &g)
+
+{
+    drawSegment(g, getWidth(), getHeight(), brightness_,
+                displayPeakMarker_, segmentColour_, peakMarkerColour_);
 
     // attenuate colours if segment is disabled
     if (!isEnabled())
@@ -230,7 +299,8 @@ void MeterSegmentDiscrete::visibilityChanged()
 }
 
 
-/// Set discrete (peak) and normal (average) levels.
+/// Update discrete (peak) and normal (average) levels without
+/// re-painting the segment.
 ///
 /// @param normalLevel new normal level
 ///
@@ -240,7 +310,9 @@ void MeterSegmentDiscrete::visibilityChanged()
 ///
 /// @param discreteLevelPeak new discrete peak level
 ///
-void MeterSegmentDiscrete::setLevels(
+/// @return **true** if the segment's appearance has changed
+///
+bool MeterSegmentDiscrete::updateLevels(
     float normalLevel, float normalLevelPeak,
     float discreteLevel, float discreteLevelPeak)
 
@@ -355,13 +427,10 @@ void MeterSegmentDiscrete::setLevels(
         }
     }
 
-    // re-paint meter segment only when brightness modifier or peak
-    // marker have changed
-    if ((brightness_ != brightnessOld) ||
-            (displayPeakMarker_ != displayPeakMarkerOld))
-    {
-        repaint();
-    }
+    // meter segment needs re-painting only when brightness modifier
+    // or peak marker have changed
+    return (brightness_ != brightnessOld) ||
+           (displayPeakMarker_ != displayPeakMarkerOld);
 }
 
 }
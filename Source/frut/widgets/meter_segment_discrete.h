@@ -53,10 +53,24 @@ public:
     virtual void setColours(const Colour &segmentColour,
                             const Colour &peakMarkerColour);
 
-    virtual void setLevels(float normalLevel,
-                           float normalLevelPeak,
-                           float discreteLevel,
-                           float discreteLevelPeak);
+    virtual bool updateLevels(float normalLevel,
+                              float normalLevelPeak,
+                              float discreteLevel,
+                              float discreteLevelPeak) override;
+
+    float getBrightness() const;
+    bool isPeakMarkerLit() const;
+
+    const Colour &getSegmentColour() const;
+    const Colour &getPeakMarkerColour() const;
+
+    static void drawSegment(Graphics &g,
+                            int width,
+                            int height,
+                            float brightness,
+                            bool displayPeakMarker,
+                            const Colour &segmentColour,
+                            const Colour &peakMarkerColour);
 
     virtual void paint(Graphics &g);
     virtual void visibilityChanged();
@@ -0,0 +1,285 @@
+/* ----------------------------------------------------------------------------
+
+   K-Meter
+   =======
+   Implementation of a K-System meter according to Bob Katz' specifications
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+#include "half_band_decimator.h"
+
+
+namespace
+{
+
+// modified Bessel function of the first kind (order zero), needed
+// for the Kaiser window
+double besselI0(
+    const double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+
+    for (int k = 1; k < 50; ++k)
+    {
+        double factor = x / (2.0 * k);
+        term *= factor * factor;
+        sum += term;
+
+        if (term < 1e-12 * sum)
+        {
+            break;
+        }
+    }
+
+    return sum;
+}
+
+}
+
+
+/// Create a new decimator.
+///
+/// @param numberOfChannels number of audio channels
+///
+/// @param sampleRate sample rate of input (in Hz)
+///
+/// @param decimationFactor factor by which the sample rate is
+///        reduced (1, 2 or 4)
+///
+/// @param maximumNumberOfSamples maximum number of input samples
+///        passed to process()
+///
+HalfBandDecimator::HalfBandDecimator(
+    const int numberOfChannels,
+    const double sampleRate,
+    const int decimationFactor,
+    const int maximumNumberOfSamples) :
+
+    numberOfChannels_(numberOfChannels),
+    decimationFactor_(decimationFactor)
+{
+    jassert((decimationFactor_ == 1) ||
+            (decimationFactor_ == 2) ||
+            (decimationFactor_ == 4));
+
+    double stageSampleRate = sampleRate;
+    int stageNumberOfSamples = maximumNumberOfSamples;
+
+    for (int factor = 1; factor < decimationFactor_; factor *= 2)
+    {
+        auto stage = new Stage();
+        designStage(*stage, stageSampleRate);
+
+        stage->samples.setSize(numberOfChannels_,
+                               stage->historyLength + stageNumberOfSamples);
+
+        stages_.add(stage);
+
+        stageSampleRate /= 2.0;
+        stageNumberOfSamples /= 2;
+    }
+
+    reset();
+}
+
+
+void HalfBandDecimator::reset()
+{
+    for (int index = 0; index < stages_.size(); ++index)
+    {
+        stages_[index]->samples.clear();
+    }
+}
+
+
+int HalfBandDecimator::getDecimationFactor() const
+{
+    return decimationFactor_;
+}
+
+
+/// Decimate audio.
+///
+/// @param source input samples
+///
+/// @param destination receives numberOfSamples / getDecimationFactor()
+///        output samples per channel
+///
+/// @param numberOfSamples number of input samples; must be a
+///        multiple of the decimation factor
+///
+void HalfBandDecimator::process(
+    const AudioBuffer<float> &source,
+    AudioBuffer<float> &destination,
+    const int numberOfSamples)
+{
+    jassert(source.getNumChannels() >= numberOfChannels_);
+    jassert(destination.getNumChannels() >= numberOfChannels_);
+    jassert(numberOfSamples % decimationFactor_ == 0);
+    jassert(destination.getNumSamples() >=
+            numberOfSamples / decimationFactor_);
+
+    if (stages_.size() == 0)
+    {
+        for (int channel = 0; channel < numberOfChannels_; ++channel)
+        {
+            destination.copyFrom(channel, 0,
+                                 source,
+                                 channel, 0,
+                                 numberOfSamples);
+        }
+
+        return;
+    }
+
+    for (int channel = 0; channel < numberOfChannels_; ++channel)
+    {
+        int stageNumberOfSamples = numberOfSamples;
+
+        // append input to history of first stage
+        Stage &firstStage = *stages_[0];
+        firstStage.samples.copyFrom(channel, firstStage.historyLength,
+                                    source,
+                                    channel, 0,
+                                    stageNumberOfSamples);
+
+        for (int index = 0; index < stages_.size(); ++index)
+        {
+            Stage &stage = *stages_[index];
+            float *samples = stage.samples.getWritePointer(channel);
+
+            // the output of a stage is appended to the history of the
+            // next stage
+            float *output;
+
+            if (index < stages_.size() - 1)
+            {
+                Stage &nextStage = *stages_[index + 1];
+                output = nextStage.samples.getWritePointer(
+                             channel, nextStage.historyLength);
+            }
+            else
+            {
+                output = destination.getWritePointer(channel);
+            }
+
+            decimateStage(stage, samples, output,
+                          stageNumberOfSamples / 2);
+
+            // keep history for next chunk (source and destination
+            // overlap for short chunks, so copy front to back)
+            for (int n = 0; n < stage.historyLength; ++n)
+            {
+                samples[n] = samples[n + stageNumberOfSamples];
+            }
+
+            stageNumberOfSamples /= 2;
+        }
+    }
+}
+
+
+// design Kaiser-windowed half-band filter; the pass band ends at
+// 20 kHz and the stop band starts where aliases would fold back below
+// 20 kHz
+void HalfBandDecimator::designStage(
+    Stage &stage,
+    const double sampleRate)
+{
+    double passBandEdge = 20000.0;
+    double stopBandAttenuation = 80.0;
+
+    double transitionWidth = 0.5 - 2.0 * passBandEdge / sampleRate;
+    jassert(transitionWidth > 0.0);
+
+    // estimate filter length (Kaiser); half-band filters have
+    // 4 * m + 3 taps, so that the outermost taps are not zero
+    double estimatedLength = (stopBandAttenuation - 7.95) /
+                             (14.36 * transitionWidth) + 1.0;
+    int m = jmax(0, static_cast<int>(ceil((estimatedLength - 3.0) / 4.0)));
+
+    stage.numberOfCoefficients = m + 1;
+    stage.historyLength = 4 * m + 2;
+    stage.coefficients.calloc(stage.numberOfCoefficients);
+
+    double beta = 0.1102 * (stopBandAttenuation - 8.7);
+    double halfLength = 2 * m + 1;
+    double coefficientSum = 0.0;
+
+    for (int index = 0; index < stage.numberOfCoefficients; ++index)
+    {
+        // distance from centre tap (always odd)
+        int distance = 2 * index + 1;
+        double relativeDistance = distance / halfLength;
+
+        double sinc = ((index % 2) ? -1.0 : 1.0) / (M_PI * distance);
+        double window = besselI0(beta * sqrt(1.0 - relativeDistance *
+                                             relativeDistance)) /
+                        besselI0(beta);
+
+        stage.coefficients[index] = static_cast<float>(sinc * window);
+        coefficientSum += 2.0 * sinc * window;
+    }
+
+    // normalise to unity gain at DC (the centre tap is 0.5)
+    for (int index = 0; index < stage.numberOfCoefficients; ++index)
+    {
+        stage.coefficients[index] = static_cast<float>(
+                                        stage.coefficients[index] *
+                                        0.5 / coefficientSum);
+    }
+}
+
+
+// "samples" holds the stage's history followed by twice as many input
+// samples as output samples are requested
+void HalfBandDecimator::decimateStage(
+    const Stage &stage,
+    const float *samples,
+    float *output,
+    const int numberOfOutputSamples)
+{
+    // the filter of output sample "n" is centred on "centre[2 * n]"
+    // and ends on the newer sample of each input pair
+    const float *centre = samples + 1 + stage.historyLength / 2;
+
+    for (int n = 0; n < numberOfOutputSamples; ++n)
+    {
+        output[n] = 0.5f * centre[2 * n];
+    }
+
+    // apply one pair of taps to all output samples at a time; output
+    // samples are independent, so the compiler may vectorise the
+    // inner loop instead of waiting for each sum to complete
+    for (int index = 0; index < stage.numberOfCoefficients; ++index)
+    {
+        const float coefficient = stage.coefficients[index];
+        const int distance = 2 * index + 1;
+
+        const float *older = centre - distance;
+        const float *newer = centre + distance;
+
+        for (int n = 0; n < numberOfOutputSamples; ++n)
+        {
+            output[n] += coefficient * (older[2 * n] + newer[2 * n]);
+        }
+    }
+}
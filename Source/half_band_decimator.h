@@ -0,0 +1,90 @@
+/* ----------------------------------------------------------------------------
+
+   K-Meter
+   =======
+   Implementation of a K-System meter according to Bob Katz' specifications
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+
+#ifndef KMETER_HALF_BAND_DECIMATOR_H
+#define KMETER_HALF_BAND_DECIMATOR_H
+
+#include "FrutHeader.h"
+
+
+/// Reduces the sample rate of audio by 2 or 4 using a cascade of
+/// half-band low-pass filters.
+///
+/// Every stage is a Kaiser-windowed FIR filter that halves the
+/// sample rate.  Only every second output sample is calculated, and
+/// all even taps except the centre tap of a half-band filter are
+/// zero, so a stage needs about a quarter of the multiplications of
+/// a plain FIR filter of the same length (polyphase
+/// implementation).  Frequencies up to 20 kHz are passed unchanged;
+/// aliases may only fold back above 20 kHz.
+///
+class HalfBandDecimator
+{
+public:
+    HalfBandDecimator(const int numberOfChannels,
+                      const double sampleRate,
+                      const int decimationFactor,
+                      const int maximumNumberOfSamples);
+
+    void reset();
+
+    int getDecimationFactor() const;
+
+    void process(const AudioBuffer<float> &source,
+                 AudioBuffer<float> &destination,
+                 const int numberOfSamples);
+
+private:
+    JUCE_LEAK_DETECTOR(HalfBandDecimator);
+
+    struct Stage
+    {
+        // non-zero taps left and right of the centre tap, starting
+        // with the innermost taps
+        HeapBlock<float> coefficients;
+        int numberOfCoefficients;
+
+        // input samples of the stage, preceded by the history of the
+        // previous chunk
+        AudioBuffer<float> samples;
+        int historyLength;
+    };
+
+    static void designStage(Stage &stage,
+                            const double sampleRate);
+
+    static void decimateStage(const Stage &stage,
+                              const float *samples,
+                              float *output,
+                              const int numberOfOutputSamples);
+
+    int numberOfChannels_;
+    int decimationFactor_;
+
+    OwnedArray<Stage> stages_;
+};
+
+#endif  // KMETER_HALF_BAND_DECIMATOR_H
@@ -0,0 +1,778 @@
+/* ----------------------------------------------------------------------------
+
+   K-Meter
+   =======
+   Implementation of a K-System meter according to Bob Katz' specifications
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+#include "k_weighting_filter.h"
+
+#if JUCE_INTEL
+#include <immintrin.h>
+
+// allow SIMD code in functions without changing the compiler flags
+// of the whole project (Visual C++ does not need this)
+#if defined (__GNUC__) || defined (__clang__)
+#define KMETER_TARGET_SSE2 __attribute__((target("sse2")))
+#define KMETER_TARGET_AVX __attribute__((target("avx")))
+#else
+#define KMETER_TARGET_SSE2
+#define KMETER_TARGET_AVX
+#endif
+
+#endif  // JUCE_INTEL
+
+
+namespace
+{
+
+typedef KWeightingFilter::Coefficients Coefficients;
+
+
+void filterLanes_Scalar(
+    double *samples,
+    const int numberOfSamples,
+    double *state,
+    const int stateStride,
+    const Coefficients &preFilter,
+    const Coefficients &weightingFilter)
+{
+    // copy coefficients and state to local variables so that the
+    // compiler may keep them in registers
+    const double pf_b0 = preFilter.b0;
+    const double pf_b1 = preFilter.b1;
+    const double pf_b2 = preFilter.b2;
+    const double pf_a1 = preFilter.a1;
+    const double pf_a2 = preFilter.a2;
+
+    const double rlb_b0 = weightingFilter.b0;
+    const double rlb_b1 = weightingFilter.b1;
+    const double rlb_b2 = weightingFilter.b2;
+    const double rlb_a1 = weightingFilter.a1;
+    const double rlb_a2 = weightingFilter.a2;
+
+    double pf_s1 = state[0];
+    double pf_s2 = state[stateStride];
+    double rlb_s1 = state[2 * stateStride];
+    double rlb_s2 = state[3 * stateStride];
+
+    for (int sample = 0; sample < numberOfSamples; ++sample)
+    {
+        double input = samples[sample];
+
+        // pre-filter
+        double preFiltered = pf_b0 * input + pf_s1;
+        pf_s1 = pf_b1 * input - pf_a1 * preFiltered + pf_s2;
+        pf_s2 = pf_b2 * input - pf_a2 * preFiltered;
+
+        // RLB weighting filter
+        double output = rlb_b0 * preFiltered + rlb_s1;
+        rlb_s1 = rlb_b1 * preFiltered - rlb_a1 * output + rlb_s2;
+        rlb_s2 = rlb_b2 * preFiltered - rlb_a2 * output;
+
+        samples[sample] = output;
+    }
+
+    state[0] = pf_s1;
+    state[stateStride] = pf_s2;
+    state[2 * stateStride] = rlb_s1;
+    state[3 * stateStride] = rlb_s2;
+}
+
+
+void interleave_Scalar(
+    const float *const *channels,
+    double *samples,
+    const int numberOfSamples)
+{
+    for (int sample = 0; sample < numberOfSamples; ++sample)
+    {
+        samples[sample] = channels[0][sample];
+    }
+}
+
+
+void deinterleave_Scalar(
+    const double *samples,
+    float *const *channels,
+    const int numberOfSamples)
+{
+    for (int sample = 0; sample < numberOfSamples; ++sample)
+    {
+        channels[0][sample] = static_cast<float>(samples[sample]);
+    }
+}
+
+
+#if JUCE_INTEL
+
+// coefficients of both biquads, broadcast to all lanes
+struct Coefficients_Sse2
+{
+    KMETER_TARGET_SSE2 Coefficients_Sse2(const Coefficients &preFilter,
+                                         const Coefficients &weightingFilter) :
+        pf_b0(_mm_set1_pd(preFilter.b0)),
+        pf_b1(_mm_set1_pd(preFilter.b1)),
+        pf_b2(_mm_set1_pd(preFilter.b2)),
+        pf_a1(_mm_set1_pd(preFilter.a1)),
+        pf_a2(_mm_set1_pd(preFilter.a2)),
+        rlb_b0(_mm_set1_pd(weightingFilter.b0)),
+        rlb_b1(_mm_set1_pd(weightingFilter.b1)),
+        rlb_b2(_mm_set1_pd(weightingFilter.b2)),
+        rlb_a1(_mm_set1_pd(weightingFilter.a1)),
+        rlb_a2(_mm_set1_pd(weightingFilter.a2))
+    {
+    }
+
+    __m128d pf_b0, pf_b1, pf_b2, pf_a1, pf_a2;
+    __m128d rlb_b0, rlb_b1, rlb_b2, rlb_a1, rlb_a2;
+};
+
+
+// filter state of two lanes
+struct State_Sse2
+{
+    KMETER_TARGET_SSE2 State_Sse2(const double *state,
+                                  const int stateStride) :
+        pf_s1(_mm_loadu_pd(state)),
+        pf_s2(_mm_loadu_pd(state + stateStride)),
+        rlb_s1(_mm_loadu_pd(state + 2 * stateStride)),
+        rlb_s2(_mm_loadu_pd(state + 3 * stateStride))
+    {
+    }
+
+    KMETER_TARGET_SSE2 void store(double *state,
+                                  const int stateStride) const
+    {
+        _mm_storeu_pd(state, pf_s1);
+        _mm_storeu_pd(state + stateStride, pf_s2);
+        _mm_storeu_pd(state + 2 * stateStride, rlb_s1);
+        _mm_storeu_pd(state + 3 * stateStride, rlb_s2);
+    }
+
+    __m128d pf_s1, pf_s2, rlb_s1, rlb_s2;
+};
+
+
+// same as the loop body of filterLanes_Scalar()
+KMETER_TARGET_SSE2 inline __m128d filterSample_Sse2(
+    const __m128d input,
+    const Coefficients_Sse2 &c,
+    State_Sse2 &s)
+{
+    // pre-filter
+    __m128d preFiltered = _mm_add_pd(_mm_mul_pd(c.pf_b0, input), s.pf_s1);
+    s.pf_s1 = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(c.pf_b1, input),
+                                    _mm_mul_pd(c.pf_a1, preFiltered)),
+                         s.pf_s2);
+    s.pf_s2 = _mm_sub_pd(_mm_mul_pd(c.pf_b2, input),
+                         _mm_mul_pd(c.pf_a2, preFiltered));
+
+    // RLB weighting filter
+    __m128d output = _mm_add_pd(_mm_mul_pd(c.rlb_b0, preFiltered), s.rlb_s1);
+    s.rlb_s1 = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(c.rlb_b1, preFiltered),
+                                     _mm_mul_pd(c.rlb_a1, output)),
+                          s.rlb_s2);
+    s.rlb_s2 = _mm_sub_pd(_mm_mul_pd(c.rlb_b2, preFiltered),
+                          _mm_mul_pd(c.rlb_a2, output));
+
+    return output;
+}
+
+
+// same as filterLanes_Scalar(), but for 2 * "numberOfRegisters"
+// interleaved channels (one or two registers of two lanes each)
+template <int numberOfRegisters>
+KMETER_TARGET_SSE2 void filterLanes_Sse2(
+    double *samples,
+    const int numberOfSamples,
+    double *state,
+    const int stateStride,
+    const Coefficients &preFilter,
+    const Coefficients &weightingFilter)
+{
+    static_assert(numberOfRegisters == 1 || numberOfRegisters == 2,
+                  "one or two registers only");
+
+    const int numberOfLanes = 2 * numberOfRegisters;
+    const Coefficients_Sse2 coefficients(preFilter, weightingFilter);
+
+    // two independent registers, so that their calculations
+    // overlap in the CPU's pipeline (with a single register,
+    // "second" duplicates "first" and is never used)
+    State_Sse2 first(state, stateStride);
+    State_Sse2 second(state + numberOfLanes - 2, stateStride);
+
+    for (int sample = 0; sample < numberOfLanes * numberOfSamples;
+            sample += numberOfLanes)
+    {
+        double *lanes = samples + sample;
+
+        _mm_storeu_pd(lanes, filterSample_Sse2(
+                          _mm_loadu_pd(lanes), coefficients, first));
+
+        if (numberOfRegisters == 2)
+        {
+            _mm_storeu_pd(lanes + 2, filterSample_Sse2(
+                              _mm_loadu_pd(lanes + 2), coefficients, second));
+        }
+    }
+
+    first.store(state, stateStride);
+
+    if (numberOfRegisters == 2)
+    {
+        second.store(state + 2, stateStride);
+    }
+}
+
+
+// convert planar channels to interleaved lanes, two channels at a
+// time
+template <int numberOfRegisters>
+KMETER_TARGET_SSE2 void interleave_Sse2(
+    const float *const *channels,
+    double *samples,
+    const int numberOfSamples)
+{
+    const int numberOfLanes = 2 * numberOfRegisters;
+    int sample = 0;
+
+    for (; sample + 4 <= numberOfSamples; sample += 4)
+    {
+        for (int n = 0; n < numberOfRegisters; ++n)
+        {
+            __m128 lane0 = _mm_loadu_ps(channels[2 * n] + sample);
+            __m128 lane1 = _mm_loadu_ps(channels[2 * n + 1] + sample);
+
+            // [0, 1, 0, 1] and [2, 3, 2, 3]
+            __m128 low = _mm_unpacklo_ps(lane0, lane1);
+            __m128 high = _mm_unpackhi_ps(lane0, lane1);
+
+            double *destination = samples + numberOfLanes * sample + 2 * n;
+
+            _mm_storeu_pd(destination,
+                          _mm_cvtps_pd(low));
+            _mm_storeu_pd(destination + numberOfLanes,
+                          _mm_cvtps_pd(_mm_movehl_ps(low, low)));
+            _mm_storeu_pd(destination + 2 * numberOfLanes,
+                          _mm_cvtps_pd(high));
+            _mm_storeu_pd(destination + 3 * numberOfLanes,
+                          _mm_cvtps_pd(_mm_movehl_ps(high, high)));
+        }
+    }
+
+    for (; sample < numberOfSamples; ++sample)
+    {
+        for (int lane = 0; lane < numberOfLanes; ++lane)
+        {
+            samples[numberOfLanes * sample + lane] = channels[lane][sample];
+        }
+    }
+}
+
+
+// convert interleaved lanes to planar channels, two channels at a
+// time
+template <int numberOfRegisters>
+KMETER_TARGET_SSE2 void deinterleave_Sse2(
+    const double *samples,
+    float *const *channels,
+    const int numberOfSamples)
+{
+    const int numberOfLanes = 2 * numberOfRegisters;
+    int sample = 0;
+
+    for (; sample + 4 <= numberOfSamples; sample += 4)
+    {
+        for (int n = 0; n < numberOfRegisters; ++n)
+        {
+            const double *source = samples + numberOfLanes * sample + 2 * n;
+
+            __m128 low = _mm_movelh_ps(
+                             _mm_cvtpd_ps(_mm_loadu_pd(source)),
+                             _mm_cvtpd_ps(_mm_loadu_pd(source + numberOfLanes)));
+            __m128 high = _mm_movelh_ps(
+                              _mm_cvtpd_ps(_mm_loadu_pd(source + 2 * numberOfLanes)),
+                              _mm_cvtpd_ps(_mm_loadu_pd(source + 3 * numberOfLanes)));
+
+            _mm_storeu_ps(channels[2 * n] + sample,
+                          _mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(channels[2 * n + 1] + sample,
+                          _mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1)));
+        }
+    }
+
+    for (; sample < numberOfSamples; ++sample)
+    {
+        for (int lane = 0; lane < numberOfLanes; ++lane)
+        {
+            channels[lane][sample] = static_cast<float>(
+                                         samples[numberOfLanes * sample + lane]);
+        }
+    }
+}
+
+
+// coefficients of both biquads, broadcast to all lanes
+struct Coefficients_Avx
+{
+    KMETER_TARGET_AVX Coefficients_Avx(const Coefficients &preFilter,
+                                       const Coefficients &weightingFilter) :
+        pf_b0(_mm256_set1_pd(preFilter.b0)),
+        pf_b1(_mm256_set1_pd(preFilter.b1)),
+        pf_b2(_mm256_set1_pd(preFilter.b2)),
+        pf_a1(_mm256_set1_pd(preFilter.a1)),
+        pf_a2(_mm256_set1_pd(preFilter.a2)),
+        rlb_b0(_mm256_set1_pd(weightingFilter.b0)),
+        rlb_b1(_mm256_set1_pd(weightingFilter.b1)),
+        rlb_b2(_mm256_set1_pd(weightingFilter.b2)),
+        rlb_a1(_mm256_set1_pd(weightingFilter.a1)),
+        rlb_a2(_mm256_set1_pd(weightingFilter.a2))
+    {
+    }
+
+    __m256d pf_b0, pf_b1, pf_b2, pf_a1, pf_a2;
+    __m256d rlb_b0, rlb_b1, rlb_b2, rlb_a1, rlb_a2;
+};
+
+
+// filter state of four lanes
+struct State_Avx
+{
+    KMETER_TARGET_AVX State_Avx(const double *state,
+                                const int stateStride) :
+        pf_s1(_mm256_loadu_pd(state)),
+        pf_s2(_mm256_loadu_pd(state + stateStride)),
+        rlb_s1(_mm256_loadu_pd(state + 2 * stateStride)),
+        rlb_s2(_mm256_loadu_pd(state + 3 * stateStride))
+    {
+    }
+
+    KMETER_TARGET_AVX void store(double *state,
+                                 const int stateStride) const
+    {
+        _mm256_storeu_pd(state, pf_s1);
+        _mm256_storeu_pd(state + stateStride, pf_s2);
+        _mm256_storeu_pd(state + 2 * stateStride, rlb_s1);
+        _mm256_storeu_pd(state + 3 * stateStride, rlb_s2);
+    }
+
+    __m256d pf_s1, pf_s2, rlb_s1, rlb_s2;
+};
+
+
+// same as the loop body of filterLanes_Scalar()
+KMETER_TARGET_AVX inline __m256d filterSample_Avx(
+    const __m256d input,
+    const Coefficients_Avx &c,
+    State_Avx &s)
+{
+    // pre-filter
+    __m256d preFiltered = _mm256_add_pd(_mm256_mul_pd(c.pf_b0, input), s.pf_s1);
+    s.pf_s1 = _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(c.pf_b1, input),
+                                          _mm256_mul_pd(c.pf_a1, preFiltered)),
+                            s.pf_s2);
+    s.pf_s2 = _mm256_sub_pd(_mm256_mul_pd(c.pf_b2, input),
+                            _mm256_mul_pd(c.pf_a2, preFiltered));
+
+    // RLB weighting filter
+    __m256d output = _mm256_add_pd(_mm256_mul_pd(c.rlb_b0, preFiltered), s.rlb_s1);
+    s.rlb_s1 = _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(c.rlb_b1, preFiltered),
+                                           _mm256_mul_pd(c.rlb_a1, output)),
+                             s.rlb_s2);
+    s.rlb_s2 = _mm256_sub_pd(_mm256_mul_pd(c.rlb_b2, preFiltered),
+                             _mm256_mul_pd(c.rlb_a2, output));
+
+    return output;
+}
+
+
+// same as filterLanes_Scalar(), but for 4 * "numberOfRegisters"
+// interleaved channels (one or two registers of four lanes each)
+template <int numberOfRegisters>
+KMETER_TARGET_AVX void filterLanes_Avx(
+    double *samples,
+    const int numberOfSamples,
+    double *state,
+    const int stateStride,
+    const Coefficients &preFilter,
+    const Coefficients &weightingFilter)
+{
+    static_assert(numberOfRegisters == 1 || numberOfRegisters == 2,
+                  "one or two registers only");
+
+    const int numberOfLanes = 4 * numberOfRegisters;
+    const Coefficients_Avx coefficients(preFilter, weightingFilter);
+
+    // two independent registers, so that their calculations
+    // overlap in the CPU's pipeline (with a single register,
+    // "second" duplicates "first" and is never used)
+    State_Avx first(state, stateStride);
+    State_Avx second(state + numberOfLanes - 4, stateStride);
+
+    for (int sample = 0; sample < numberOfLanes * numberOfSamples;
+            sample += numberOfLanes)
+    {
+        double *lanes = samples + sample;
+
+        _mm256_storeu_pd(lanes, filterSample_Avx(
+                             _mm256_loadu_pd(lanes), coefficients, first));
+
+        if (numberOfRegisters == 2)
+        {
+            _mm256_storeu_pd(lanes + 4, filterSample_Avx(
+                                 _mm256_loadu_pd(lanes + 4), coefficients, second));
+        }
+    }
+
+    first.store(state, stateStride);
+
+    if (numberOfRegisters == 2)
+    {
+        second.store(state + 4, stateStride);
+    }
+}
+
+
+// convert planar channels to interleaved lanes, four channels at a
+// time
+template <int numberOfRegisters>
+KMETER_TARGET_AVX void interleave_Avx(
+    const float *const *channels,
+    double *samples,
+    const int numberOfSamples)
+{
+    const int numberOfLanes = 4 * numberOfRegisters;
+    int sample = 0;
+
+    for (; sample + 4 <= numberOfSamples; sample += 4)
+    {
+        for (int n = 0; n < numberOfRegisters; ++n)
+        {
+            __m128 row0 = _mm_loadu_ps(channels[4 * n] + sample);
+            __m128 row1 = _mm_loadu_ps(channels[4 * n + 1] + sample);
+            __m128 row2 = _mm_loadu_ps(channels[4 * n + 2] + sample);
+            __m128 row3 = _mm_loadu_ps(channels[4 * n + 3] + sample);
+
+            _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+            double *destination = samples + numberOfLanes * sample + 4 * n;
+
+            _mm256_storeu_pd(destination,
+                             _mm256_cvtps_pd(row0));
+            _mm256_storeu_pd(destination + numberOfLanes,
+                             _mm256_cvtps_pd(row1));
+            _mm256_storeu_pd(destination + 2 * numberOfLanes,
+                             _mm256_cvtps_pd(row2));
+            _mm256_storeu_pd(destination + 3 * numberOfLanes,
+                             _mm256_cvtps_pd(row3));
+        }
+    }
+
+    for (; sample < numberOfSamples; ++sample)
+    {
+        for (int lane = 0; lane < numberOfLanes; ++lane)
+        {
+            samples[numberOfLanes * sample + lane] = channels[lane][sample];
+        }
+    }
+}
+
+
+// convert interleaved lanes to planar channels, four channels at a
+// time
+template <int numberOfRegisters>
+KMETER_TARGET_AVX void deinterleave_Avx(
+    const double *samples,
+    float *const *channels,
+    const int numberOfSamples)
+{
+    const int numberOfLanes = 4 * numberOfRegisters;
+    int sample = 0;
+
+    for (; sample + 4 <= numberOfSamples; sample += 4)
+    {
+        for (int n = 0; n < numberOfRegisters; ++n)
+        {
+            const double *source = samples + numberOfLanes * sample + 4 * n;
+
+            __m128 row0 = _mm256_cvtpd_ps(_mm256_loadu_pd(source));
+            __m128 row1 = _mm256_cvtpd_ps(_mm256_loadu_pd(source + numberOfLanes));
+            __m128 row2 = _mm256_cvtpd_ps(_mm256_loadu_pd(source + 2 * numberOfLanes));
+            __m128 row3 = _mm256_cvtpd_ps(_mm256_loadu_pd(source + 3 * numberOfLanes));
+
+            _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+            _mm_storeu_ps(channels[4 * n] + sample, row0);
+            _mm_storeu_ps(channels[4 * n + 1] + sample, row1);
+            _mm_storeu_ps(channels[4 * n + 2] + sample, row2);
+            _mm_storeu_ps(channels[4 * n + 3] + sample, row3);
+        }
+    }
+
+    for (; sample < numberOfSamples; ++sample)
+    {
+        for (int lane = 0; lane < numberOfLanes; ++lane)
+        {
+            channels[lane][sample] = static_cast<float>(
+                                         samples[numberOfLanes * sample + lane]);
+        }
+    }
+}
+
+#endif  // JUCE_INTEL
+
+}
+
+
+/// Create a new K-weighting filter.
+///
+/// @param numberOfChannels number of audio channels
+///
+/// @param sampleRate sample rate in Hz
+///
+KWeightingFilter::KWeightingFilter(
+    const int numberOfChannels,
+    const double sampleRate) :
+
+    numberOfChannels_(numberOfChannels),
+    implementation_(selectImplementation(numberOfChannels)),
+    numberOfLanes_(implementation_.numberOfLanes),
+    sampleRate_(sampleRate)
+{
+    // unused lanes of the last group of channels filter silence
+    numberOfPaddedChannels_ = numberOfLanes_ *
+                              ((numberOfChannels_ + numberOfLanes_ - 1) /
+                               numberOfLanes_);
+
+    state_.calloc(numberOfPaddedChannels_ * KMETER_K_WEIGHTING_STATES);
+
+    calculateCoefficients();
+    reset();
+}
+
+
+/// Clear filter state of all channels.
+///
+void KWeightingFilter::reset()
+{
+    for (int n = 0; n < numberOfPaddedChannels_ * KMETER_K_WEIGHTING_STATES; ++n)
+    {
+        state_[n] = 0.0;
+    }
+}
+
+
+/// Change sample rate.  Recalculates the coefficients and clears
+/// the filter state.
+///
+/// @param sampleRate sample rate in Hz
+///
+void KWeightingFilter::setSampleRate(
+    const double sampleRate)
+{
+    sampleRate_ = sampleRate;
+
+    calculateCoefficients();
+    reset();
+}
+
+
+void KWeightingFilter::calculateCoefficients()
+{
+    // filter specifications were taken from Raiden's nice paper
+    // "ITU-R BS.1770-1 filter specifications (unofficial)" as found
+    // on http://www.scribd.com/doc/49991813/ITU-R-BS-1770-1-filters
+    //
+    // please see here for Raiden's original forum thread:
+    // http://www.hydrogenaudio.org/forums/index.php?showtopic=86116
+
+    // initialise pre-filter (ITU-R BS.1770-1)
+    double pf_vh = 1.584864701130855;
+    double pf_vb = sqrt(pf_vh);
+    double pf_vl = 1.0;
+    double pf_q = 0.7071752369554196;
+    double pf_cutoff = 1681.974450955533;
+    double pf_omega = tan(M_PI * pf_cutoff / sampleRate_);
+    double pf_omega_2 = pow(pf_omega, 2.0);
+    double pf_omega_q = pf_omega / pf_q;
+    double pf_div = (pf_omega_2 + pf_omega_q + 1.0);
+
+    preFilter_.b0 = (pf_vl * pf_omega_2 + pf_vb * pf_omega_q + pf_vh) / pf_div;
+    preFilter_.b1 = 2.0 * (pf_vl * pf_omega_2 - pf_vh) / pf_div;
+    preFilter_.b2 = (pf_vl * pf_omega_2 - pf_vb * pf_omega_q + pf_vh) / pf_div;
+
+    preFilter_.a1 = 2.0 * (pf_omega_2 - 1.0) / pf_div;
+    preFilter_.a2 = (pf_omega_2 - pf_omega_q + 1.0) / pf_div;
+
+    // initialise RLB weighting curve (ITU-R BS.1770-1)
+    double rlb_vh = 1.0;
+    double rlb_vb = 0.0;
+    double rlb_vl = 0.0;
+    double rlb_q = 0.5003270373238773;
+    double rlb_cutoff = 38.13547087602444;
+    double rlb_omega = tan(M_PI * rlb_cutoff / sampleRate_);
+    double rlb_omega_2 = pow(rlb_omega, 2.0);
+    double rlb_omega_q = rlb_omega / rlb_q;
+    double rlb_div_1 = (rlb_vl * rlb_omega_2 + rlb_vb * rlb_omega_q + rlb_vh);
+    double rlb_div_2 = (rlb_omega_2 + rlb_omega_q + 1.0);
+
+    weightingFilter_.b0 = 1.0;
+    weightingFilter_.b1 = 2.0 * (rlb_vl * rlb_omega_2 - rlb_vh) / rlb_div_1;
+    weightingFilter_.b2 = (rlb_vl * rlb_omega_2 - rlb_vb * rlb_omega_q + rlb_vh) / rlb_div_1;
+
+    weightingFilter_.a1 = 2.0 * (rlb_omega_2 - 1.0) / rlb_div_2;
+    weightingFilter_.a2 = (rlb_omega_2 - rlb_omega_q + 1.0) / rlb_div_2;
+}
+
+
+/// Apply K-weighting to all channels of an audio buffer.
+///
+/// @param buffer audio samples (will be overwritten)
+///
+/// @param numberOfSamples number of samples to filter
+///
+void KWeightingFilter::processInPlace(
+    AudioBuffer<float> &buffer,
+    const int numberOfSamples)
+{
+    jassert(buffer.getNumChannels() == numberOfChannels_);
+    jassert(buffer.getNumSamples() >= numberOfSamples);
+
+    // the filters decay into denormals on silence; have the CPU
+    // flush them to zero instead of checking every sample (this
+    // may run on a worker thread that does not do so already)
+    ScopedNoDenormals noDenormals;
+
+    for (int channel = 0; channel < numberOfChannels_;
+            channel += numberOfLanes_)
+    {
+        processLanes(buffer, channel, numberOfSamples);
+    }
+}
+
+
+/// Get name of the code path selected for this CPU and number of
+/// channels.
+///
+/// @return name of code path, such as "AVX (8 lanes)"
+///
+String KWeightingFilter::getImplementationName() const
+{
+    return implementation_.name;
+}
+
+
+// filter one group of channels, transposing samples to and from
+// interleaved lanes one tile at a time
+void KWeightingFilter::processLanes(
+    AudioBuffer<float> &buffer,
+    const int firstChannel,
+    const int numberOfSamples)
+{
+    jassert(numberOfLanes_ <= KMETER_K_WEIGHTING_LANES);
+
+    // unused lanes filter silence and their output is discarded
+    float silence[KMETER_K_WEIGHTING_TILE_SIZE] = {};
+    float discarded[KMETER_K_WEIGHTING_TILE_SIZE];
+
+    double tile[KMETER_K_WEIGHTING_TILE_SIZE * KMETER_K_WEIGHTING_LANES];
+    double *state = state_ + firstChannel;
+
+    for (int tileStart = 0; tileStart < numberOfSamples;
+            tileStart += KMETER_K_WEIGHTING_TILE_SIZE)
+    {
+        int tileSize = jmin(KMETER_K_WEIGHTING_TILE_SIZE,
+                            numberOfSamples - tileStart);
+
+        const float *inputChannels[KMETER_K_WEIGHTING_LANES];
+        float *outputChannels[KMETER_K_WEIGHTING_LANES];
+
+        for (int lane = 0; lane < numberOfLanes_; ++lane)
+        {
+            int channel = firstChannel + lane;
+
+            if (channel < numberOfChannels_)
+            {
+                inputChannels[lane] = buffer.getReadPointer(channel, tileStart);
+                outputChannels[lane] = buffer.getWritePointer(channel, tileStart);
+            }
+            else
+            {
+                inputChannels[lane] = silence;
+                outputChannels[lane] = discarded;
+            }
+        }
+
+        implementation_.interleave(inputChannels, tile, tileSize);
+
+        implementation_.filterLanes(tile, tileSize,
+                                    state, numberOfPaddedChannels_,
+                                    preFilter_, weightingFilter_);
+
+        implementation_.deinterleave(tile, outputChannels, tileSize);
+    }
+}
+
+
+// use the narrowest group of lanes that holds all channels
+KWeightingFilter::Implementation KWeightingFilter::selectImplementation(
+    const int numberOfChannels)
+{
+#if JUCE_INTEL
+
+    if (numberOfChannels > 2 && SystemStats::hasAVX())
+    {
+        if (numberOfChannels > 4)
+        {
+            return {"AVX (8 lanes)", 8,
+                    interleave_Avx<2>, filterLanes_Avx<2>, deinterleave_Avx<2>
+                   };
+        }
+
+        return {"AVX (4 lanes)", 4,
+                interleave_Avx<1>, filterLanes_Avx<1>, deinterleave_Avx<1>
+               };
+    }
+
+    if (numberOfChannels > 1 && SystemStats::hasSSE2())
+    {
+        if (numberOfChannels > 2)
+        {
+            return {"SSE2 (4 lanes)", 4,
+                    interleave_Sse2<2>, filterLanes_Sse2<2>, deinterleave_Sse2<2>
+                   };
+        }
+
+        return {"SSE2 (2 lanes)", 2,
+                interleave_Sse2<1>, filterLanes_Sse2<1>, deinterleave_Sse2<1>
+               };
+    }
+
+#endif  // JUCE_INTEL
+
+    ignoreUnused(numberOfChannels);
+
+    return {"scalar", 1,
+            interleave_Scalar, filterLanes_Scalar, deinterleave_Scalar
+           };
+}
@@ -0,0 +1,136 @@
+/* ----------------------------------------------------------------------------
+
+   K-Meter
+   =======
+   Implementation of a K-System meter according to Bob Katz' specifications
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+#ifndef KMETER_K_WEIGHTING_FILTER_H
+#define KMETER_K_WEIGHTING_FILTER_H
+
+#include "FrutHeader.h"
+
+
+/// K-weighting filter of ITU-R BS.1770-1 (pre-filter followed by
+/// the RLB weighting curve).
+///
+/// Both biquads are run as a cascade in double precision
+/// (transposed direct form II).  Samples are filtered in place and
+/// only rounded to float once, after the second stage.  The filter
+/// state lives in registers while a chunk is filtered, and
+/// denormals are flushed to zero by the CPU.
+///
+/// Channels are independent, so they are filtered side by side in
+/// the lanes of SIMD registers.  Depending on the number of
+/// channels and the host's processor, 2 (SSE2), 4 (SSE2 or AVX) or
+/// 8 (AVX) lanes are used; wider groups run two independent chains
+/// of registers to hide the latency of the recursion.  Samples are
+/// transposed between the planar layout of AudioBuffer and the
+/// interleaved lanes one tile at a time, so that surround layouts
+/// cost about the same as stereo.  Every lane performs exactly the
+/// same floating-point operations as the plain C++ code, so results
+/// do not depend on the CPU.
+///
+class KWeightingFilter
+{
+public:
+    KWeightingFilter(const int numberOfChannels,
+                     const double sampleRate);
+
+    void reset();
+    void setSampleRate(const double sampleRate);
+
+    void processInPlace(AudioBuffer<float> &buffer,
+                        const int numberOfSamples);
+
+    String getImplementationName() const;
+
+    /// Coefficients of a biquad.  The output coefficients are
+    /// normalised to a0 = 1.0 and enter with a negative sign.
+    struct Coefficients
+    {
+        double b0;
+        double b1;
+        double b2;
+
+        double a1;
+        double a2;
+    };
+
+private:
+    JUCE_LEAK_DETECTOR(KWeightingFilter);
+
+    // state variables per channel (two per biquad)
+    static const int KMETER_K_WEIGHTING_STATES = 4;
+
+    // maximum number of lanes
+    static const int KMETER_K_WEIGHTING_LANES = 8;
+
+    // samples per tile of interleaved lanes (16 kB with 8 lanes)
+    static const int KMETER_K_WEIGHTING_TILE_SIZE = 256;
+
+    struct Implementation
+    {
+        const char *name;
+        int numberOfLanes;
+
+        // converts one planar channel per lane to interleaved lanes
+        void (*interleave)(const float *const *channels,
+                           double *samples,
+                           const int numberOfSamples);
+
+        // filters interleaved lanes in place; state variable "n" of
+        // lane "l" is stored in state[n * stateStride + l]
+        void (*filterLanes)(double *samples,
+                            const int numberOfSamples,
+                            double *state,
+                            const int stateStride,
+                            const Coefficients &preFilter,
+                            const Coefficients &weightingFilter);
+
+        // converts interleaved lanes back to planar channels
+        void (*deinterleave)(const double *samples,
+                             float *const *channels,
+                             const int numberOfSamples);
+    };
+
+    static Implementation selectImplementation(const int numberOfChannels);
+
+    void calculateCoefficients();
+
+    void processLanes(AudioBuffer<float> &buffer,
+                      const int firstChannel,
+                      const int numberOfSamples);
+
+    int numberOfChannels_;
+    Implementation implementation_;
+
+    int numberOfLanes_;
+    int numberOfPaddedChannels_;
+    double sampleRate_;
+
+    Coefficients preFilter_;
+    Coefficients weightingFilter_;
+
+    HeapBlock<double> state_;
+};
+
+#endif  // KMETER_K_WEIGHTING_FILTER_H
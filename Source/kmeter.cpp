@@ -32,7 +32,9 @@ void Kmeter::create(
     // this component blends in with the background
     setOpaque(false);
 
-    // clear old meters and peak labels
+    // clear old meters and peak labels (meter renderer refers to
+    // meter bars)
+    meterRenderer_.clear();
     levelMeters_.clear();
     overflowMeters_.clear();
     maximumPeakLabels_.clear();
@@ -94,6 +96,7 @@ void Kmeter::applySkin(
     segmentColours.add(segmentGreen);
     segmentColours.add(segmentNonLinear);
 
+    meterRenderer_.clear();
     levelMeters_.clear();
     overflowMeters_.clear();
     maximumPeakLabels_.clear();
@@ -112,7 +115,9 @@ void Kmeter::applySkin(
 
         meterBar->setEnabled(isEnabled());
 
-        addAndMakeVisible(meterBar);
+        // meter bars are laid out as usual, but painted by the meter
+        // renderer
+        addChildComponent(meterBar);
 
         OverflowMeter *overflowMeter = overflowMeters_.add(
                                            new OverflowMeter());
@@ -223,6 +228,15 @@ void Kmeter::applySkin(
             " channels) not supported");
     }
 
+    for (int channel = 0; channel < numberOfInputChannels_; ++channel)
+    {
+        meterRenderer_.addMeterBar(levelMeters_[channel]);
+    }
+
+    // meter bars are painted from scratch
+    meterRenderer_.fetchDirtyRegion();
+    repaint();
+
     Component *parent = getParentComponent();
 
     if (parent != nullptr)
@@ -232,39 +246,66 @@ void Kmeter::applySkin(
 }
 
 
+void Kmeter::paint(
+    Graphics &g)
+
+{
+    meterRenderer_.paint(g);
+}
+
+
 void Kmeter::resized()
 {
 }
 
 
+void Kmeter::enablementChanged()
+{
+    repaint();
+}
+
+
 void Kmeter::setLevels(
-    std::shared_ptr<MeterBallistics> meterBallistics)
+    const MeterSnapshot &meterSnapshot)
 
 {
-    for (int channel = 0; channel < numberOfInputChannels_; ++channel)
+    int numberOfChannels = jmin(numberOfInputChannels_,
+                                meterSnapshot.numberOfChannels);
+
+    for (int channel = 0; channel < numberOfChannels; ++channel)
     {
         if (displayPeakMeter_)
         {
-            levelMeters_[channel]->setLevels(
-                meterBallistics->getAverageMeterLevel(channel),
-                meterBallistics->getAverageMeterPeakLevel(channel),
-                meterBallistics->getPeakMeterLevel(channel),
-                meterBallistics->getPeakMeterPeakLevel(channel));
+            meterRenderer_.setLevels(
+                channel,
+                meterSnapshot.averageMeterLevels[channel],
+                meterSnapshot.averageMeterPeakLevels[channel],
+                meterSnapshot.peakMeterLevels[channel],
+                meterSnapshot.peakMeterPeakLevels[channel]);
         }
         else
         {
-            levelMeters_[channel]->setNormalLevels(
-                meterBallistics->getAverageMeterLevel(channel),
-                meterBallistics->getAverageMeterPeakLevel(channel));
+            meterRenderer_.setNormalLevels(
+                channel,
+                meterSnapshot.averageMeterLevels[channel],
+                meterSnapshot.averageMeterPeakLevels[channel]);
         }
 
         maximumPeakLabels_[channel]->updateLevel(
-            meterBallistics->getMaximumPeakLevel(channel));
+            meterSnapshot.maximumPeakLevels[channel]);
 
         maximumTruePeakLabels_[channel]->updateLevel(
-            meterBallistics->getMaximumTruePeakLevel(channel));
+            meterSnapshot.maximumTruePeakLevels[channel]);
 
         overflowMeters_[channel]->setOverflows(
-            meterBallistics->getNumberOfOverflows(channel));
+            meterSnapshot.numberOfOverflows[channel]);
+    }
+
+    // re-paint all changed meter segments at once
+    Rectangle<int> dirtyRegion = meterRenderer_.fetchDirtyRegion();
+
+    if (!dirtyRegion.isEmpty())
+    {
+        repaint(dirtyRegion);
     }
 }
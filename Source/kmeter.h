@@ -50,11 +50,16 @@ public:
                            bool isHorizontal,
                            bool displayPeakMeter);
 
-    virtual void setLevels(std::shared_ptr<MeterBallistics> meterBallistics);
+    virtual void setLevels(const MeterSnapshot &meterSnapshot);
 
+    virtual void paint(Graphics &g);
     virtual void resized();
+    virtual void enablementChanged();
 
 protected:
+    // draws all meter bars in a single pass
+    frut::widgets::MeterRenderer meterRenderer_;
+
     OwnedArray<MeterBar> levelMeters_;
     OwnedArray<OverflowMeter> overflowMeters_;
     OwnedArray<PeakLabel> maximumPeakLabels_;
@@ -643,6 +643,123 @@ float MeterBallistics::getPhaseCorrelation()
 }
 
 
+void MeterBallistics::getSnapshot(
+    MeterSnapshot &snapshot)
+/*  Copy all current meter readings to a snapshot that can be passed
+    to another thread.
+
+    snapshot (MeterSnapshot): will receive the meter readings
+
+    return value: none
+*/
+{
+    jassert(nNumberOfChannels <=
+            MeterSnapshot::maximumNumberOfChannels);
+
+    snapshot.numberOfChannels = jmin(nNumberOfChannels,
+                                     MeterSnapshot::maximumNumberOfChannels);
+
+    // use getters so that readings of single-meter algorithms (such
+    // as ITU-R BS.1770) are handled correctly
+    for (int nChannel = 0; nChannel < snapshot.numberOfChannels;
+            ++nChannel)
+    {
+        snapshot.peakMeterLevels[nChannel] = getPeakMeterLevel(nChannel);
+        snapshot.peakMeterPeakLevels[nChannel] =
+            getPeakMeterPeakLevel(nChannel);
+
+        snapshot.truePeakMeterLevels[nChannel] =
+            getTruePeakMeterLevel(nChannel);
+        snapshot.truePeakMeterPeakLevels[nChannel] =
+            getTruePeakMeterPeakLevel(nChannel);
+
+        snapshot.averageMeterLevels[nChannel] = getAverageMeterLevel(nChannel);
+        snapshot.averageMeterPeakLevels[nChannel] =
+            getAverageMeterPeakLevel(nChannel);
+
+        snapshot.maximumPeakLevels[nChannel] = getMaximumPeakLevel(nChannel);
+        snapshot.maximumTruePeakLevels[nChannel] =
+            getMaximumTruePeakLevel(nChannel);
+        snapshot.numberOfOverflows[nChannel] = getNumberOfOverflows(nChannel);
+    }
+
+    snapshot.stereoMeterValue = getStereoMeterValue();
+    snapshot.phaseCorrelation = getPhaseCorrelation();
+}
+
+
+void MeterBallistics::interpolateSnapshot(
+    const MeterSnapshot &snapshotOld,
+    const MeterSnapshot &snapshotNew,
+    float fFraction,
+    MeterSnapshot &snapshotResult)
+/*  Interpolate meter readings between two snapshots.  This allows
+    the editor to display meter ballistics at its own frame rate,
+    which is independent of the rate at which audio chunks are
+    processed.
+
+    snapshotOld (MeterSnapshot): readings at the start of the interval
+
+    snapshotNew (MeterSnapshot): readings at the end of the interval
+    (must have the same number of channels)
+
+    fFraction (float): position within interval (0.0 to 1.0)
+
+    snapshotResult (MeterSnapshot): will receive interpolated readings
+
+    return value: none
+*/
+{
+    jassert(snapshotOld.numberOfChannels == snapshotNew.numberOfChannels);
+
+    float fWeightNew = jlimit(0.0f, 1.0f, fFraction);
+    float fWeightOld = 1.0f - fWeightNew;
+
+    snapshotResult.numberOfChannels = snapshotNew.numberOfChannels;
+
+    for (int nChannel = 0; nChannel < snapshotNew.numberOfChannels; ++nChannel)
+    {
+        // meter levels and peak marks are moving, so interpolate them
+        snapshotResult.peakMeterLevels[nChannel] =
+            fWeightOld * snapshotOld.peakMeterLevels[nChannel] +
+            fWeightNew * snapshotNew.peakMeterLevels[nChannel];
+        snapshotResult.peakMeterPeakLevels[nChannel] =
+            fWeightOld * snapshotOld.peakMeterPeakLevels[nChannel] +
+            fWeightNew * snapshotNew.peakMeterPeakLevels[nChannel];
+
+        snapshotResult.truePeakMeterLevels[nChannel] =
+            fWeightOld * snapshotOld.truePeakMeterLevels[nChannel] +
+            fWeightNew * snapshotNew.truePeakMeterLevels[nChannel];
+        snapshotResult.truePeakMeterPeakLevels[nChannel] =
+            fWeightOld * snapshotOld.truePeakMeterPeakLevels[nChannel] +
+            fWeightNew * snapshotNew.truePeakMeterPeakLevels[nChannel];
+
+        snapshotResult.averageMeterLevels[nChannel] =
+            fWeightOld * snapshotOld.averageMeterLevels[nChannel] +
+            fWeightNew * snapshotNew.averageMeterLevels[nChannel];
+        snapshotResult.averageMeterPeakLevels[nChannel] =
+            fWeightOld * snapshotOld.averageMeterPeakLevels[nChannel] +
+            fWeightNew * snapshotNew.averageMeterPeakLevels[nChannel];
+
+        // maximum levels and overflows are counters, so do not
+        // interpolate them
+        snapshotResult.maximumPeakLevels[nChannel] =
+            snapshotNew.maximumPeakLevels[nChannel];
+        snapshotResult.maximumTruePeakLevels[nChannel] =
+            snapshotNew.maximumTruePeakLevels[nChannel];
+        snapshotResult.numberOfOverflows[nChannel] =
+            snapshotNew.numberOfOverflows[nChannel];
+    }
+
+    snapshotResult.stereoMeterValue =
+        fWeightOld * snapshotOld.stereoMeterValue +
+        fWeightNew * snapshotNew.stereoMeterValue;
+    snapshotResult.phaseCorrelation =
+        fWeightOld * snapshotOld.phaseCorrelation +
+        fWeightNew * snapshotNew.phaseCorrelation;
+}
+
+
 void MeterBallistics::setPhaseCorrelation(
     float fTimePassed,
     float fPhaseCorrelationNew)
@@ -27,6 +27,7 @@
 #define KMETER_METER_BALLISTICS_H
 
 #include "FrutHeader.h"
+#include "meter_snapshot.h"
 #include "plugin_parameters.h"
 
 
@@ -66,6 +67,12 @@ public:
     void setPhaseCorrelation(float fTimePassed,
                              float fPhaseCorrelationNew);
 
+    void getSnapshot(MeterSnapshot &snapshot);
+    static void interpolateSnapshot(const MeterSnapshot &snapshotOld,
+                                    const MeterSnapshot &snapshotNew,
+                                    float fFraction,
+                                    MeterSnapshot &snapshotResult);
+
     void updateChannel(int nChannel,
                        float fTimePassed,
                        float fPeak,
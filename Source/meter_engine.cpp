@@ -0,0 +1,619 @@
+/* ----------------------------------------------------------------------------
+
+   K-Meter
+   =======
+   Implementation of a K-System meter according to Bob Katz' specifications
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+#include "meter_engine.h"
+
+
+
+/// Create a new meter engine.
+///
+/// @param numberOfChannels number of audio channels
+///
+/// @param sampleRate sample rate of audio (in Hz)
+///
+/// @param bufferSize number of samples in a chunk
+///
+/// @param meterBallistics meter ballistics that receive all readings
+///
+/// @param averageAlgorithm initial algorithm for averaging
+///
+/// @param lowPassFilter low-pass filter applied before averaging
+///        (FIR, IIR or none); cannot be changed later on
+///
+/// @param shouldDecimate average at a reduced sample rate (at least
+///        44.1 kHz) to save CPU at high sample rates
+///
+/// @param useFftTruePeakMeter determine true peak levels with the
+///        original FFT-based oversampler instead of the polyphase
+///        interpolator (ITU-R BS.1770-4, Annex 2); only useful for
+///        comparing their readings
+///
+MeterEngine::MeterEngine(
+    const int numberOfChannels,
+    const double sampleRate,
+    const int bufferSize,
+    std::shared_ptr<MeterBallistics> meterBallistics,
+    const int averageAlgorithm,
+    const int lowPassFilter,
+    const bool shouldDecimate,
+    const bool useFftTruePeakMeter) :
+    meterBallistics_(meterBallistics),
+    numberOfChannels_(numberOfChannels),
+    bufferSize_(bufferSize),
+    sampleRate_(sampleRate)
+{
+    jassert(meterBallistics_ != nullptr);
+
+    isStereo_ = (numberOfChannels_ == 2);
+
+    for (int channel = 0; channel < numberOfChannels_; ++channel)
+    {
+        peakLevels_.add(0.0f);
+        rmsLevels_.add(0.0f);
+        averageLevelsFiltered_.add(MeterBallistics::getMeterMinimumDecibel());
+        truePeakLevels_.add(0.0f);
+
+        overflowCounts_.add(0);
+    }
+
+    averageLevelFiltered_ = std::make_unique<AverageLevelFiltered>(
+                                numberOfChannels_,
+                                (int) sampleRate_,
+                                bufferSize_,
+                                averageAlgorithm,
+                                lowPassFilter,
+                                shouldDecimate);
+
+    // the polyphase interpolator under-reads by at most 0.169 dB at
+    // four-fold oversampling (Annex 2 of ITU-R BS.1770-4); its
+    // filters for eight- and two-fold oversampling are flat to
+    // within 0.1 dB up to 0.45 times the sample rate
+    int oversamplingFactor = 8;
+
+    if (sampleRate_ >= 176400)
+    {
+        oversamplingFactor /= 4;
+    }
+    else if (sampleRate_ >= 88200)
+    {
+        oversamplingFactor /= 2;
+    }
+
+    if (useFftTruePeakMeter)
+    {
+        truePeakMeter_ = std::make_unique<frut::dsp::TruePeakMeter>(
+                             numberOfChannels_,
+                             bufferSize_,
+                             oversamplingFactor);
+    }
+    else
+    {
+        truePeakMeterPolyphase_ =
+            std::make_unique<frut::dsp::TruePeakMeterPolyphase>(
+                numberOfChannels_,
+                bufferSize_,
+                oversamplingFactor);
+    }
+}
+
+
+/// Clear filter states.  Meter ballistics are left alone.
+///
+void MeterEngine::reset()
+{
+    averageLevelFiltered_->reset();
+
+    if (truePeakMeter_)
+    {
+        truePeakMeter_->reset();
+    }
+    else
+    {
+        truePeakMeterPolyphase_->reset();
+    }
+}
+
+
+/// Get number of audio channels.
+///
+/// @return number of channels
+///
+int MeterEngine::getNumberOfChannels() const
+{
+    return numberOfChannels_;
+}
+
+
+/// Get number of samples in a chunk.
+///
+/// @return chunk size
+///
+int MeterEngine::getBufferSize() const
+{
+    return bufferSize_;
+}
+
+
+/// Get sample rate.
+///
+/// @return sample rate (in Hz)
+///
+double MeterEngine::getSampleRate() const
+{
+    return sampleRate_;
+}
+
+
+/// Get current algorithm for averaging.
+///
+/// @return averaging algorithm
+///
+int MeterEngine::getAverageAlgorithm() const
+{
+    return averageLevelFiltered_->getAlgorithm();
+}
+
+
+/// Set algorithm for averaging.  Call getAverageAlgorithm() to find
+/// out which algorithm is actually used.
+///
+/// Both algorithms are prepared when the engine is created, so this
+/// is lock-free and cheap enough for the audio thread.  The switch
+/// takes effect at the start of the next chunk.
+///
+/// @param averageAlgorithm new averaging algorithm
+///
+void MeterEngine::setAverageAlgorithm(
+    const int averageAlgorithm)
+{
+    averageLevelFiltered_->setAlgorithm(averageAlgorithm);
+}
+
+
+/// Get low-pass filter that is applied before averaging.
+///
+/// @return low-pass filter (FIR, IIR or none)
+///
+int MeterEngine::getLowPassFilter() const
+{
+    return averageLevelFiltered_->getLowPassFilter();
+}
+
+
+/// Get factor by which the sample rate is reduced before averaging.
+///
+/// @return decimation factor (1, 2 or 4)
+///
+int MeterEngine::getDecimationFactor() const
+{
+    return averageLevelFiltered_->getDecimationFactor();
+}
+
+
+/// Measure a chunk of audio and update meter ballistics.
+///
+/// @param buffer audio chunk; must contain getBufferSize() samples
+///
+/// @param isMono if **true**, the second channel is assumed to be
+///        identical to the first one
+///
+void MeterEngine::processChunk(
+    const AudioBuffer<float> &buffer,
+    const bool isMono)
+{
+    int chunkSize = buffer.getNumSamples();
+
+    jassert(buffer.getNumChannels() == numberOfChannels_);
+    jassert(chunkSize == bufferSize_);
+
+    // length of buffer chunk in fractional seconds
+    // (1024 samples / 44100 samples/s = 23.2 ms)
+    float processedSeconds = static_cast<float>(chunkSize) /
+                             static_cast<float>(sampleRate_);
+
+    // copy buffer to determine average level
+    averageLevelFiltered_->copyFrom(buffer, chunkSize);
+
+    // copy buffer to determine true peak level
+    if (truePeakMeter_)
+    {
+        truePeakMeter_->copyFrom(buffer, chunkSize);
+    }
+    else
+    {
+        truePeakMeterPolyphase_->copyFrom(buffer, chunkSize);
+    }
+
+    // treat all samples above -0.001 dBFS as overflow
+    //
+    // in the 16-bit domain, full scale corresponds to an absolute
+    // integer value of 32'767 or 32'768, so we'll treat absolute
+    // levels of 32'767 and above as overflows; this corresponds to a
+    // floating-point level of 32'767 / 32'768 = 0.9999694
+    // (approx. -0.001 dBFS).
+    const float limitOverflow = 0.9999f;
+
+    // measure both channels of a stereo signal and their correlation
+    // in a single pass
+    bool isStereoPair = isStereo_ && !isMono;
+
+    ChunkStatistics stereoStatistics[2] = {};
+    double sumOfProducts = 0.0;
+
+    if (isStereoPair)
+    {
+        sumOfProducts = measureStereoChannels(buffer.getReadPointer(0),
+                                              buffer.getReadPointer(1),
+                                              chunkSize,
+                                              limitOverflow,
+                                              stereoStatistics[0],
+                                              stereoStatistics[1]);
+    }
+
+    for (int channel = 0; channel < numberOfChannels_; ++channel)
+    {
+        if (isMono && (channel == 1))
+        {
+            peakLevels_.set(channel, peakLevels_[0]);
+            rmsLevels_.set(channel, rmsLevels_[0]);
+            averageLevelsFiltered_.set(channel, averageLevelsFiltered_[0]);
+            truePeakLevels_.set(channel, truePeakLevels_[0]);
+
+            overflowCounts_.set(channel, overflowCounts_[0]);
+        }
+        else
+        {
+            // determine peak level, RMS level and overflows for
+            // chunkSize samples
+            ChunkStatistics statistics =
+                (isStereoPair) ?
+                stereoStatistics[channel] :
+                measureChannel(buffer.getReadPointer(channel),
+                               chunkSize,
+                               limitOverflow);
+
+            peakLevels_.set(
+                channel,
+                statistics.peakLevel);
+
+            rmsLevels_.set(
+                channel,
+                static_cast<float>(sqrt(statistics.sumOfSquares /
+                                        chunkSize)));
+
+            overflowCounts_.set(
+                channel,
+                statistics.overflowCount);
+
+            // determine filtered average level for chunkSize samples
+            // (please note that this level has already been converted
+            // to decibels!)
+            averageLevelsFiltered_.set(
+                channel,
+                averageLevelFiltered_->getLevel(channel));
+
+            // determine true peak level for chunkSize samples
+            truePeakLevels_.set(
+                channel,
+                truePeakMeter_ ?
+                truePeakMeter_->getLevel(channel) :
+                truePeakMeterPolyphase_->getLevel(channel));
+        }
+
+        // apply meter ballistics
+        meterBallistics_->updateChannel(channel,
+                                        processedSeconds,
+                                        peakLevels_[channel],
+                                        truePeakLevels_[channel],
+                                        averageLevelsFiltered_[channel],
+                                        overflowCounts_[channel]);
+    }
+
+    // phase correlation is only defined for stereo signals
+    if (isStereo_)
+    {
+        float phaseCorrelation = 1.0f;
+
+        // check whether the stereo signal has been mixed down to mono
+        if (isMono)
+        {
+            phaseCorrelation = 1.0f;
+        }
+        // otherwise, process only RMS levels at or above -80 dB
+        else if ((rmsLevels_[0] >= 0.0001f) || (rmsLevels_[1] >= 0.0001f))
+        {
+            double sumsOfSquares = stereoStatistics[0].sumOfSquares *
+                                   stereoStatistics[1].sumOfSquares;
+
+            // prevent division by zero and taking the square root of
+            // a negative number
+            if (sumsOfSquares > 0.0)
+            {
+                phaseCorrelation = static_cast<float>(
+                                       sumOfProducts / sqrt(sumsOfSquares));
+            }
+            else
+            {
+                // this is mathematically incorrect, but "musically"
+                // correct (i.e. signal is mono-compatible)
+                phaseCorrelation = 1.0f;
+            }
+        }
+
+        meterBallistics_->setPhaseCorrelation(processedSeconds,
+                                              phaseCorrelation);
+
+        float stereoMeterValue = 0.0f;
+
+        // do not process RMS levels below -80 dB
+        if ((rmsLevels_[0] < 0.0001f) && (rmsLevels_[1] < 0.0001f))
+        {
+            stereoMeterValue = 0.0f;
+        }
+        else if (rmsLevels_[1] >= rmsLevels_[0])
+        {
+            stereoMeterValue = 1.0f - rmsLevels_[0] / rmsLevels_[1];
+        }
+        else
+        {
+            stereoMeterValue = rmsLevels_[1] / rmsLevels_[0] - 1.0f;
+        }
+
+        meterBallistics_->setStereoMeterValue(processedSeconds,
+                                              stereoMeterValue);
+    }
+}
+
+
+/// Get peak level of the most recently processed chunk.
+///
+/// @param channel audio channel
+///
+/// @return peak level (linear scale)
+///
+float MeterEngine::getPeakLevel(
+    const int channel) const
+{
+    return peakLevels_[channel];
+}
+
+
+/// Get true peak level of the most recently processed chunk.
+///
+/// @param channel audio channel
+///
+/// @return true peak level (linear scale)
+///
+float MeterEngine::getTruePeakLevel(
+    const int channel) const
+{
+    return truePeakLevels_[channel];
+}
+
+
+/// Get number of overflows in the most recently processed chunk.
+///
+/// @param channel audio channel
+///
+/// @return number of overflows
+///
+int MeterEngine::getOverflowCount(
+    const int channel) const
+{
+    return overflowCounts_[channel];
+}
+
+
+/// Copy output of average filter (useful for debugging filters).
+///
+/// @param destination destination buffer
+///
+/// @param numberOfSamples number of samples to copy
+///
+void MeterEngine::copyFilteredTo(
+    AudioBuffer<float> &destination,
+    const int numberOfSamples)
+{
+    averageLevelFiltered_->copyTo(destination, numberOfSamples);
+}
+
+
+/// Create an accumulator with empty statistics.
+///
+/// @param limitOverflow sample amplitude that does just *not* count as
+///        an overflow (absolute value)
+///
+MeterEngine::ChunkAccumulator::ChunkAccumulator(
+    const float limitOverflow) :
+    limitOverflow_(limitOverflow)
+{
+    for (int lane = 0; lane < numberOfLanes; ++lane)
+    {
+        peakLevels_[lane] = 0.0f;
+        sumsOfSquares_[lane] = 0.0;
+        overflowCounts_[lane] = 0;
+    }
+}
+
+
+/// Add a sample to the statistics.
+///
+/// @param lane accumulator lane (consecutive samples should use
+///        consecutive lanes)
+///
+/// @param sampleValue sample to add
+///
+inline void MeterEngine::ChunkAccumulator::add(
+    const int lane,
+    const float sampleValue)
+{
+    float amplitude = std::abs(sampleValue);
+
+    // branchless to allow vectorisation
+    peakLevels_[lane] = (amplitude > peakLevels_[lane]) ?
+                        amplitude : peakLevels_[lane];
+
+    sumsOfSquares_[lane] += static_cast<double>(sampleValue) *
+                            static_cast<double>(sampleValue);
+
+    // an overflow has occurred if the amplitude lies above the
+    // overflow limit
+    overflowCounts_[lane] += (amplitude > limitOverflow_) ? 1 : 0;
+}
+
+
+/// Combine the lanes of the accumulator.
+///
+/// @return statistics of all added samples
+///
+MeterEngine::ChunkStatistics MeterEngine::ChunkAccumulator::getStatistics() const
+{
+    ChunkStatistics statistics;
+
+    statistics.peakLevel = 0.0f;
+    statistics.sumOfSquares = 0.0;
+    statistics.overflowCount = 0;
+
+    for (int lane = 0; lane < numberOfLanes; ++lane)
+    {
+        statistics.peakLevel = jmax(statistics.peakLevel,
+                                    peakLevels_[lane]);
+        statistics.sumOfSquares += sumsOfSquares_[lane];
+        statistics.overflowCount += overflowCounts_[lane];
+    }
+
+    return statistics;
+}
+
+
+/// Determine peak level, sum of squares and number of overflows of
+/// a channel in a single pass.
+///
+/// @param samples audio samples to process
+///
+/// @param numberOfSamples number of samples to process
+///
+/// @param limitOverflow sample amplitude that does just *not* count as
+///        an overflow (absolute value)
+///
+/// @return statistics of the channel
+///
+MeterEngine::ChunkStatistics MeterEngine::measureChannel(
+    const float *samples,
+    const int numberOfSamples,
+    const float limitOverflow)
+{
+    const int numberOfLanes = ChunkAccumulator::numberOfLanes;
+    int numberOfBlockSamples = numberOfSamples - (numberOfSamples % numberOfLanes);
+
+    ChunkAccumulator accumulator(limitOverflow);
+
+    for (int sample = 0; sample < numberOfBlockSamples; sample += numberOfLanes)
+    {
+        for (int lane = 0; lane < numberOfLanes; ++lane)
+        {
+            accumulator.add(lane, samples[sample + lane]);
+        }
+    }
+
+    for (int sample = numberOfBlockSamples; sample < numberOfSamples; ++sample)
+    {
+        accumulator.add(0, samples[sample]);
+    }
+
+    return accumulator.getStatistics();
+}
+
+
+/// Determine peak levels, sums of squares and numbers of overflows
+/// of two channels as well as the sum of their products in a single
+/// pass.
+///
+/// @param leftSamples audio samples of left channel
+///
+/// @param rightSamples audio samples of right channel
+///
+/// @param numberOfSamples number of samples to process
+///
+/// @param limitOverflow sample amplitude that does just *not* count as
+///        an overflow (absolute value)
+///
+/// @param leftStatistics receives statistics of left channel
+///
+/// @param rightStatistics receives statistics of right channel
+///
+/// @return sum of products of left and right samples
+///
+double MeterEngine::measureStereoChannels(
+    const float *leftSamples,
+    const float *rightSamples,
+    const int numberOfSamples,
+    const float limitOverflow,
+    ChunkStatistics &leftStatistics,
+    ChunkStatistics &rightStatistics)
+{
+    const int numberOfLanes = ChunkAccumulator::numberOfLanes;
+    int numberOfBlockSamples = numberOfSamples - (numberOfSamples % numberOfLanes);
+
+    ChunkAccumulator leftAccumulator(limitOverflow);
+    ChunkAccumulator rightAccumulator(limitOverflow);
+    double sumsOfProducts[numberOfLanes] = {};
+
+    for (int sample = 0; sample < numberOfBlockSamples; sample += numberOfLanes)
+    {
+        for (int lane = 0; lane < numberOfLanes; ++lane)
+        {
+            float leftValue = leftSamples[sample + lane];
+            float rightValue = rightSamples[sample + lane];
+
+            leftAccumulator.add(lane, leftValue);
+            rightAccumulator.add(lane, rightValue);
+
+            sumsOfProducts[lane] += static_cast<double>(leftValue) *
+                                    static_cast<double>(rightValue);
+        }
+    }
+
+    for (int sample = numberOfBlockSamples; sample < numberOfSamples; ++sample)
+    {
+        leftAccumulator.add(0, leftSamples[sample]);
+        rightAccumulator.add(0, rightSamples[sample]);
+
+        sumsOfProducts[0] += static_cast<double>(leftSamples[sample]) *
+                             static_cast<double>(rightSamples[sample]);
+    }
+
+    leftStatistics = leftAccumulator.getStatistics();
+    rightStatistics = rightAccumulator.getStatistics();
+
+    double sumOfProducts = 0.0;
+
+    for (int lane = 0; lane < numberOfLanes; ++lane)
+    {
+        sumOfProducts += sumsOfProducts[lane];
+    }
+
+    return sumOfProducts;
+}
@@ -0,0 +1,139 @@
+/* ----------------------------------------------------------------------------
+
+   K-Meter
+   =======
+   Implementation of a K-System meter according to Bob Katz' specifications
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+#ifndef KMETER_METER_ENGINE_H
+#define KMETER_METER_ENGINE_H
+
+#include "FrutHeader.h"
+#include "average_level_filtered.h"
+#include "meter_ballistics.h"
+
+
+/// Measures chunks of audio and feeds the results to meter
+/// ballistics.  This class contains everything needed to meter a
+/// signal, but knows nothing about hosts, ring buffers or editors.
+/// It is shared by the plug-in and the offline analyser, so both
+/// produce identical readings.
+///
+class MeterEngine
+{
+public:
+    MeterEngine(const int numberOfChannels,
+                const double sampleRate,
+                const int bufferSize,
+                std::shared_ptr<MeterBallistics> meterBallistics,
+                const int averageAlgorithm,
+                const int lowPassFilter =
+                    KmeterPluginParameters::selLowPassFir,
+                const bool shouldDecimate = false,
+                const bool useFftTruePeakMeter = false);
+
+    void reset();
+
+    int getNumberOfChannels() const;
+    int getBufferSize() const;
+    double getSampleRate() const;
+
+    int getAverageAlgorithm() const;
+    void setAverageAlgorithm(const int averageAlgorithm);
+
+    int getLowPassFilter() const;
+    int getDecimationFactor() const;
+
+    void processChunk(const AudioBuffer<float> &buffer,
+                      const bool isMono);
+
+    float getPeakLevel(const int channel) const;
+    float getTruePeakLevel(const int channel) const;
+    int getOverflowCount(const int channel) const;
+
+    void copyFilteredTo(AudioBuffer<float> &destination,
+                        const int numberOfSamples);
+
+private:
+    JUCE_LEAK_DETECTOR(MeterEngine);
+
+    /// Statistics of a single channel of an audio chunk.
+    struct ChunkStatistics
+    {
+        float peakLevel;
+        double sumOfSquares;
+        int overflowCount;
+    };
+
+    /// Accumulates chunk statistics in independent lanes, so that
+    /// the compiler may vectorise the loop without re-ordering
+    /// floating-point additions.
+    class ChunkAccumulator
+    {
+    public:
+        static const int numberOfLanes = 4;
+
+        ChunkAccumulator(const float limitOverflow);
+
+        inline void add(const int lane,
+                        const float sampleValue);
+
+        ChunkStatistics getStatistics() const;
+
+    private:
+        const float limitOverflow_;
+
+        float peakLevels_[numberOfLanes];
+        double sumsOfSquares_[numberOfLanes];
+        int overflowCounts_[numberOfLanes];
+    };
+
+    static ChunkStatistics measureChannel(const float *samples,
+                                          const int numberOfSamples,
+                                          const float limitOverflow);
+
+    static double measureStereoChannels(const float *leftSamples,
+                                        const float *rightSamples,
+                                        const int numberOfSamples,
+                                        const float limitOverflow,
+                                        ChunkStatistics &leftStatistics,
+                                        ChunkStatistics &rightStatistics);
+
+    std::unique_ptr<AverageLevelFiltered> averageLevelFiltered_;
+    std::unique_ptr<frut::dsp::TruePeakMeter> truePeakMeter_;
+    std::unique_ptr<frut::dsp::TruePeakMeterPolyphase> truePeakMeterPolyphase_;
+    std::shared_ptr<MeterBallistics> meterBallistics_;
+
+    const int numberOfChannels_;
+    const int bufferSize_;
+    const double sampleRate_;
+
+    bool isStereo_;
+
+    Array<float> peakLevels_;
+    Array<float> rmsLevels_;
+    Array<float> averageLevelsFiltered_;
+    Array<float> truePeakLevels_;
+
+    Array<int> overflowCounts_;
+};
+
+#endif  // KMETER_METER_ENGINE_H
@@ -0,0 +1,57 @@
+/* ----------------------------------------------------------------------------
+
+   K-Meter
+   =======
+   Implementation of a K-System meter according to Bob Katz' specifications
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+#ifndef KMETER_METER_SNAPSHOT_H
+#define KMETER_METER_SNAPSHOT_H
+
+
+// Meter readings of all channels at one point in time.  This is
+// plain data so that the audio thread can publish it to the editor
+// through a wait-free triple buffer (see "MeterBallistics").
+struct MeterSnapshot
+{
+    // stereo and 5.1 surround
+    static const int maximumNumberOfChannels = 6;
+
+    int numberOfChannels;
+
+    float peakMeterLevels[maximumNumberOfChannels];
+    float peakMeterPeakLevels[maximumNumberOfChannels];
+
+    float truePeakMeterLevels[maximumNumberOfChannels];
+    float truePeakMeterPeakLevels[maximumNumberOfChannels];
+
+    float averageMeterLevels[maximumNumberOfChannels];
+    float averageMeterPeakLevels[maximumNumberOfChannels];
+
+    float maximumPeakLevels[maximumNumberOfChannels];
+    float maximumTruePeakLevels[maximumNumberOfChannels];
+    int numberOfOverflows[maximumNumberOfChannels];
+
+    float stereoMeterValue;
+    float phaseCorrelation;
+};
+
+#endif  // KMETER_METER_SNAPSHOT_H
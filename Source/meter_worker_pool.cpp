@@ -0,0 +1,330 @@
+/* ----------------------------------------------------------------------------
+
+   K-Meter
+   =======
+   Implementation of a K-System meter according to Bob Katz' specifications
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+#include "meter_worker_pool.h"
+
+
+MeterWorkerPool::Client::Client() :
+    isBusy_(false),
+    isIdle_(true)
+{
+    isIdle_.signal();
+}
+
+
+/// Create a new worker pool.  Workers are started when the first
+/// client is added.
+///
+MeterWorkerPool::MeterWorkerPool() :
+    // leave one core to the audio thread
+    numberOfWorkers_(jmax(1, SystemStats::getNumCpus() - 1)),
+    nextClient_(0),
+    nextWorker_(1),
+    isWorkPending_(false)
+{
+}
+
+
+MeterWorkerPool::~MeterWorkerPool()
+{
+    jassert(clients_.isEmpty());
+
+    stopWorkers();
+}
+
+
+/// Register a client.  Call when its audio thread is not running.
+///
+/// @param client client to add
+///
+void MeterWorkerPool::addClient(
+    Client *client)
+{
+    const ScopedLock workersLock(workersLock_);
+    const ScopedLock lock(clientsLock_);
+
+    clients_.addIfNotAlreadyThere(client);
+    startWorkers();
+}
+
+
+/// Unregister a client.  Blocks until no worker processes this
+/// client, so that it may be destroyed afterwards.  Chunks that are
+/// still queued are not processed.  Workers are stopped when the
+/// last client has been removed.
+///
+/// @param client client to remove
+///
+void MeterWorkerPool::removeClient(
+    Client *client)
+{
+    const ScopedLock workersLock(workersLock_);
+    bool hasClients;
+
+    {
+        const ScopedLock lock(clientsLock_);
+
+        clients_.removeFirstMatchingValue(client);
+        hasClients = !clients_.isEmpty();
+    }
+
+    // workers only pick up clients while holding the lock, so no
+    // worker can pick up this client anymore; wait for the one that
+    // may still be processing it
+    client->isIdle_.wait();
+
+    // workers take clientsLock_, so stop them without holding it
+    if (!hasClients)
+    {
+        stopWorkers();
+    }
+}
+
+
+/// Tell the workers that chunks have been queued.  Neither locks
+/// nor blocks, so it is safe to call from the audio thread.
+///
+void MeterWorkerPool::notify()
+{
+    isWorkPending_.store(true, std::memory_order_release);
+}
+
+
+/// Get number of worker threads.
+///
+/// @return number of workers
+///
+int MeterWorkerPool::getNumberOfWorkers() const
+{
+    return numberOfWorkers_;
+}
+
+
+/// Process the queued chunks of a single client.  Clients are picked
+/// in turn, so that a busy client cannot starve the others.
+///
+/// @return **false** if no client had queued chunks
+///
+bool MeterWorkerPool::processNextClient()
+{
+    Client *client = nullptr;
+    bool hasMoreWork = false;
+
+    {
+        const ScopedLock lock(clientsLock_);
+
+        int numberOfClients = clients_.size();
+
+        for (int offset = 0; offset < numberOfClients; ++offset)
+        {
+            int index = (nextClient_ + offset) % numberOfClients;
+            Client *candidate = clients_.getUnchecked(index);
+
+            if (candidate->isBusy_.load(std::memory_order_acquire) ||
+                    !candidate->hasQueuedChunks())
+            {
+                continue;
+            }
+
+            if (client == nullptr)
+            {
+                client = candidate;
+                client->isBusy_.store(true, std::memory_order_release);
+                client->isIdle_.reset();
+
+                nextClient_ = (index + 1) % numberOfClients;
+            }
+            else
+            {
+                hasMoreWork = true;
+                break;
+            }
+        }
+
+        // let another worker take care of the remaining clients
+        if (hasMoreWork)
+        {
+            notify();
+            wakeWorker();
+        }
+    }
+
+    if (client == nullptr)
+    {
+        return false;
+    }
+
+    client->processQueuedChunks();
+
+    {
+        // removeClient() cannot return before the lock is released,
+        // so the client is still alive
+        const ScopedLock lock(clientsLock_);
+
+        client->isBusy_.store(false, std::memory_order_release);
+
+        // other workers skip busy clients, so chunks queued while
+        // this client was busy would otherwise have to wait for the
+        // next notification
+        if (client->hasQueuedChunks())
+        {
+            notify();
+        }
+
+        client->isIdle_.signal();
+    }
+
+    return true;
+}
+
+
+/// Wake one of the workers that block while idle.  Must not be
+/// called from the audio thread.  Call while holding clientsLock_.
+///
+void MeterWorkerPool::wakeWorker()
+{
+    // the first worker wakes up by itself
+    if (workers_.size() < 2)
+    {
+        return;
+    }
+
+    workers_.getUnchecked(nextWorker_)->notify();
+
+    nextWorker_ = jmax(1, (nextWorker_ + 1) % workers_.size());
+}
+
+
+/// Start worker threads (if they are not running yet).  Call while
+/// holding workersLock_ and clientsLock_.
+///
+void MeterWorkerPool::startWorkers()
+{
+    if (workers_.size() > 0)
+    {
+        return;
+    }
+
+    for (int workerIndex = 0; workerIndex < numberOfWorkers_; ++workerIndex)
+    {
+        Worker *worker = workers_.add(new Worker(*this, workerIndex));
+
+        // meter readings are time-critical, but less so than audio
+        worker->startThread(8);
+    }
+}
+
+
+/// Stop all worker threads.  Call while holding workersLock_, but
+/// not clientsLock_.
+///
+void MeterWorkerPool::stopWorkers()
+{
+    for (auto worker : workers_)
+    {
+        worker->signalThreadShouldExit();
+    }
+
+    // stopThread() also wakes up waiting workers
+    for (auto worker : workers_)
+    {
+        worker->stopThread(-1);
+    }
+
+    workers_.clear();
+    nextWorker_ = 1;
+}
+
+
+/// Create a new worker.
+///
+/// @param meterWorkerPool owner of worker
+///
+/// @param workerIndex index of worker
+///
+MeterWorkerPool::Worker::Worker(
+    MeterWorkerPool &meterWorkerPool,
+    const int workerIndex) :
+    Thread("K-Meter meter worker " + String(workerIndex + 1)),
+    meterWorkerPool_(meterWorkerPool),
+    workerIndex_(workerIndex)
+{
+}
+
+
+/// Process clients until asked to exit.
+///
+void MeterWorkerPool::Worker::run()
+{
+    while (!threadShouldExit())
+    {
+        // clear flag before looking for work, so that chunks queued
+        // in the meantime are not missed
+        if (meterWorkerPool_.isWorkPending_.exchange(
+                    false, std::memory_order_acq_rel))
+        {
+            while (!threadShouldExit() &&
+                    meterWorkerPool_.processNextClient())
+            {
+            }
+
+            continue;
+        }
+
+        // chunks tend to arrive in quick succession, so check again
+        // for a short while before blocking
+        bool isWorkPending = false;
+
+        for (int spin = 0; spin < KMETER_WORKER_SPIN_COUNT; ++spin)
+        {
+            if (meterWorkerPool_.isWorkPending_.load(
+                        std::memory_order_acquire))
+            {
+                isWorkPending = true;
+                break;
+            }
+
+            Thread::yield();
+        }
+
+        if (isWorkPending)
+        {
+            continue;
+        }
+
+        // the audio thread must not signal events, so the first
+        // worker wakes up in short intervals to check for pending
+        // work; all other workers block until they are woken by
+        // wakeWorker() or stopThread()
+        if (workerIndex_ == 0)
+        {
+            wait(KMETER_WORKER_POLL_INTERVAL);
+        }
+        else
+        {
+            wait(-1);
+        }
+    }
+}
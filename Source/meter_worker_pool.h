@@ -0,0 +1,146 @@
+/* ----------------------------------------------------------------------------
+
+   K-Meter
+   =======
+   Implementation of a K-System meter according to Bob Katz' specifications
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+#ifndef KMETER_METER_WORKER_POOL_H
+#define KMETER_METER_WORKER_POOL_H
+
+#include "FrutHeader.h"
+
+
+/// Chunk of audio queued for metering on a worker thread.
+///
+struct MeterChunk
+{
+    AudioBuffer<float> samples;
+    bool isMono;
+
+    /// clear meter readings before processing this chunk
+    bool resetMeters;
+
+    /// clear filter states before processing this chunk
+    bool resetEngine;
+};
+
+
+/// Process-wide pool of threads that meter audio for all plug-in
+/// instances.  Obtain it through a SharedResourcePointer, so that
+/// every instance in a process shares the same pool.
+///
+/// Instances (clients) queue chunks on the audio thread and call
+/// notify(), which only stores to an atomic flag.  An idle worker
+/// spins on this flag for a short while and then blocks.  Only the
+/// first worker wakes up in short intervals to check the flag; it
+/// wakes further workers when more than one client has pending
+/// chunks.  Workers call processQueuedChunks() of a client that has
+/// pending chunks.  A client is never processed by more than one
+/// worker at a time, so its meter state needs no locking as long as
+/// other threads hand their changes to the worker (in queued chunks
+/// or atomic flags) instead of applying them directly.
+///
+/// Workers are started when the first client is added and stopped
+/// when the last client is removed.
+///
+class MeterWorkerPool
+{
+public:
+    /// Interface of plug-in instances that meter in the background.
+    class Client
+    {
+    public:
+        Client();
+        virtual ~Client() {}
+
+        /// Check for queued chunks.  Called by workers.
+        virtual bool hasQueuedChunks() = 0;
+
+        /// Meter all queued chunks.  Called by one worker at a time.
+        virtual void processQueuedChunks() = 0;
+
+    private:
+        friend class MeterWorkerPool;
+
+        std::atomic<bool> isBusy_;
+
+        // signalled while no worker processes this client
+        WaitableEvent isIdle_;
+    };
+
+    MeterWorkerPool();
+    ~MeterWorkerPool();
+
+    void addClient(Client *client);
+    void removeClient(Client *client);
+
+    void notify();
+
+    int getNumberOfWorkers() const;
+
+private:
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MeterWorkerPool);
+
+    // interval in which the first worker checks for pending work
+    // while idle (in milliseconds)
+    static const int KMETER_WORKER_POLL_INTERVAL = 2;
+
+    // number of times an idle worker checks for pending work before
+    // it blocks
+    static const int KMETER_WORKER_SPIN_COUNT = 64;
+
+    class Worker :
+        public Thread
+    {
+    public:
+        Worker(MeterWorkerPool &meterWorkerPool,
+               const int workerIndex);
+
+        void run() override;
+
+    private:
+        MeterWorkerPool &meterWorkerPool_;
+        const int workerIndex_;
+    };
+
+    bool processNextClient();
+    void wakeWorker();
+
+    void startWorkers();
+    void stopWorkers();
+
+    const int numberOfWorkers_;
+
+    // serialises starting and stopping of workers
+    CriticalSection workersLock_;
+
+    CriticalSection clientsLock_;
+    Array<Client *> clients_;
+    int nextClient_;
+
+    OwnedArray<Worker> workers_;
+    int nextWorker_;
+
+    std::atomic<bool> isWorkPending_;
+};
+
+#endif  // KMETER_METER_WORKER_POOL_H
@@ -72,6 +72,14 @@ KmeterAudioProcessorEditor::KmeterAudioProcessorEditor(KmeterAudioProcessor *own
     numberOfInputChannels_ = nNumChannels;
     crestFactor = 0;
 
+    previousSnapshot_ = MeterSnapshot();
+    currentSnapshot_ = MeterSnapshot();
+    displaySnapshot_ = MeterSnapshot();
+
+    currentSnapshotTime_ = 0.0;
+    snapshotInterval_ = 0.0;
+    isInterpolating_ = false;
+
     isExpanded = false;
     usePeakMeter = false;
 
@@ -79,7 +87,6 @@ KmeterAudioProcessorEditor::KmeterAudioProcessorEditor(KmeterAudioProcessor *own
     // and labels will be set later on in this constructor.
 
     audioProcessor = ownerFilter;
-    audioProcessor->addActionListener(this);
 
     ButtonK20.setRadioGroupId(1);
     ButtonK20.addListener(this);
@@ -190,12 +197,17 @@ KmeterAudioProcessorEditor::KmeterAudioProcessorEditor(KmeterAudioProcessor *own
     // apply skin to plug-in editor
     currentSkinName = audioProcessor->getParameterSkinName();
     loadSkin();
+
+    // poll processor for events and meter readings
+    refreshRate_ = audioProcessor->getRealInteger(
+                       KmeterPluginParameters::selRefreshRate);
+    updateTimer();
 }
 
 
 KmeterAudioProcessorEditor::~KmeterAudioProcessorEditor()
 {
-    audioProcessor->removeActionListener(this);
+    stopTimer();
 
     // release look and feel
     setLookAndFeel(nullptr);
@@ -339,70 +351,309 @@ void KmeterAudioProcessorEditor::windowValidationCallback(int modalResult)
 }
 
 
-void KmeterAudioProcessorEditor::actionListenerCallback(const String &strMessage)
+void KmeterAudioProcessorEditor::timerCallback()
 {
-    // "PC" ==> parameter changed, followed by a hash and the
-    // parameter's ID
-    if (strMessage.startsWith("PC#"))
+    // do not update anything while the editor is hidden or minimised;
+    // all events will be coalesced until it is shown again
+    if (!isShowing())
     {
-        String strIndex = strMessage.substring(3);
-        int nIndex = strIndex.getIntValue();
-        jassert(nIndex >= 0);
-        jassert(nIndex < audioProcessor->getNumParameters());
+        updateTimer();
+        return;
+    }
 
-        if (audioProcessor->hasChanged(nIndex))
-        {
-            updateParameter(nIndex);
-        }
+    // editor has just been shown again
+    if (getTimerInterval() != jmax(1, 1000 / refreshRate_))
+    {
+        updateTimer();
     }
-    // "UM" ==> update meters
-    else if (!strMessage.compare("UM"))
+
+    double currentTime = Time::getMillisecondCounterHiRes() / 1000.0;
+    KmeterEvents &events = audioProcessor->getEvents();
+
+    // drain all pending events at once (does not allocate)
+    if (events.fetch())
     {
-        std::shared_ptr<MeterBallistics> pMeterBallistics = audioProcessor->getLevels();
+        // parameters have changed
+        for (int nIndex = 0; nIndex < audioProcessor->getNumParameters(); ++nIndex)
+        {
+            if (events.hasParameterChanged(nIndex) &&
+                    audioProcessor->hasChanged(nIndex))
+            {
+                updateParameter(nIndex);
+            }
+        }
 
-        if (pMeterBallistics != nullptr)
+        // algorithm has changed
+        if (events.hasEvent(KmeterEvents::eventAlgorithmChanged))
         {
-            kmeter_.setLevels(pMeterBallistics);
+            updateAverageAlgorithm(true);
+        }
 
-            if (numberOfInputChannels_ <= 2)
+        // validation has stopped (handle before start of validation,
+        // so that restarting validation leaves the editor in a valid
+        // state)
+        if (events.hasEvent(KmeterEvents::eventValidationStopped))
+        {
+            if (!validationDialogOpen)
             {
-                float fStereo = pMeterBallistics->getStereoMeterValue();
-                stereoMeter.setValue(fStereo / 2.0f + 0.5f);
-
-                float fPhase = pMeterBallistics->getPhaseCorrelation();
-                phaseCorrelationMeter.setValue(fPhase / 2.0f + 0.5f);
+                ButtonValidation.setToggleState(false, dontSendNotification);
             }
+
+            // do nothing till you hear from me... :)
         }
 
-        if (isValidating && !audioProcessor->isValidating())
+        // validation has started
+        if (events.hasEvent(KmeterEvents::eventValidationStarted) &&
+                audioProcessor->isValidating())
         {
-            isValidating = false;
+            isValidating = true;
+        }
+
+        // meters have been updated
+        if (events.hasEvent(KmeterEvents::eventMetersUpdated))
+        {
+            const MeterSnapshot &meterSnapshot = audioProcessor->getLevels();
+
+            if (meterSnapshot.numberOfChannels > 0)
+            {
+                // start interpolating from the readings that are
+                // currently displayed to prevent jumps
+                if (displaySnapshot_.numberOfChannels ==
+                        meterSnapshot.numberOfChannels)
+                {
+                    previousSnapshot_ = displaySnapshot_;
+                }
+                else
+                {
+                    previousSnapshot_ = meterSnapshot;
+                }
+
+                currentSnapshot_ = meterSnapshot;
+
+                // spread interpolation over the time that has passed
+                // since the last snapshot arrived
+                snapshotInterval_ = jlimit(0.001, 0.1,
+                                           currentTime - currentSnapshotTime_);
+                currentSnapshotTime_ = currentTime;
+                isInterpolating_ = true;
+            }
+
+            if (isValidating && !audioProcessor->isValidating())
+            {
+                isValidating = false;
+            }
         }
     }
-    // "AC" ==> algorithm changed
-    else if (!strMessage.compare("AC"))
+
+    updateMeters(currentTime);
+}
+
+
+void KmeterAudioProcessorEditor::visibilityChanged()
+{
+    updateTimer();
+}
+
+
+/// Run timer at the selected frame rate while the editor is shown,
+/// and at a low rate (only to check visibility) otherwise.
+///
+void KmeterAudioProcessorEditor::updateTimer()
+{
+    int timerInterval = 250;
+
+    if (isShowing())
     {
-        updateAverageAlgorithm(true);
+        timerInterval = jmax(1, 1000 / refreshRate_);
     }
-    // "V+" ==> validation started
-    else if ((!strMessage.compare("V+")) && audioProcessor->isValidating())
+
+    if (getTimerInterval() != timerInterval)
     {
-        isValidating = true;
+        startTimer(timerInterval);
     }
-    // "V-" ==> validation stopped
-    else if (!strMessage.compare("V-"))
+}
+
+
+/// Display meter readings interpolated to the current frame time.
+///
+/// @param currentTime current time in fractional seconds
+///
+void KmeterAudioProcessorEditor::updateMeters(double currentTime)
+{
+    if (!isInterpolating_)
     {
-        if (!validationDialogOpen)
-        {
-            ButtonValidation.setToggleState(false, dontSendNotification);
-        }
+        return;
+    }
+
+    float fraction = static_cast<float>(
+                         (currentTime - currentSnapshotTime_) /
+                         snapshotInterval_);
+
+    if (fraction >= 1.0f)
+    {
+        fraction = 1.0f;
+        isInterpolating_ = false;
+    }
+
+    MeterBallistics::interpolateSnapshot(previousSnapshot_,
+                                         currentSnapshot_,
+                                         fraction,
+                                         displaySnapshot_);
+
+    kmeter_.setLevels(displaySnapshot_);
+
+    if (numberOfInputChannels_ <= 2)
+    {
+        float fStereo = displaySnapshot_.stereoMeterValue;
+        stereoMeter.setValue(fStereo / 2.0f + 0.5f);
 
-        // do nothing till you hear from me... :)
+        float fPhase = displaySnapshot_.phaseCorrelation;
+        phaseCorrelationMeter.setValue(fPhase / 2.0f + 0.5f);
     }
-    else
+}
+
+
+/// Let the user select the editor's refresh rate, where metering
+/// takes place, the plug-in's latency, the analysis block size, the
+/// low-pass filter applied before averaging and decimation.
+///
+void KmeterAudioProcessorEditor::showOptionsMenu()
+{
+    PopupMenu menu;
+    menu.addSectionHeader("Refresh rate");
+
+    int refreshRates[] = {30, 60, 120};
+
+    for (int n = 0; n < 3; ++n)
+    {
+        menu.addItem(n + 1,
+                     String(refreshRates[n]) + " fps",
+                     true,
+                     refreshRate_ == refreshRates[n]);
+    }
+
+    const int backgroundMeteringItem = 10;
+    const int zeroLatencyItem = 11;
+
+    menu.addSectionHeader("Metering");
+    menu.addItem(backgroundMeteringItem,
+                 "Meter on background threads",
+                 true,
+                 audioProcessor->getBoolean(
+                     KmeterPluginParameters::selBackgroundMetering));
+    menu.addItem(zeroLatencyItem,
+                 "Zero latency (meters lag behind audio)",
+                 true,
+                 audioProcessor->getBoolean(
+                     KmeterPluginParameters::selZeroLatency));
+
+    const int firstBlockSizeItem = 20;
+    int blockSizes[] = {256, 512, 1024, 2048, 4096};
+    int blockSize = audioProcessor->getRealInteger(
+                        KmeterPluginParameters::selAnalysisBlockSize);
+
+    menu.addSectionHeader("Analysis block size");
+
+    for (int n = 0; n < 5; ++n)
+    {
+        menu.addItem(firstBlockSizeItem + n,
+                     String(blockSizes[n]) + " samples",
+                     true,
+                     blockSize == blockSizes[n]);
+    }
+
+    const int firstLowPassFilterItem = 30;
+    const char *lowPassFilters[] = {"FIR (windowed sinc)",
+                                    "IIR (Chebyshev, less CPU)",
+                                    "None (least CPU)"};
+    int lowPassFilter = audioProcessor->getRealInteger(
+                            KmeterPluginParameters::selLowPassFilter);
+
+    menu.addSectionHeader("Low-pass filter");
+
+    for (int n = 0; n < KmeterPluginParameters::nNumLowPassFilters; ++n)
     {
-        DBG("[K-Meter] received unknown action strMessage \"" + strMessage + "\".");
+        menu.addItem(firstLowPassFilterItem + n,
+                     lowPassFilters[n],
+                     true,
+                     lowPassFilter == n);
     }
+
+    const int decimationItem = 12;
+
+    menu.addItem(decimationItem,
+                 "Decimate at high sample rates (less CPU)",
+                 true,
+                 audioProcessor->getBoolean(
+                     KmeterPluginParameters::selDecimation));
+
+    // the editor may be closed while the menu is open
+    Component::SafePointer<KmeterAudioProcessorEditor> editor(this);
+
+    menu.showMenuAsync(
+        PopupMenu::Options().withTargetComponent(&ButtonSkin),
+        [editor, backgroundMeteringItem, zeroLatencyItem, decimationItem,
+         firstBlockSizeItem, firstLowPassFilterItem](int result)
+    {
+        if ((editor != nullptr) && (result == backgroundMeteringItem))
+        {
+            bool isEnabled = editor->audioProcessor->getBoolean(
+                                 KmeterPluginParameters::selBackgroundMetering);
+
+            editor->audioProcessor->setParameter(
+                KmeterPluginParameters::selBackgroundMetering,
+                isEnabled ? 0.0f : 1.0f);
+        }
+        else if ((editor != nullptr) && (result == zeroLatencyItem))
+        {
+            bool isEnabled = editor->audioProcessor->getBoolean(
+                                 KmeterPluginParameters::selZeroLatency);
+
+            editor->audioProcessor->setParameter(
+                KmeterPluginParameters::selZeroLatency,
+                isEnabled ? 0.0f : 1.0f);
+        }
+        else if ((editor != nullptr) && (result == decimationItem))
+        {
+            bool isEnabled = editor->audioProcessor->getBoolean(
+                                 KmeterPluginParameters::selDecimation);
+
+            editor->audioProcessor->setParameter(
+                KmeterPluginParameters::selDecimation,
+                isEnabled ? 0.0f : 1.0f);
+        }
+        else if ((editor != nullptr) && (result >= firstLowPassFilterItem))
+        {
+            // the parameter is a switch with three presets
+            float internalValue = (result - firstLowPassFilterItem) / 2.0f;
+
+            editor->audioProcessor->setParameter(
+                KmeterPluginParameters::selLowPassFilter,
+                internalValue);
+        }
+        else if ((editor != nullptr) && (result >= firstBlockSizeItem))
+        {
+            // the parameter is a switch with five presets
+            float internalValue = (result - firstBlockSizeItem) / 4.0f;
+
+            editor->audioProcessor->setParameter(
+                KmeterPluginParameters::selAnalysisBlockSize,
+                internalValue);
+        }
+        else if ((editor != nullptr) && (result > 0))
+        {
+            // the parameter is a switch with three presets
+            float internalValue = (result - 1) / 2.0f;
+
+            editor->audioProcessor->setParameter(
+                KmeterPluginParameters::selRefreshRate,
+                internalValue);
+
+            editor->refreshRate_ = editor->audioProcessor->getRealInteger(
+                                       KmeterPluginParameters::selRefreshRate);
+            editor->updateTimer();
+        }
+    });
 }
 
 
@@ -597,6 +848,11 @@ void KmeterAudioProcessorEditor::buttonClicked(Button *button)
     {
         audioProcessor->changeParameter(KmeterPluginParameters::selExpanded, button->getToggleState() ? 0.0f : 1.0f);
     }
+    else if ((button == &ButtonSkin) &&
+             ModifierKeys::getCurrentModifiers().isPopupMenu())
+    {
+        showOptionsMenu();
+    }
     else if (button == &ButtonSkin)
     {
         // manually activate button (will be deactivated in dialog
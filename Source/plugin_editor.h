@@ -36,14 +36,15 @@
 class KmeterAudioProcessorEditor :
     public AudioProcessorEditor,
     public Button::Listener,
-    public ActionListener
+    public Timer
 {
 public:
     KmeterAudioProcessorEditor(KmeterAudioProcessor *ownerFilter, int nNumChannels);
     ~KmeterAudioProcessorEditor();
 
     void buttonClicked(Button *button);
-    void actionListenerCallback(const String &message);
+    void timerCallback() override;
+    void visibilityChanged() override;
     void updateParameter(int nIndex);
 
     void windowAboutCallback(int modalResult);
@@ -62,6 +63,10 @@ private:
     void loadSkin();
     void updateAverageAlgorithm(bool reload_meters);
 
+    void updateTimer();
+    void updateMeters(double currentTime);
+    void showOptionsMenu();
+
     bool needsMeterReload;
     bool isValidating;
     bool validationDialogOpen;
@@ -72,6 +77,18 @@ private:
     int crestFactor;
     int numberOfInputChannels_;
 
+    int refreshRate_;
+
+    // meter readings are interpolated between the two most recent
+    // snapshots to match the editor's frame rate
+    MeterSnapshot previousSnapshot_;
+    MeterSnapshot currentSnapshot_;
+    MeterSnapshot displaySnapshot_;
+
+    double currentSnapshotTime_;
+    double snapshotInterval_;
+    bool isInterpolating_;
+
     File skinDirectory;
     Skin skin;
     String currentSkinName;
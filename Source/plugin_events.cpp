@@ -0,0 +1,134 @@
+/* ----------------------------------------------------------------------------
+
+   K-Meter
+   =======
+   Implementation of a K-System meter according to Bob Katz' specifications
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+#include "plugin_events.h"
+
+
+// parameter bits are located above the event bits
+static_assert(KmeterEvents::numberOfEvents +
+              KmeterPluginParameters::numberOfParametersComplete <= 64,
+              "too many events and parameters for a 64-bit word");
+
+
+KmeterEvents::KmeterEvents() :
+    pendingBits_(0),
+    fetchedBits_(0)
+{
+}
+
+
+/// Notify the editor of an event.  Events of the same kind are
+/// coalesced until the editor drains them.
+///
+/// @param event event to post (see "KmeterEvents::Events")
+///
+void KmeterEvents::postEvent(
+    const int event)
+{
+    jassert(isPositiveAndBelow(event, static_cast<int>(numberOfEvents)));
+
+    postBit(event);
+}
+
+
+/// Notify the editor of a parameter change.  Changes of the same
+/// parameter are coalesced until the editor drains them.
+///
+/// @param parameterIndex index of changed parameter
+///
+void KmeterEvents::postParameterChange(
+    const int parameterIndex)
+{
+    jassert(isPositiveAndBelow(
+                parameterIndex,
+                static_cast<int>(
+                    KmeterPluginParameters::numberOfParametersComplete)));
+
+    postBit(numberOfEvents + parameterIndex);
+}
+
+
+void KmeterEvents::postBit(
+    const int bit)
+{
+    uint64 mask = static_cast<uint64>(1) << bit;
+
+    // skip the read-modify-write if the bit has already been set
+    if ((pendingBits_.load(std::memory_order_relaxed) & mask) == 0)
+    {
+        pendingBits_.fetch_or(mask, std::memory_order_release);
+    }
+}
+
+
+/// Drain all pending events.  They can then be queried using
+/// hasEvent() and hasParameterChanged().  **Must only be called by
+/// the editor.**
+///
+/// @return true if any events were pending
+///
+bool KmeterEvents::fetch()
+{
+    // skip the read-modify-write if there is nothing to fetch
+    if (pendingBits_.load(std::memory_order_relaxed) == 0)
+    {
+        fetchedBits_ = 0;
+        return false;
+    }
+
+    fetchedBits_ = pendingBits_.exchange(0, std::memory_order_acquire);
+    return fetchedBits_ != 0;
+}
+
+
+/// Check whether an event was drained by the last call of fetch().
+///
+/// @param event event to check (see "KmeterEvents::Events")
+///
+/// @return true if the event was pending
+///
+bool KmeterEvents::hasEvent(
+    const int event) const
+{
+    jassert(isPositiveAndBelow(event, static_cast<int>(numberOfEvents)));
+
+    uint64 mask = static_cast<uint64>(1) << event;
+    return (fetchedBits_ & mask) != 0;
+}
+
+
+/// Check whether a parameter change was drained by the last call of
+/// fetch().
+///
+/// @param parameterIndex index of parameter to check
+///
+/// @return true if the parameter has changed
+///
+bool KmeterEvents::hasParameterChanged(
+    const int parameterIndex) const
+{
+    uint64 mask = static_cast<uint64>(1) << (numberOfEvents + parameterIndex);
+    return (fetchedBits_ & mask) != 0;
+}
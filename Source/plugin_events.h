@@ -0,0 +1,69 @@
+/* ----------------------------------------------------------------------------
+
+   K-Meter
+   =======
+   Implementation of a K-System meter according to Bob Katz' specifications
+
+   Copyright (c) 2010-2020 Martin Zuther (http://www.mzuther.de/)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Thank you for using free software!
+
+---------------------------------------------------------------------------- */
+
+#ifndef KMETER_PLUGIN_EVENTS_H
+#define KMETER_PLUGIN_EVENTS_H
+
+#include "FrutHeader.h"
+#include "plugin_parameters.h"
+
+
+// Typed notifications from the audio processor to its editor.  Every
+// kind of event (and every parameter) is represented by a "dirty"
+// bit in a single atomic word, so that repeated events coalesce until
+// the editor drains them.  Posting never blocks or allocates and is
+// safe from any thread; draining must only be done by the editor.
+class KmeterEvents
+{
+public:
+    KmeterEvents();
+
+    enum Events  // public namespace!
+    {
+        eventMetersUpdated = 0,
+        eventAlgorithmChanged,
+        eventValidationStarted,
+        eventValidationStopped,
+
+        numberOfEvents,
+    };
+
+    void postEvent(const int event);
+    void postParameterChange(const int parameterIndex);
+
+    bool fetch();
+    bool hasEvent(const int event) const;
+    bool hasParameterChanged(const int parameterIndex) const;
+
+private:
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(KmeterEvents);
+
+    void postBit(const int bit);
+
+    std::atomic<uint64> pendingBits_;
+    uint64 fetchedBits_;
+};
+
+#endif  // KMETER_PLUGIN_EVENTS_H
@@ -220,6 +220,75 @@ KmeterPluginParameters::KmeterPluginParameters() :
         new frut::parameters::ParString(defaultSkinName);
     ParameterSkinName->setName("Skin");
     add(ParameterSkinName, selSkinName);
+
+
+    // refresh rate of editor in frames per second
+    frut::parameters::ParSwitch *ParameterRefreshRate =
+        new frut::parameters::ParSwitch();
+    ParameterRefreshRate->setName("Refresh rate");
+
+    ParameterRefreshRate->addPreset(30.0f,  "30 fps");
+    ParameterRefreshRate->addPreset(60.0f,  "60 fps");
+    ParameterRefreshRate->addPreset(120.0f, "120 fps");
+
+    ParameterRefreshRate->setDefaultRealFloat(60.0f, true);
+    add(ParameterRefreshRate, selRefreshRate);
+
+
+    // meter on shared worker threads instead of the audio thread
+    frut::parameters::ParBoolean *ParameterBackgroundMetering =
+        new frut::parameters::ParBoolean("On", "Off");
+    ParameterBackgroundMetering->setName("Background metering");
+    ParameterBackgroundMetering->setDefaultBoolean(false, true);
+    add(ParameterBackgroundMetering, selBackgroundMetering);
+
+
+    // pass audio through without pre-delay (meters lag behind)
+    frut::parameters::ParBoolean *ParameterZeroLatency =
+        new frut::parameters::ParBoolean("On", "Off");
+    ParameterZeroLatency->setName("Zero latency");
+    ParameterZeroLatency->setDefaultBoolean(false, true);
+    add(ParameterZeroLatency, selZeroLatency);
+
+
+    // number of samples in a chunk; smaller chunks update the meters
+    // more often (and lower latency), but need more CPU
+    frut::parameters::ParSwitch *ParameterAnalysisBlockSize =
+        new frut::parameters::ParSwitch();
+    ParameterAnalysisBlockSize->setName("Analysis block size");
+
+    ParameterAnalysisBlockSize->addPreset(256.0f,  "256 samples");
+    ParameterAnalysisBlockSize->addPreset(512.0f,  "512 samples");
+    ParameterAnalysisBlockSize->addPreset(1024.0f, "1024 samples");
+    ParameterAnalysisBlockSize->addPreset(2048.0f, "2048 samples");
+    ParameterAnalysisBlockSize->addPreset(4096.0f, "4096 samples");
+
+    ParameterAnalysisBlockSize->setDefaultRealFloat(1024.0f, true);
+    add(ParameterAnalysisBlockSize, selAnalysisBlockSize);
+
+
+    // low-pass filter applied before averaging; the IIR filter and
+    // no filter at all need less CPU than the FIR filter, but
+    // attenuate signals above 21 kHz less (or not at all)
+    frut::parameters::ParSwitch *ParameterLowPassFilter =
+        new frut::parameters::ParSwitch();
+    ParameterLowPassFilter->setName("Low-pass filter");
+
+    ParameterLowPassFilter->addPreset(selLowPassFir,  "FIR (windowed sinc)");
+    ParameterLowPassFilter->addPreset(selLowPassIir,  "IIR (Chebyshev)");
+    ParameterLowPassFilter->addPreset(selLowPassNone, "None");
+
+    ParameterLowPassFilter->setDefaultRealFloat(selLowPassFir, true);
+    add(ParameterLowPassFilter, selLowPassFilter);
+
+
+    // average at a reduced sample rate (at least 44.1 kHz) to save
+    // CPU at high sample rates
+    frut::parameters::ParBoolean *ParameterDecimation =
+        new frut::parameters::ParBoolean("On", "Off");
+    ParameterDecimation->setName("Decimation");
+    ParameterDecimation->setDefaultBoolean(false, true);
+    add(ParameterDecimation, selDecimation);
 }
 
 
@@ -68,6 +68,12 @@ public:
         selValidationPhaseCorrelation,
         selValidationCSVFormat,
         selSkinName,
+        selRefreshRate,
+        selBackgroundMetering,
+        selZeroLatency,
+        selAnalysisBlockSize,
+        selLowPassFilter,
+        selDecimation,
 
         numberOfParametersComplete,
 
@@ -82,6 +88,12 @@ public:
         selAlgorithmItuBs1770,
 
         nNumAlgorithms,
+
+        selLowPassFir = 0,
+        selLowPassIir,
+        selLowPassNone,
+
+        nNumLowPassFilters,
     };
 
 private:
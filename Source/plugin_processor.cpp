@@ -40,7 +40,7 @@ Flow of parameter processing:
   Processor:   changeParameter(nIndex, fValue)
   Processor:   setParameter(nIndex, fValue)
   Parameters:  setFloat(nIndex, fValue)
-  Editor:      actionListenerCallback(strMessage)
+  Editor:      timerCallback()
   Editor:      updateParameter(nIndex)
 
 ==============================================================================*/
@@ -61,8 +61,10 @@ KmeterAudioProcessor::KmeterAudioProcessor() :
     }
 
     meterBallistics_ = nullptr;
-    averageLevelFiltered_ = nullptr;
-    truePeakMeter_ = nullptr;
+    meterEngine_ = nullptr;
+
+    meterSnapshots_ =
+        std::make_unique<frut::audio::TripleBuffer<MeterSnapshot>>();
 
     ringBuffer_ = nullptr;
     ringBufferDouble_ = nullptr;
@@ -71,12 +73,22 @@ KmeterAudioProcessor::KmeterAudioProcessor() :
     isStereo_ = true;
     isSilent_ = false;
     hasStopped_ = true;
+    isMeteringInBackground_ = false;
+    isMeterResetPending_ = false;
+    isEngineResetPending_ = false;
+    isZeroLatency_ = false;
+
+    isResetRequested_ = false;
+    isMeterResetRequested_ = false;
+    requestedInfiniteHold_ = -1;
+    requestedAverageAlgorithm_ = -1;
 
     attenuationDecibel_ = 0.0;
     currentAttenuationDecibel_ = attenuationDecibel_;
 
     outputGain_ = 1.0;
     outputFadeRate_ = 0.0;
+    outputFadeFactor_ = 1.0;
 
     // compensate for pre-delay
     setLatencySamples(kmeterBufferSize_);
@@ -84,14 +96,13 @@ KmeterAudioProcessor::KmeterAudioProcessor() :
     // depends on "KmeterPluginParameters"!
     averageAlgorithmId_ = getRealInteger(
                               KmeterPluginParameters::selAverageAlgorithm);
-
-    processedSeconds_ = 0.0f;
 }
 
 
 KmeterAudioProcessor::~KmeterAudioProcessor()
 {
-    removeAllActionListeners();
+    // workers must not access this instance after its destruction
+    stopBackgroundMetering();
 }
 
 
@@ -276,14 +287,31 @@ void KmeterAudioProcessor::setParameter(
                 setAverageAlgorithm(getRealInteger(nIndex));
             }
 
-            // "PC" ==> parameter changed, followed by a hash and the
-            // parameter's ID
-            sendActionMessage("PC#" + String(nIndex));
+            // notify editor of parameter change
+            events_.postParameterChange(nIndex);
         }
         // for hidden parameters, we only have to clear the change
         // flag
         else
         {
+            if (nIndex == KmeterPluginParameters::selBackgroundMetering)
+            {
+                updateBackgroundMetering();
+            }
+            else if (nIndex == KmeterPluginParameters::selZeroLatency)
+            {
+                updateZeroLatency();
+            }
+            else if (nIndex == KmeterPluginParameters::selAnalysisBlockSize)
+            {
+                updateAnalysisBlockSize();
+            }
+            else if ((nIndex == KmeterPluginParameters::selLowPassFilter) ||
+                     (nIndex == KmeterPluginParameters::selDecimation))
+            {
+                updateAverageLevelFilter();
+            }
+
             pluginParameters_.clearChangeFlag(nIndex);
         }
     }
@@ -321,6 +349,10 @@ void KmeterAudioProcessor::updateParameters(
     if (bIncludeHiddenParameters)
     {
         // handle hidden parameters here!
+        updateBackgroundMetering();
+        updateZeroLatency();
+        updateAnalysisBlockSize();
+        updateAverageLevelFilter();
 
         // the following parameters need no updating:
         //
@@ -333,6 +365,7 @@ void KmeterAudioProcessor::updateParameters(
         // * selValidationPhaseCorrelation
         // * selValidationCSVFormat
         // * selSkinName
+        // * selRefreshRate
     }
 }
 
@@ -478,6 +511,9 @@ void KmeterAudioProcessor::prepareToPlay(
 
     Logger::outputDebugString("[K-Meter] preparing to play");
 
+    // workers must not access the old meter engine
+    stopBackgroundMetering();
+
     if ((sampleRate < 44100) || (sampleRate > 192000))
     {
         Logger::outputDebugString("[K-Meter] WARNING: sample rate of " +
@@ -493,12 +529,22 @@ void KmeterAudioProcessor::prepareToPlay(
     isSilent_ = false;
     hasStopped_ = true;
 
+    // number of samples in a chunk; sizes FFT, true peak meter, ring
+    // buffers and chunk queue, and determines latency and how often
+    // the meters are updated
+    kmeterBufferSize_ = getRealInteger(
+                            KmeterPluginParameters::selAnalysisBlockSize);
+
     // force initialization of "outputGain_" in "processBlock()"
     currentAttenuationDecibel_ = attenuationDecibel_ + 1e-12;
 
     // output fade rate: 60 dB/s
     outputFadeRate_ = 60.0 / sampleRate;
 
+    // change of output gain per sample while fading in
+    outputFadeFactor_ = MeterBallistics::decibel2level_double(
+                            outputFadeRate_);
+
     int numInputChannels = getMainBusNumInputChannels();
 
     dither_.initialise(jmax(getMainBusNumInputChannels(),
@@ -512,73 +558,68 @@ void KmeterAudioProcessor::prepareToPlay(
 
     isStereo_ = (numInputChannels == 2);
 
+    int averageAlgorithm = averageAlgorithmId_;
+
     meterBallistics_ = std::make_shared<MeterBallistics>(
                            numInputChannels,
-                           averageAlgorithmId_,
+                           averageAlgorithm,
                            false,
                            false);
 
-    peakLevels_.clear();
-    rmsLevels_.clear();
-    averageLevelsFiltered_.clear();
-    truePeakLevels_.clear();
+    meterEngine_ = std::make_unique<MeterEngine>(
+                       numInputChannels,
+                       sampleRate,
+                       kmeterBufferSize_,
+                       meterBallistics_,
+                       averageAlgorithm,
+                       getRealInteger(
+                           KmeterPluginParameters::selLowPassFilter),
+                       getBoolean(
+                           KmeterPluginParameters::selDecimation));
 
-    overflowCounts_.clear();
+    isZeroLatency_ = getBoolean(KmeterPluginParameters::selZeroLatency) &&
+                     !DEBUG_FILTER;
 
-    for (int channel = 0; channel < numInputChannels; ++channel)
-    {
-        peakLevels_.add(0.0f);
-        rmsLevels_.add(0.0f);
-        averageLevelsFiltered_.add(MeterBallistics::getMeterMinimumDecibel());
-        truePeakLevels_.add(0.0f);
+    createRingBuffers(samplesPerBlock);
 
-        overflowCounts_.add(0);
-    }
+    // temporary buffer of the double precision path; allocate here
+    // to keep heap allocations off the audio thread
+    processBufferFloat_.setSize(jmax(numInputChannels,
+                                     getMainBusNumOutputChannels()),
+                                samplesPerBlock);
 
-    averageLevelFiltered_ = std::make_unique<AverageLevelFiltered>(
-                                numInputChannels,
-                                (int) sampleRate,
-                                kmeterBufferSize_,
-                                averageAlgorithmId_);
+    // temporary buffer for output stage (samples and output gains)
+    processBufferDouble_.setSize(2, samplesPerBlock);
 
-    // maximum under-read of true peak measurement is 0.169 dB (see
-    // Annex 2 of ITU-R BS.1770-4)
-    int oversamplingFactor = 8;
+    // pre-allocate chunks for background metering (about 190 ms of
+    // audio at 44.1 kHz, but at least eight chunks)
+    int numberOfMeterChunks = jmax(8, (8 * 1024) / kmeterBufferSize_);
 
-    if (sampleRate >= 176400)
-    {
-        oversamplingFactor /= 4;
-    }
-    else if (sampleRate >= 88200)
-    {
-        oversamplingFactor /= 2;
-    }
-
-    truePeakMeter_ = std::make_unique<frut::dsp::TruePeakMeter>(
-                         numInputChannels,
-                         kmeterBufferSize_,
-                         oversamplingFactor);
+    // the queue holds one item less than it has slots
+    meterChunks_ = std::make_unique<frut::audio::SpscQueue<MeterChunk>>(
+                       numberOfMeterChunks + 1);
 
-    // make sure that ring buffer can hold at least kmeterBufferSize_
-    // samples and is large enough to receive a full block of audio
-    int ringBufferSize = jmax(samplesPerBlock, kmeterBufferSize_);
+    for (int index = 0; index < meterChunks_->getCapacity(); ++index)
+    {
+        MeterChunk &chunk = meterChunks_->getSlot(index);
 
-    int preDelay = kmeterBufferSize_;
-    int chunkSize = kmeterBufferSize_;
+        chunk.samples.setSize(numInputChannels, kmeterBufferSize_);
+        chunk.isMono = false;
+        chunk.resetMeters = false;
+        chunk.resetEngine = false;
+    }
 
-    ringBuffer_ = std::make_unique<frut::audio::RingBuffer<float>>(
-                      numInputChannels,
-                      ringBufferSize,
-                      preDelay,
-                      chunkSize);
+    // new ring buffers and meter engine start out cleared
+    isMeterResetPending_ = false;
+    isEngineResetPending_ = false;
+    isResetRequested_ = false;
 
-    ringBuffer_->setCallbackClass(this);
+    if (isUsingDoublePrecision())
+    {
+        DBG("[K-Meter] using double precision");
+    }
 
-    ringBufferDouble_ = std::make_unique<frut::audio::RingBuffer<double>>(
-                            numInputChannels,
-                            ringBufferSize,
-                            preDelay,
-                            chunkSize);
+    startBackgroundMetering();
 }
 
 
@@ -592,12 +633,17 @@ void KmeterAudioProcessor::releaseResources()
 
     hasStopped_ = true;
 
+    stopBackgroundMetering();
+    meterChunks_ = nullptr;
+
     meterBallistics_ = nullptr;
-    averageLevelFiltered_ = nullptr;
-    truePeakMeter_ = nullptr;
+    meterEngine_ = nullptr;
 
     ringBuffer_ = nullptr;
     ringBufferDouble_ = nullptr;
+
+    processBufferFloat_.setSize(0, 0);
+    processBufferDouble_.setSize(0, 0);
 }
 
 
@@ -607,13 +653,38 @@ void KmeterAudioProcessor::reset()
     // etc, as it means there's been a break in the audio's
     // continuity.
 
-    hasStopped_ = true;
-    processedSeconds_ = 0.0f;
+    // hosts may call this method on the audio thread, so it must
+    // neither block nor touch the ring buffers or the meter engine;
+    // the reset is carried out before the next block is processed
+    // (see "applyHostReset()")
+    isResetRequested_ = true;
+}
 
+
+/// Carry out a reset requested by the host.  The audio thread owns
+/// the ring buffers, so it clears them.  The meter engine is reset
+/// by the thread that meters: right away when metering on the audio
+/// thread, or by a worker before it meters the next chunk.  **Must
+/// only be called from the audio thread.**
+///
+void KmeterAudioProcessor::applyHostReset()
+{
+    if (!isResetRequested_.exchange(false, std::memory_order_acquire))
+    {
+        return;
+    }
+
+    hasStopped_ = true;
     ringBuffer_->clear();
 
-    averageLevelFiltered_->reset();
-    truePeakMeter_->reset();
+    if (isMeteringInBackground_)
+    {
+        isEngineResetPending_ = true;
+    }
+    else
+    {
+        meterEngine_->reset();
+    }
 }
 
 
@@ -653,12 +724,28 @@ void KmeterAudioProcessor::processBlock(
         return;
     }
 
+    // assert on heap allocations (debug builds of the standalone
+    // application and of plug-ins for Windows)
+    frut::audio::ScopedAllocationGuard allocationGuard;
+
+    // host has called "reset()"
+    applyHostReset();
+
     // reset meters if playback has started
     resetOnPlay();
 
+    // re-use pre-allocated temporary buffer for output stage (holds
+    // samples and output gains; will only re-allocate if the host
+    // exceeds the announced block size)
+    processBufferDouble_.setSize(2, numberOfSamples,
+                                 false, false, true);
+
     // overwrite buffer with output of audio file player
     if (audioFilePlayer_)
     {
+        // validation reads from disk and logs meter readings
+        frut::audio::ScopedAllocationGuard::Exemption allowAllocation;
+
         audioFilePlayer_->copyTo(buffer);
     }
     // mute buffer if validation window is open
@@ -676,28 +763,29 @@ void KmeterAudioProcessor::processBlock(
         // "Mono" button has been pressed
         if (getBoolean(KmeterPluginParameters::selMono))
         {
+            double *monoSamples = processBufferDouble_.getWritePointer(0);
+
             for (int sample = 0; sample < numberOfSamples; ++sample)
             {
                 // create mono mix
-                double monoSample = 0.5 *
-                                    (static_cast<double>(leftChannel[sample]) +
-                                     static_cast<double>(rightChannel[sample]));
-
-                // dither mono mix and store in buffer
-                leftChannel[sample] = dither_.ditherSample(0, monoSample);
-                rightChannel[sample] = leftChannel[sample];
+                monoSamples[sample] = 0.5 *
+                                      (static_cast<double>(leftChannel[sample]) +
+                                       static_cast<double>(rightChannel[sample]));
             }
+
+            // dither mono mix and store in buffer
+            dither_.ditherBlock(0, monoSamples, leftChannel,
+                                numberOfSamples);
+
+            FloatVectorOperations::copy(rightChannel, leftChannel,
+                                        numberOfSamples);
         }
         // "Flip" button has been pressed
         else if (getBoolean(KmeterPluginParameters::selFlip))
         {
-            for (int sample = 0; sample < numberOfSamples; ++sample)
-            {
-                // flip stereo channels
-                float oldleftChannel = leftChannel[sample];
-                leftChannel[sample] = rightChannel[sample];
-                rightChannel[sample] = oldleftChannel;
-            }
+            // flip stereo channels
+            std::swap_ranges(leftChannel, leftChannel + numberOfSamples,
+                             rightChannel);
         }
     }
 
@@ -707,69 +795,43 @@ void KmeterAudioProcessor::processBlock(
     // been added!
     ringBuffer_->addFrom(buffer, 0, numberOfSamples);
 
+    // leave buffer alone and only move read pointer
+    if (isZeroLatency_)
+    {
+        ringBuffer_->removeToNull(numberOfSamples);
+    }
     // copy ring buffer back to buffer
-    ringBuffer_->removeTo(buffer, 0, numberOfSamples);
-
-    float **bufferSample = buffer.getArrayOfWritePointers();
+    else
+    {
+        ringBuffer_->removeTo(buffer, 0, numberOfSamples);
+    }
 
     // fade to mute / dim
-    for (int sample = 0; sample < numberOfSamples; ++sample)
-    {
-        // fade in
-        if (currentAttenuationDecibel_ < attenuationDecibel_)
-        {
-            currentAttenuationDecibel_ += outputFadeRate_;
+    double *outputGains = processBufferDouble_.getWritePointer(1);
+    int numberOfFadedSamples = calculateOutputGains(outputGains,
+                               numberOfSamples);
 
-            if (currentAttenuationDecibel_ > attenuationDecibel_)
-            {
-                currentAttenuationDecibel_ = attenuationDecibel_;
-            }
+    // skip output stage at unity gain
+    if (numberOfFadedSamples > 0)
+    {
+        double *fadedSamples = processBufferDouble_.getWritePointer(0);
 
-            if (currentAttenuationDecibel_ < 0.0)
-            {
-                outputGain_ = MeterBallistics::decibel2level_double(
-                                  currentAttenuationDecibel_);
-            }
-            else
-            {
-                outputGain_ = 1.0;
-            }
-        }
-        // fade out
-        else if (currentAttenuationDecibel_ > attenuationDecibel_)
+        for (int channel = 0;
+                channel < getMainBusNumInputChannels();
+                ++channel)
         {
-            currentAttenuationDecibel_ -= outputFadeRate_;
+            float *bufferSamples = buffer.getWritePointer(channel);
 
-            if (currentAttenuationDecibel_ < attenuationDecibel_)
-            {
-                currentAttenuationDecibel_ = attenuationDecibel_;
-            }
-
-            if (currentAttenuationDecibel_ > -60.0)
-            {
-                outputGain_ = MeterBallistics::decibel2level_double(
-                                  currentAttenuationDecibel_);
-            }
-            else
-            {
-                outputGain_ = 0.0;
-            }
-        }
+            // convert samples to double precision and apply fade
+            std::copy(bufferSamples, bufferSamples + numberOfFadedSamples,
+                      fadedSamples);
 
-        if (outputGain_ != 1.0)
-        {
-            for (int channel = 0;
-                    channel < getMainBusNumInputChannels();
-                    ++channel)
-            {
-                // apply fade to sample
-                double fadedSample = outputGain_ * static_cast<double>(
-                                         bufferSample[channel][sample]);
+            FloatVectorOperations::multiply(fadedSamples, outputGains,
+                                            numberOfFadedSamples);
 
-                // dither faded sample and store in buffer
-                bufferSample[channel][sample] = dither_.ditherSample(
-                                                    channel, fadedSample);
-            }
+            // dither faded samples and store in buffer
+            dither_.ditherBlock(channel, fadedSamples, bufferSamples,
+                                numberOfFadedSamples);
         }
     }
 }
@@ -782,8 +844,6 @@ void KmeterAudioProcessor::processBlock(
     ignoreUnused(midiMessages);
     jassert(isUsingDoublePrecision());
 
-    DBG("[K-Meter] using double precision");
-
     // temporarily disable denormals
     ScopedNoDenormals noDenormals;
 
@@ -814,18 +874,33 @@ void KmeterAudioProcessor::processBlock(
         return;
     }
 
+    // assert on heap allocations (debug builds of the standalone
+    // application and of plug-ins for Windows)
+    frut::audio::ScopedAllocationGuard allocationGuard;
+
+    // host has called "reset()"
+    applyHostReset();
+
     // reset meters if playback has started
     resetOnPlay();
 
+    // re-use pre-allocated temporary buffers (will only re-allocate
+    // if the host exceeds the announced block size)
+    processBufferFloat_.setSize(numberOfChannels, numberOfSamples,
+                                false, false, true);
+    processBufferDouble_.setSize(2, numberOfSamples,
+                                 false, false, true);
+
     // overwrite buffer with output of audio file player
     if (audioFilePlayer_)
     {
-        AudioBuffer<float> processBuffer(numberOfChannels, numberOfSamples);
+        // validation reads from disk and logs meter readings
+        frut::audio::ScopedAllocationGuard::Exemption allowAllocation;
 
         // copy output of audio file player and convert to double
-        audioFilePlayer_->copyTo(processBuffer);
-        dither_.convertToDouble(processBuffer, buffer);
-
+        processBufferFloat_.clear();
+        audioFilePlayer_->copyTo(processBufferFloat_);
+        dither_.convertToDouble(processBufferFloat_, buffer);
     }
     // mute buffer if validation window is open
     else if (isSilent_)
@@ -842,52 +917,47 @@ void KmeterAudioProcessor::processBlock(
         // "Mono" button has been pressed
         if (getBoolean(KmeterPluginParameters::selMono))
         {
-            for (int sample = 0; sample < numberOfSamples; ++sample)
-            {
-                // create mono mix
-                double monoSample = 0.5 * (leftChannel[sample] +
-                                           rightChannel[sample]);
-
-                // dither mono mix and store in buffer
-                leftChannel[sample] = monoSample;
-                rightChannel[sample] = leftChannel[sample];
-            }
+            // create mono mix and store in buffer
+            FloatVectorOperations::add(leftChannel, rightChannel,
+                                       numberOfSamples);
+            FloatVectorOperations::multiply(leftChannel, 0.5,
+                                            numberOfSamples);
+            FloatVectorOperations::copy(rightChannel, leftChannel,
+                                        numberOfSamples);
         }
         // "Flip" button has been pressed
         else if (getBoolean(KmeterPluginParameters::selFlip))
         {
-            for (int sample = 0; sample < numberOfSamples; ++sample)
-            {
-                // flip stereo channels
-                double oldleftChannel = leftChannel[sample];
-                leftChannel[sample] = rightChannel[sample];
-                rightChannel[sample] = oldleftChannel;
-            }
+            // flip stereo channels
+            std::swap_ranges(leftChannel, leftChannel + numberOfSamples,
+                             rightChannel);
         }
     }
 
-    // create temporary buffer
-    AudioBuffer<float> processBuffer(numberOfChannels, numberOfSamples);
-
     // dither input samples and store in temporary buffer
-    dither_.ditherToFloat(buffer, processBuffer);
+    dither_.ditherToFloat(buffer, processBufferFloat_);
 
     // copy temporary buffer to ring buffer (applies pre-delay)
     //
     // calls "processBufferChunk" each time chunkSize samples have
     // been added!
-    ringBuffer_->addFrom(processBuffer, 0, numberOfSamples);
+    ringBuffer_->addFrom(processBufferFloat_, 0, numberOfSamples);
 
     // to allow debugging of the average level filter, we'll have to
     // overwrite the input buffer from the ring buffer
     if (DEBUG_FILTER)
     {
         // copy ring buffer back to temporary buffer
-        ringBuffer_->removeTo(processBuffer, 0, numberOfSamples);
+        ringBuffer_->removeTo(processBufferFloat_, 0, numberOfSamples);
 
         // convert temporary buffer to double and store in output
         // buffer
-        dither_.convertToDouble(processBuffer, buffer);
+        dither_.convertToDouble(processBufferFloat_, buffer);
+    }
+    // pass audio through without pre-delay
+    else if (isZeroLatency_)
+    {
+        ringBuffer_->removeToNull(numberOfSamples);
     }
     // otherwise, do not reduce the bit depth and stay in the double
     // domain
@@ -903,65 +973,22 @@ void KmeterAudioProcessor::processBlock(
         ringBuffer_->removeToNull(numberOfSamples);
     }
 
-    double **bufferSample = buffer.getArrayOfWritePointers();
-
     // fade to mute / dim
-    for (int sample = 0; sample < numberOfSamples; ++sample)
-    {
-        // fade in
-        if (currentAttenuationDecibel_ < attenuationDecibel_)
-        {
-            currentAttenuationDecibel_ += outputFadeRate_;
+    double *outputGains = processBufferDouble_.getWritePointer(1);
+    int numberOfFadedSamples = calculateOutputGains(outputGains,
+                               numberOfSamples);
 
-            if (currentAttenuationDecibel_ > attenuationDecibel_)
-            {
-                currentAttenuationDecibel_ = attenuationDecibel_;
-            }
-
-            if (currentAttenuationDecibel_ < 0.0)
-            {
-                outputGain_ = MeterBallistics::decibel2level_double(
-                                  currentAttenuationDecibel_);
-            }
-            else
-            {
-                outputGain_ = 1.0;
-            }
-        }
-        // fade out
-        else if (currentAttenuationDecibel_ > attenuationDecibel_)
-        {
-            currentAttenuationDecibel_ -= outputFadeRate_;
-
-            if (currentAttenuationDecibel_ < attenuationDecibel_)
-            {
-                currentAttenuationDecibel_ = attenuationDecibel_;
-            }
-
-            if (currentAttenuationDecibel_ > -60.0)
-            {
-                outputGain_ = MeterBallistics::decibel2level_double(
-                                  currentAttenuationDecibel_);
-            }
-            else
-            {
-                outputGain_ = 0.0;
-            }
-        }
-
-        if (outputGain_ != 1.0)
+    // skip output stage at unity gain
+    if (numberOfFadedSamples > 0)
+    {
+        for (int channel = 0;
+                channel < getMainBusNumInputChannels();
+                ++channel)
         {
-            for (int channel = 0;
-                    channel < getMainBusNumInputChannels();
-                    ++channel)
-            {
-                // apply fade to sample
-                double fadedSample = outputGain_ *
-                                     bufferSample[channel][sample];
-
-                // store faded sample in buffer
-                bufferSample[channel][sample] = fadedSample;
-            }
+            // apply fade to samples
+            FloatVectorOperations::multiply(buffer.getWritePointer(channel),
+                                            outputGains,
+                                            numberOfFadedSamples);
         }
     }
 }
@@ -981,144 +1008,39 @@ bool KmeterAudioProcessor::processBufferChunk(
     int chunkSize = buffer.getNumSamples();
     bool isMono = getBoolean(KmeterPluginParameters::selMono);
 
-    // length of buffer chunk in fractional seconds
-    // (1024 samples / 44100 samples/s = 23.2 ms)
-    processedSeconds_ = static_cast<float>(chunkSize) /
-                        static_cast<float>(getSampleRate());
-
-    // copy buffer to determine average level
-    averageLevelFiltered_->copyFrom(buffer, chunkSize);
-
-    // copy buffer to determine true peak level
-    truePeakMeter_->copyFrom(buffer, chunkSize);
-
-    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    // hand chunk to a worker thread (DEBUG_FILTER needs the filter
+    // output right away)
+    if (isMeteringInBackground_ && !DEBUG_FILTER)
     {
-        if (isMono && (channel == 1))
-        {
-            peakLevels_.set(channel, peakLevels_[0]);
-            rmsLevels_.set(channel, rmsLevels_[0]);
-            averageLevelsFiltered_.set(channel, averageLevelsFiltered_[0]);
-            truePeakLevels_.set(channel, truePeakLevels_[0]);
+        MeterChunk *chunk = meterChunks_->getWriteSlot();
 
-            overflowCounts_.set(channel, overflowCounts_[0]);
-        }
-        else
+        // if the workers cannot keep up, skip chunk instead of
+        // blocking the audio thread
+        if (chunk != nullptr)
         {
-            // determine peak level for chunkSize samples
-            peakLevels_.set(
-                channel,
-                buffer.getMagnitude(channel, 0, chunkSize));
-
-            // determine RMS level for chunkSize samples
-            rmsLevels_.set(
-                channel,
-                buffer.getRMSLevel(channel, 0, chunkSize));
-
-            // determine filtered average level for chunkSize samples
-            // (please note that this level has already been converted
-            // to decibels!)
-            averageLevelsFiltered_.set(
-                channel,
-                averageLevelFiltered_->getLevel(channel));
-
-            // determine true peak level for chunkSize samples
-            truePeakLevels_.set(
-                channel,
-                truePeakMeter_->getLevel(channel));
-
-            // determine overflows for chunkSize samples; treat all
-            // samples above -0.001 dBFS as overflow
-            //
-            // in the 16-bit domain, full scale corresponds to an
-            // absolute integer value of 32'767 or 32'768, so we'll
-            // treat absolute levels of 32'767 and above as overflows;
-            // this corresponds to a floating-point level of 32'767 /
-            // 32'768 = 0.9999694 (approx. -0.001 dBFS).
-            overflowCounts_.set(
-                channel,
-                countOverflows(buffer, channel, chunkSize, 0.9999f));
-        }
-
-        // apply meter ballistics and store values so that the editor
-        // can access them
-        meterBallistics_->updateChannel(channel,
-                                        processedSeconds_,
-                                        peakLevels_[channel],
-                                        truePeakLevels_[channel],
-                                        averageLevelsFiltered_[channel],
-                                        overflowCounts_[channel]);
-    }
-
-    // phase correlation is only defined for stereo signals
-    if (isStereo_)
-    {
-        float phaseCorrelation = 1.0f;
-
-        // check whether the stereo signal has been mixed down to mono
-        if (isMono)
-        {
-            phaseCorrelation = 1.0f;
-        }
-        // otherwise, process only RMS levels at or above -80 dB
-        else if ((rmsLevels_[0] >= 0.0001f) || (rmsLevels_[1] >= 0.0001f))
-        {
-            float sumOfProduct = 0.0f;
-            float sumOfSquaresLeft = 0.0f;
-            float sumOfSquaresRight = 0.0f;
-
-            // determine correlation for chunkSize samples
-            for (int sample = 0; sample < chunkSize; ++sample)
-            {
-                float leftChannel = buffer.getSample(0, sample);
-                float rightChannel = buffer.getSample(1, sample);
-
-                sumOfProduct += leftChannel * rightChannel;
-                sumOfSquaresLeft += leftChannel * leftChannel;
-                sumOfSquaresRight += rightChannel * rightChannel;
-            }
-
-            float sumsOfSquares = sumOfSquaresLeft * sumOfSquaresRight;
-
-            // prevent division by zero and taking the square root of
-            // a negative number
-            if (sumsOfSquares > 0.0f)
-            {
-                phaseCorrelation = sumOfProduct / sqrtf(sumsOfSquares);
-            }
-            else
+            for (int channel = 0; channel < chunk->samples.getNumChannels();
+                    ++channel)
             {
-                // this is mathematically incorrect, but "musically"
-                // correct (i.e. signal is mono-compatible)
-                phaseCorrelation = 1.0f;
+                chunk->samples.copyFrom(channel, 0, buffer, channel, 0,
+                                        chunkSize);
             }
-        }
 
-        meterBallistics_->setPhaseCorrelation(processedSeconds_,
-                                              phaseCorrelation);
+            chunk->isMono = isMono;
+            chunk->resetMeters = isMeterResetPending_;
+            chunk->resetEngine = isEngineResetPending_;
 
-        float stereoMeterValue = 0.0f;
+            isMeterResetPending_ = false;
+            isEngineResetPending_ = false;
 
-        // do not process RMS levels below -80 dB
-        if ((rmsLevels_[0] < 0.0001f) && (rmsLevels_[1] < 0.0001f))
-        {
-            stereoMeterValue = 0.0f;
-        }
-        else if (rmsLevels_[1] >= rmsLevels_[0])
-        {
-            stereoMeterValue = 1.0f - rmsLevels_[0] / rmsLevels_[1];
-        }
-        else
-        {
-            stereoMeterValue = rmsLevels_[1] / rmsLevels_[0] - 1.0f;
+            meterChunks_->push();
+            meterWorkerPool_->notify();
         }
 
-        meterBallistics_->setStereoMeterValue(processedSeconds_,
-                                              stereoMeterValue);
+        // keep ring buffer contents
+        return false;
     }
 
-    // "UM" ==> update meters
-    sendActionMessage("UM");
+    meterChunk(buffer, isMono);
 
     // To hear the audio source after average filtering, simply set
     // DEBUG_FILTER to "true".  Please remember to revert this
@@ -1126,7 +1048,7 @@ bool KmeterAudioProcessor::processBufferChunk(
     if (DEBUG_FILTER)
     {
         // get average filter output
-        averageLevelFiltered_->copyTo(buffer, chunkSize);
+        meterEngine_->copyFilteredTo(buffer, chunkSize);
 
         // overwrite ring buffer contents
         return true;
@@ -1139,53 +1061,380 @@ bool KmeterAudioProcessor::processBufferChunk(
 }
 
 
-/// Count the number of overflows within a channel.
+/// Measure a chunk of audio, apply meter ballistics and publish the
+/// readings.  Runs on the audio thread, or on a worker thread when
+/// metering in the background.
 ///
-/// @param buffer audio buffer to process
+/// @param buffer audio chunk
 ///
-/// @param channel audio channel to process
+/// @param isMono if **true**, the second channel is assumed to be
+///        identical to the first one
 ///
-/// @param numberOfSamples number of samples to process, starting from
-///        the **beginning** of the buffer
+void KmeterAudioProcessor::meterChunk(
+    const AudioBuffer<float> &buffer,
+    const bool isMono)
+{
+    // carry out changes requested by the editor
+    applyMeterRequests();
+
+    // measure chunk and apply meter ballistics
+    meterEngine_->processChunk(buffer, isMono);
+
+    // publish meter readings to the editor (wait-free)
+    meterBallistics_->getSnapshot(meterSnapshots_->getWriteBuffer());
+    meterSnapshots_->publish();
+
+    // notify editor of updated meters
+    events_.postEvent(KmeterEvents::eventMetersUpdated);
+}
+
+
+/// Carry out changes to the meter ballistics that other threads have
+/// requested.  Only the thread that meters (the audio thread or a
+/// worker) changes meter ballistics, so they need no locking.
 ///
-/// @param limitOverflow sample amplitude that does just *not* count as
-///        an overflow (absolute value)
+void KmeterAudioProcessor::applyMeterRequests()
+{
+    if (isMeterResetRequested_.exchange(false, std::memory_order_acquire))
+    {
+        meterBallistics_->reset();
+    }
+
+    int infiniteHold = requestedInfiniteHold_.exchange(
+                           -1, std::memory_order_acquire);
+
+    if (infiniteHold >= 0)
+    {
+        meterBallistics_->setPeakMeterInfiniteHold(infiniteHold != 0);
+        meterBallistics_->setAverageMeterInfiniteHold(infiniteHold != 0);
+    }
+
+    int averageAlgorithm = requestedAverageAlgorithm_.exchange(
+                               -1, std::memory_order_acquire);
+
+    if (averageAlgorithm >= 0)
+    {
+        meterBallistics_->setAverageAlgorithm(averageAlgorithm);
+    }
+}
+
+
+/// Check for chunks waiting to be metered.  Called by workers of the
+/// meter worker pool.
 ///
-/// @return number of overflows
+/// @return **true** if chunks are queued
 ///
-int KmeterAudioProcessor::countOverflows(
-    const AudioBuffer<float> &buffer,
-    const int channel,
-    const int numberOfSamples,
-    const float limitOverflow) const
+bool KmeterAudioProcessor::hasQueuedChunks()
 {
-    jassert(isPositiveAndBelow(channel, buffer.getNumChannels()));
-    jassert(isPositiveAndNotGreaterThan(numberOfSamples,
-                                        buffer.getNumSamples()));
+    return !meterChunks_->isEmpty();
+}
 
-    const float *audioData = buffer.getReadPointer(channel);
-    int overflows = 0;
 
-    for (int sample = 0; sample < numberOfSamples; ++sample)
+/// Meter all queued chunks.  Called by a single worker of the meter
+/// worker pool at a time.
+///
+void KmeterAudioProcessor::processQueuedChunks()
+{
+    while (MeterChunk *chunk = meterChunks_->getReadSlot())
     {
-        // get sample value
-        float amplitude = audioData[sample];
-
-        // convert sample value to amplitude
-        if (amplitude < 0.0f)
+        // host has called "reset()"
+        if (chunk->resetEngine)
         {
-            amplitude = -amplitude;
+            meterEngine_->reset();
         }
 
-        // an overflow has occurred if the amplitude lies above the
-        // overflow limit
-        if (amplitude > limitOverflow)
+        // playback has been restarted
+        if (chunk->resetMeters)
         {
-            ++overflows;
+            meterBallistics_->reset();
         }
+
+        meterChunk(chunk->samples, chunk->isMono);
+        meterChunks_->pop();
+    }
+}
+
+
+/// Start metering on the shared worker pool if the user has asked
+/// for it and no validation is running.  **Must not be called while
+/// the audio thread is processing.**
+///
+void KmeterAudioProcessor::startBackgroundMetering()
+{
+    if (isMeteringInBackground_ || (meterChunks_ == nullptr) ||
+            (audioFilePlayer_ != nullptr) ||
+            !getBoolean(KmeterPluginParameters::selBackgroundMetering))
+    {
+        return;
     }
 
-    return overflows;
+    isMeteringInBackground_ = true;
+    meterWorkerPool_->addClient(this);
+}
+
+
+/// Return to metering on the audio thread.  Chunks that are still
+/// queued are metered on the calling thread.  **Must not be called
+/// while the audio thread is processing.**
+///
+void KmeterAudioProcessor::stopBackgroundMetering()
+{
+    if (!isMeteringInBackground_)
+    {
+        return;
+    }
+
+    // blocks until no worker is metering this instance
+    meterWorkerPool_->removeClient(this);
+    isMeteringInBackground_ = false;
+
+    processQueuedChunks();
+
+    // resets have not been handed to a worker yet
+    if (isEngineResetPending_)
+    {
+        meterEngine_->reset();
+        isEngineResetPending_ = false;
+    }
+
+    if (isMeterResetPending_)
+    {
+        meterBallistics_->reset();
+        isMeterResetPending_ = false;
+    }
+}
+
+
+/// Switch between metering on the audio thread and on the shared
+/// worker pool, depending on the user's choice.  Validation reads
+/// meter readings on the audio thread, so it always meters there.
+/// **Must only be called from the message thread.**
+///
+void KmeterAudioProcessor::updateBackgroundMetering()
+{
+    switchBackgroundMetering(
+        getBoolean(KmeterPluginParameters::selBackgroundMetering) &&
+        (audioFilePlayer_ == nullptr));
+}
+
+
+/// Switch between metering on the audio thread and on the shared
+/// worker pool.  **Must only be called from the message thread.**
+///
+/// @param shouldMeterInBackground if **true**, meter on the worker
+///        pool
+///
+void KmeterAudioProcessor::switchBackgroundMetering(
+    const bool shouldMeterInBackground)
+{
+    if ((shouldMeterInBackground == isMeteringInBackground_) ||
+            (meterChunks_ == nullptr))
+    {
+        return;
+    }
+
+    // keep the audio thread out while switching
+    bool wasSuspended = isSuspended();
+
+    if (!wasSuspended)
+    {
+        suspendProcessing(true);
+    }
+
+    if (shouldMeterInBackground)
+    {
+        startBackgroundMetering();
+    }
+    else
+    {
+        stopBackgroundMetering();
+    }
+
+    if (!wasSuspended)
+    {
+        suspendProcessing(false);
+    }
+}
+
+
+/// Create ring buffers that collect chunks for metering and delay
+/// the output, and report the resulting latency to the host.  In
+/// zero latency mode, audio is not delayed and the double precision
+/// ring buffer is not needed.  **Must not be called while the audio
+/// thread is processing.**
+///
+/// @param samplesPerBlock maximum number of samples per block
+///
+void KmeterAudioProcessor::createRingBuffers(
+    const int samplesPerBlock)
+{
+    int numInputChannels = getMainBusNumInputChannels();
+
+    // make sure that ring buffer can hold at least kmeterBufferSize_
+    // samples and is large enough to receive a full block of audio
+    int ringBufferSize = jmax(samplesPerBlock, kmeterBufferSize_);
+
+    int preDelay = isZeroLatency_ ? 0 : kmeterBufferSize_;
+    int chunkSize = kmeterBufferSize_;
+
+    ringBuffer_ = std::make_unique<frut::audio::RingBuffer<float>>(
+                      numInputChannels,
+                      ringBufferSize,
+                      preDelay,
+                      chunkSize);
+
+    ringBuffer_->setCallbackClass(this);
+
+    if (isZeroLatency_)
+    {
+        ringBufferDouble_ = nullptr;
+    }
+    else
+    {
+        ringBufferDouble_ = std::make_unique<frut::audio::RingBuffer<double>>(
+                                numInputChannels,
+                                ringBufferSize,
+                                preDelay,
+                                chunkSize);
+    }
+
+    // compensate for pre-delay
+    setLatencySamples(preDelay);
+}
+
+
+/// Switch between delaying audio to match the meters and passing it
+/// through without latency, depending on the user's choice.
+/// DEBUG_FILTER needs the delayed output.  **Must only be called
+/// from the message thread.**
+///
+void KmeterAudioProcessor::updateZeroLatency()
+{
+    bool shouldUseZeroLatency =
+        getBoolean(KmeterPluginParameters::selZeroLatency) &&
+        !DEBUG_FILTER;
+
+    if (shouldUseZeroLatency == isZeroLatency_)
+    {
+        return;
+    }
+
+    // resources have not been allocated yet, so only the latency
+    // needs to be reported
+    if (ringBuffer_ == nullptr)
+    {
+        isZeroLatency_ = shouldUseZeroLatency;
+        setLatencySamples(isZeroLatency_ ? 0 : kmeterBufferSize_);
+
+        return;
+    }
+
+    // keep audio thread from accessing the ring buffers
+    bool wasSuspended = isSuspended();
+
+    if (!wasSuspended)
+    {
+        suspendProcessing(true);
+    }
+
+    isZeroLatency_ = shouldUseZeroLatency;
+    createRingBuffers(getBlockSize());
+
+    if (!wasSuspended)
+    {
+        suspendProcessing(false);
+    }
+}
+
+
+/// Re-allocate everything that depends on the analysis block size
+/// when the user has chosen a new one.  Meter ballistics are based
+/// on elapsed time, so they are not affected by the block size.
+/// **Must only be called from the message thread.**
+///
+void KmeterAudioProcessor::updateAnalysisBlockSize()
+{
+    int bufferSize = getRealInteger(
+                         KmeterPluginParameters::selAnalysisBlockSize);
+
+    if (bufferSize == kmeterBufferSize_)
+    {
+        return;
+    }
+
+    // resources have not been allocated yet, so only the latency
+    // needs to be reported
+    if (meterEngine_ == nullptr)
+    {
+        kmeterBufferSize_ = bufferSize;
+        setLatencySamples(isZeroLatency_ ? 0 : kmeterBufferSize_);
+
+        return;
+    }
+
+    // keep audio thread from accessing the old buffers
+    bool wasSuspended = isSuspended();
+
+    if (!wasSuspended)
+    {
+        suspendProcessing(true);
+    }
+
+    // also reads the new block size
+    prepareToPlay(getSampleRate(), getBlockSize());
+
+    if (!wasSuspended)
+    {
+        suspendProcessing(false);
+    }
+}
+
+
+/// Re-create the meter engine when the user has chosen a new
+/// low-pass filter or toggled decimation.  **Must only be called
+/// from the message thread.**
+///
+void KmeterAudioProcessor::updateAverageLevelFilter()
+{
+    // resources have not been allocated yet; the filter is read in
+    // "prepareToPlay()"
+    if (meterEngine_ == nullptr)
+    {
+        return;
+    }
+
+    int lowPassFilter = getRealInteger(
+                            KmeterPluginParameters::selLowPassFilter);
+
+    // decimation depends on sample rate and block size, so toggling
+    // it does not necessarily change anything
+    int decimationFactor = AverageLevelFiltered::calculateDecimationFactor(
+                               meterEngine_->getSampleRate(),
+                               meterEngine_->getBufferSize(),
+                               getBoolean(
+                                   KmeterPluginParameters::selDecimation));
+
+    if ((lowPassFilter == meterEngine_->getLowPassFilter()) &&
+            (decimationFactor == meterEngine_->getDecimationFactor()))
+    {
+        return;
+    }
+
+    // keep audio thread from accessing the old meter engine
+    bool wasSuspended = isSuspended();
+
+    if (!wasSuspended)
+    {
+        suspendProcessing(true);
+    }
+
+    // also reads the new low-pass filter and decimation
+    prepareToPlay(getSampleRate(), getBlockSize());
+
+    if (!wasSuspended)
+    {
+        suspendProcessing(false);
+    }
 }
 
 
@@ -1208,8 +1457,13 @@ void KmeterAudioProcessor::resetOnPlay()
             // check whether playback has just started
             if (hasStopped_ && isPlayingAgain)
             {
-                // clear meters
-                if (meterBallistics_ != nullptr)
+                // clear meters (workers do this before metering the
+                // next chunk)
+                if (isMeteringInBackground_)
+                {
+                    isMeterResetPending_ = true;
+                }
+                else if (meterBallistics_ != nullptr)
                 {
                     meterBallistics_->reset();
                 }
@@ -1222,6 +1476,91 @@ void KmeterAudioProcessor::resetOnPlay()
 }
 
 
+/// Calculate output gains for mute and dim.  The output is faded by
+/// "outputFadeRate_" decibels per sample.  Instead of converting every
+/// sample's attenuation to a gain, the gain is converted once per
+/// block and then multiplied by a constant factor, which matches the
+/// per-sample conversion within rounding.
+///
+/// @param outputGains receives the output gain of each sample
+///
+/// @param numberOfSamples number of samples in block
+///
+/// @return number of samples, counted from the start of the block,
+///         that need to be faded; the remaining samples have unity
+///         gain and "outputGains" is left undefined for them
+///
+int KmeterAudioProcessor::calculateOutputGains(
+    double *outputGains,
+    const int numberOfSamples)
+{
+    double targetAttenuationDecibel = attenuationDecibel_;
+
+    // constant gain
+    if (currentAttenuationDecibel_ == targetAttenuationDecibel)
+    {
+        if (outputGain_ == 1.0)
+        {
+            return 0;
+        }
+
+        FloatVectorOperations::fill(outputGains, outputGain_,
+                                    numberOfSamples);
+
+        return numberOfSamples;
+    }
+
+    bool isFadingIn = (currentAttenuationDecibel_ < targetAttenuationDecibel);
+
+    double fadeRate = isFadingIn ? outputFadeRate_ : -outputFadeRate_;
+    double fadeFactor = isFadingIn ? outputFadeFactor_ : 1.0 / outputFadeFactor_;
+
+    double rampGain = MeterBallistics::decibel2level_double(
+                          currentAttenuationDecibel_);
+
+    int numberOfFadedSamples = 0;
+
+    for (int sample = 0; sample < numberOfSamples; ++sample)
+    {
+        if (currentAttenuationDecibel_ != targetAttenuationDecibel)
+        {
+            currentAttenuationDecibel_ += fadeRate;
+            rampGain *= fadeFactor;
+
+            // fade has ended
+            if ((isFadingIn && (currentAttenuationDecibel_ > targetAttenuationDecibel)) ||
+                    (!isFadingIn && (currentAttenuationDecibel_ < targetAttenuationDecibel)))
+            {
+                currentAttenuationDecibel_ = targetAttenuationDecibel;
+                rampGain = MeterBallistics::decibel2level_double(
+                               currentAttenuationDecibel_);
+            }
+
+            if (isFadingIn)
+            {
+                outputGain_ = (currentAttenuationDecibel_ < 0.0) ? rampGain : 1.0;
+            }
+            else
+            {
+                outputGain_ = (currentAttenuationDecibel_ > -60.0) ? rampGain : 0.0;
+            }
+        }
+
+        // the gain cannot leave unity once it has faded in within
+        // this block, so all remaining samples have unity gain
+        if (outputGain_ == 1.0)
+        {
+            break;
+        }
+
+        outputGains[sample] = outputGain_;
+        ++numberOfFadedSamples;
+    }
+
+    return numberOfFadedSamples;
+}
+
+
 void KmeterAudioProcessor::silenceInput(
     bool isSilentNew)
 {
@@ -1241,8 +1580,11 @@ void KmeterAudioProcessor::startValidation(
     bool bStereoMeterValue,
     bool bPhaseCorrelation)
 {
+    // validation reads meter readings on the audio thread
+    switchBackgroundMetering(false);
+
     // reset all meters before we start the validation
-    meterBallistics_->reset();
+    resetMeters();
 
     isSilent_ = false;
 
@@ -1265,8 +1607,8 @@ void KmeterAudioProcessor::startValidation(
                                        bStereoMeterValue,
                                        bPhaseCorrelation);
 
-        // refresh editor; "V+" ==> validation started
-        sendActionMessage("V+");
+        // refresh editor
+        events_.postEvent(KmeterEvents::eventValidationStarted);
     }
     else
     {
@@ -1286,10 +1628,12 @@ void KmeterAudioProcessor::stopValidation()
     audioFilePlayer_ = nullptr;
 
     // reset all meters after the validation
-    meterBallistics_->reset();
+    resetMeters();
 
-    // refresh editor; "V-" ==> validation stopped
-    sendActionMessage("V-");
+    updateBackgroundMetering();
+
+    // refresh editor
+    events_.postEvent(KmeterEvents::eventValidationStopped);
 }
 
 
@@ -1314,28 +1658,48 @@ bool KmeterAudioProcessor::isValidating()
 }
 
 
-std::shared_ptr<MeterBallistics> KmeterAudioProcessor::getLevels()
+/// Get the most recent meter readings.  **Must only be called from
+/// the message thread.**
+///
+/// @return snapshot of meter readings (will have zero channels until
+///         audio has been processed)
+///
+const MeterSnapshot &KmeterAudioProcessor::getLevels()
+{
+    meterSnapshots_->update();
+    return meterSnapshots_->getReadBuffer();
+}
+
+
+/// Get notifications for the editor.  **Events must only be drained
+/// by the editor.**
+///
+/// @return event channel
+///
+KmeterEvents &KmeterAudioProcessor::getEvents()
 {
-    return meterBallistics_;
+    return events_;
 }
 
 
+/// Select "infinite peak hold" or "falling peaks" mode.  Takes effect
+/// when the next chunk is metered.
+///
+/// @param infiniteHold if **true**, select "infinite peak hold" mode
+///
 void KmeterAudioProcessor::setMeterInfiniteHold(bool infiniteHold)
 {
-    if (meterBallistics_)
-    {
-        meterBallistics_->setPeakMeterInfiniteHold(infiniteHold);
-        meterBallistics_->setAverageMeterInfiniteHold(infiniteHold);
-    }
+    requestedInfiniteHold_.store(infiniteHold ? 1 : 0,
+                                 std::memory_order_release);
 }
 
 
+/// Reset all meter readings.  Takes effect when the next chunk is
+/// metered.
+///
 void KmeterAudioProcessor::resetMeters()
 {
-    if (meterBallistics_)
-    {
-        meterBallistics_->reset();
-    }
+    isMeterResetRequested_.store(true, std::memory_order_release);
 }
 
 
@@ -1350,10 +1714,10 @@ void KmeterAudioProcessor::setAverageAlgorithm(
 {
     if (averageAlgorithm != averageAlgorithmId_)
     {
-        if (averageLevelFiltered_ != nullptr)
+        if (meterEngine_ != nullptr)
         {
-            averageLevelFiltered_->setAlgorithm(averageAlgorithm);
-            setAverageAlgorithmFinal(averageLevelFiltered_->getAlgorithm());
+            meterEngine_->setAverageAlgorithm(averageAlgorithm);
+            setAverageAlgorithmFinal(meterEngine_->getAverageAlgorithm());
         }
         else
         {
@@ -1367,14 +1731,15 @@ void KmeterAudioProcessor::setAverageAlgorithmFinal(
     const int averageAlgorithm)
 {
     averageAlgorithmId_ = averageAlgorithm;
-    meterBallistics_->setAverageAlgorithm(averageAlgorithmId_);
+
+    // meter ballistics switch when the next chunk is metered
+    requestedAverageAlgorithm_.store(averageAlgorithm,
+                                     std::memory_order_release);
 
     //  the level averaging alghorithm has been changed, so update the
     // "RMS" and "ITU-R" buttons to make sure that the correct button
     // is lit
-    //
-    // "AC" ==> algorithm changed
-    sendActionMessage("AC");
+    events_.postEvent(KmeterEvents::eventAlgorithmChanged);
 }
 
 
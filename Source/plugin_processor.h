@@ -28,14 +28,16 @@
 
 #include "FrutHeader.h"
 #include "audio_file_player.h"
-#include "average_level_filtered.h"
 #include "meter_ballistics.h"
+#include "meter_engine.h"
+#include "meter_worker_pool.h"
+#include "plugin_events.h"
 #include "plugin_parameters.h"
 
 
 class KmeterAudioProcessor :
     public AudioProcessor,
-    public ActionBroadcaster,
+    public MeterWorkerPool::Client,
     virtual public frut::audio::RingBufferProcessor<float>
 {
 public:
@@ -97,12 +99,16 @@ public:
 
     double getTailLengthSeconds() const override;
 
-    std::shared_ptr<MeterBallistics> getLevels();
+    const MeterSnapshot &getLevels();
+    KmeterEvents &getEvents();
     void setMeterInfiniteHold(bool infiniteHold);
     void resetMeters();
 
     virtual bool processBufferChunk(AudioBuffer<float> &buffer) override;
 
+    bool hasQueuedChunks() override;
+    void processQueuedChunks() override;
+
     int getAverageAlgorithm();
     void setAverageAlgorithm(const int averageAlgorithm);
     void setAverageAlgorithmFinal(const int averageAlgorithm);
@@ -125,43 +131,73 @@ private:
     static BusesProperties getBusesProperties();
     void resetOnPlay();
 
-    int countOverflows(const AudioBuffer<float> &buffer,
-                       const int channel,
-                       const int numberOfSamples,
-                       const float limitOverflow) const;
+    int calculateOutputGains(double *outputGains,
+                             const int numberOfSamples);
+
+    void meterChunk(const AudioBuffer<float> &buffer,
+                    const bool isMono);
+
+    void applyHostReset();
+    void applyMeterRequests();
+
+    void startBackgroundMetering();
+    void stopBackgroundMetering();
+    void updateBackgroundMetering();
+    void switchBackgroundMetering(const bool shouldMeterInBackground);
+
+    void createRingBuffers(const int samplesPerBlock);
+    void updateZeroLatency();
+    void updateAnalysisBlockSize();
+    void updateAverageLevelFilter();
 
     std::unique_ptr<AudioFilePlayer> audioFilePlayer_;
     std::unique_ptr<frut::audio::RingBuffer<float>> ringBuffer_;
     std::unique_ptr<frut::audio::RingBuffer<double>> ringBufferDouble_;
 
-    std::unique_ptr<AverageLevelFiltered> averageLevelFiltered_;
-    std::unique_ptr<frut::dsp::TruePeakMeter> truePeakMeter_;
+    AudioBuffer<float> processBufferFloat_;
+    AudioBuffer<double> processBufferDouble_;
+
+    std::unique_ptr<MeterEngine> meterEngine_;
     std::shared_ptr<MeterBallistics> meterBallistics_;
 
+    // allocated on its own, so that its slots start on cache lines
+    std::unique_ptr<frut::audio::TripleBuffer<MeterSnapshot>> meterSnapshots_;
+
+    SharedResourcePointer<MeterWorkerPool> meterWorkerPool_;
+    std::unique_ptr<frut::audio::SpscQueue<MeterChunk>> meterChunks_;
+
     KmeterPluginParameters pluginParameters_;
+    KmeterEvents events_;
 
-    const int kmeterBufferSize_;
+    int kmeterBufferSize_;
 
     bool isStereo_;
     bool sampleRateIsValid_;
     bool isSilent_;
     bool hasStopped_;
+    bool isMeterResetPending_;
+    bool isEngineResetPending_;
+    bool isZeroLatency_;
+
+    // written on the message thread, read on the audio thread
+    std::atomic<bool> isMeteringInBackground_;
 
-    int averageAlgorithmId_;
-    float processedSeconds_;
+    // requested by the host or the editor; carried out by the thread
+    // that owns the affected state (see applyHostReset() and
+    // applyMeterRequests())
+    std::atomic<bool> isResetRequested_;
+    std::atomic<bool> isMeterResetRequested_;
+    std::atomic<int> requestedInfiniteHold_;
+    std::atomic<int> requestedAverageAlgorithm_;
+
+    std::atomic<int> averageAlgorithmId_;
 
     double attenuationDecibel_;
     double currentAttenuationDecibel_;
 
     double outputGain_;
     double outputFadeRate_;
-
-    Array<float> peakLevels_;
-    Array<float> rmsLevels_;
-    Array<float> averageLevelsFiltered_;
-    Array<float> truePeakLevels_;
-
-    Array<int> overflowCounts_;
+    double outputFadeFactor_;
 
     frut::dsp::Dither dither_;
 };